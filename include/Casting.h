@@ -0,0 +1,26 @@
+#ifndef CASTING_H
+#define CASTING_H
+#include <cassert>
+
+// 依据类型标签的isa/cast/dyn_cast, 代替IR与MIPS指令上的dynamic_cast
+// 目标类型To需要提供static bool classof(const Base*), 只比较getIrType()/getCodeType()返回的标签, 不走RTTI
+template <typename To, typename From>
+inline bool isa(const From* value) {
+    assert(value && "isa<> used on a null pointer");
+    return To::classof(value);
+}
+
+// 确定类型时使用, 类型不符时断言失败
+template <typename To, typename From>
+inline To* cast(From* value) {
+    assert(isa<To>(value) && "cast<> argument of incompatible type");
+    return static_cast<To*>(value);
+}
+
+// 类型不符时返回nullptr, 与dynamic_cast一样接受空指针
+template <typename To, typename From>
+inline To* dyn_cast(From* value) {
+    return value && To::classof(value) ? static_cast<To*>(value) : nullptr;
+}
+
+#endif
@@ -1,41 +1,67 @@
 #ifndef COMPILER_H
 #define COMPILER_H
+#include <cctype>
+#include <cstdlib>
 #include <exception>
 #include <token/Tokenizer.h>
+#include <token/TokenStream.h>
 #include <grammar/Parser.h>
 #include <symbol/SymbolTable.h>
 #include <codegen/CodeGenerator.h>
 
-static std::string s_sourcePath = "intermediate/testfile.txt";
-static std::string s_dumpTokenPath = "intermediate/token.txt";
-static std::string s_dumpASTPath = "intermediate/ast.txt";
-static std::string s_dumpTablePath = "intermediate/table.txt";
-static std::string s_dumpErrorPath = "intermediate/error.txt";
-static std::string s_dumpIrPath = "intermediate/llvm_ir.txt";
-static std::string s_dumpMipsPath = "intermediate/mips.txt";
-static bool s_dumpToken = false;
-static bool s_dumpAST = false;
-static bool s_dumpTable = false;
-static bool s_dumpError = false;
-static bool s_dumpIr = false;
-static bool s_dumpMips = false;
-static bool s_isTest = false;
+// 一次编译的选项, 由命令行参数解析得到
+struct CompileOptions {
+    std::string sourcePath = "intermediate/testfile.txt";
+    std::string dumpTokenPath = "intermediate/token.txt";
+    std::string dumpASTPath = "intermediate/ast.txt";
+    std::string dumpTablePath = "intermediate/table.txt";
+    std::string dumpErrorPath = "intermediate/error.txt";
+    std::string dumpIrPath = "intermediate/llvm_ir.txt";
+    std::string dumpMipsPath = "intermediate/mips.txt";
+    bool dumpToken = false;
+    bool dumpAST = false;
+    bool dumpTable = false;
+    bool dumpError = false;
+    bool dumpIr = false;
+    bool dumpMips = false;
+    bool isTest = false;
 
-static int s_optLevel = 1;
+    int optLevel = 1;
+
+    // --batch: 编译列表文件中的每个源文件, 此时各--dump-*的路径是输出目录
+    bool batch = false;
+    std::string batchListPath;
+    // 工作线程数, 批量编译时按文件并行, 否则按函数并行
+    // 没有-j时单个文件用1个线程, 批量编译用硬件线程数
+    std::size_t jobs = 1;
+};
 
 static bool takeArg(char* arg) {
-    static const std::set<std::string> x{"-o", "--dump-token", "--dump-ast", "--dump-table", "--dump-error", "--dump-ir", "--dump-mips"};
+    static const std::set<std::string> x{"-o", "--dump-token", "--dump-ast", "--dump-table", "--dump-error", "--dump-ir", "--dump-mips", "--batch"};
     return x.count(std::string(arg));
 }
 
 static void usage(int status) {
-    std::cerr << "usage: sysyc [--dump-token <path>] [--dump-ast <path>] [--dump-table <path>] [--dump-error <path>] [--dump-ir <path>] [--dump-mips <path>] [ -o <path> ] <path>\n";
+    std::cerr << "usage: sysyc [--dump-token <path>] [--dump-ast <path>] [--dump-table <path>] [--dump-error <path>] [--dump-ir <path>] [--dump-mips <path>] [ -o <path> ] [-j<threads>] <path>\n";
     std::cerr << "usage: sysyc [--test]\n";
+    std::cerr << "usage: sysyc --batch <list> [-j<threads>] [--dump-error <dir>] [--dump-ir <dir>] [--dump-mips <dir>] ...\n";
     exit(status);
 }
 
-static void parseArgs(int argc, char** argv) {
+// -j的线程数必须是正整数
+static std::size_t parseJobs(const char* arg) {
+    char* end = nullptr;
+    auto jobs = std::strtoul(arg, &end, 10);
+    if (!std::isdigit(static_cast<unsigned char>(arg[0])) || *end != '\0' || jobs == 0) {
+        std::cerr << "Invalid thread number: -j" << arg << std::endl;
+        usage(1);
+    }
+    return jobs;
+}
+
+static void parseArgs(int argc, char** argv, CompileOptions& options) {
     // TODO: 参数加入配置文件
+    std::size_t jobs = 0;
     for (int i = 0; i < argc; i++) {
         if (takeArg(argv[i])) {
             if (!argv[++i])
@@ -44,69 +70,93 @@ static void parseArgs(int argc, char** argv) {
     }
     for (int i = 1; i < argc; i++) {
         if (argv[i] == std::string("--dump-token")) {
-            s_dumpTokenPath = argv[++i];
-            s_dumpToken = true;
+            options.dumpTokenPath = argv[++i];
+            options.dumpToken = true;
             continue;
         }
         if (argv[i] == std::string("--dump-ast")) {
-            s_dumpASTPath = argv[++i];
-            s_dumpAST = true;
+            options.dumpASTPath = argv[++i];
+            options.dumpAST = true;
             continue;
         }
         if (argv[i] == std::string("--dump-table")) {
-            s_dumpTablePath = argv[++i];
-            s_dumpTable = true;
+            options.dumpTablePath = argv[++i];
+            options.dumpTable = true;
             continue;
         }
         if (argv[i] == std::string("--dump-error")) {
-            s_dumpErrorPath = argv[++i];
-            s_dumpError = true;
+            options.dumpErrorPath = argv[++i];
+            options.dumpError = true;
             continue;
         }
         if (argv[i] == std::string("--dump-ir")) {
-            s_dumpIrPath = argv[++i];
-            s_dumpIr = true;
+            options.dumpIrPath = argv[++i];
+            options.dumpIr = true;
             continue;
         }
         if (argv[i] == std::string("--dump-mips")) {
-            s_dumpMipsPath = argv[++i];
-            s_dumpMips = true;
+            options.dumpMipsPath = argv[++i];
+            options.dumpMips = true;
+            continue;
+        }
+        if (argv[i] == std::string("--batch")) {
+            options.batchListPath = argv[++i];
+            options.batch = true;
+            continue;
+        }
+        if (argv[i][0] == '-' && argv[i][1] == 'j') {
+            jobs = parseJobs(&argv[i][2]);
             continue;
         }
         if (argv[i] == std::string("--test")) {
-            s_isTest = true;
-            s_dumpToken = true;
-            s_dumpAST = true;
-            s_dumpTable = true;
-            s_dumpError = true;
-            s_dumpIr = true;
-            s_dumpMips = true;
+            options.isTest = true;
+            options.dumpToken = true;
+            options.dumpAST = true;
+            options.dumpTable = true;
+            options.dumpError = true;
+            options.dumpIr = true;
+            options.dumpMips = true;
             break;
         }
         if (argv[i][0] == '-' && argv[i][1] == 'O') {
-            s_optLevel = std::atoi(&argv[i][2]);
+            options.optLevel = std::atoi(&argv[i][2]);
         }
-        s_sourcePath = std::string(argv[i]);
+        options.sourcePath = std::string(argv[i]);
+    }
+    if (jobs) {
+        options.jobs = jobs;
+    } else {
+        options.jobs = options.batch ? ThreadPool::defaultThreadNum() : 1;
     }
 }
 
+// 一次编译的全部状态: 选项, 日志, 以及从词法分析到代码生成的各阶段
+// 不依赖进程级的全局状态, 同一进程中可以先后或在不同线程中同时编译多个文件
 class Compiler {
 public:
+    explicit Compiler(const CompileOptions& options) :
+        m_options(options) {}
+    // 提示信息默认写到std::cout, 异常信息默认写到std::cerr
+    void setOutput(std::ostream* log, std::ostream* err) {
+        m_log.stream = log;
+        m_err = err;
+    }
     bool firstPass(std::filebuf& file);
-    std::vector<Token>& getTokenList();
-    std::shared_ptr<VNodeBase> getAstNode();
     void dumpToken(std::filebuf& file);
     void dumpAST(std::filebuf& file);
     void dumpTable(std::filebuf& file);
-    static void dumpError(std::filebuf& file);
+    void dumpError(std::filebuf& file);
     void dumpIr(std::filebuf& file, bool isTest);
     void dumpMips(std::filebuf& file);
 
 private:
+    CompileOptions m_options;
+    LogSink m_log;
+    std::ostream* m_err{&std::cerr};
     std::unique_ptr<Tokenizer> m_tokenizer;
+    std::unique_ptr<TokenStream> m_tokenStream;
     std::unique_ptr<Parser> m_parser;
     std::unique_ptr<CodeGenerator> m_generator;
-    std::vector<Token> m_tokenList;
-    std::shared_ptr<VNodeBase> m_astNode;
+    VNodeArena m_astArena;
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef DUMP_WRITER_H
+#define DUMP_WRITER_H
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+// 输出中间结果(token, AST, IR, MIPS)用的缓冲写入器
+// 直接把文本格式化进一整块缓冲区, 写满或flush时才交给底层的streambuf, 不经过ostream的sentry和locale
+// 接口与ostream的<<一致, std::endl只写入换行而不刷新
+// 仍以std::ostream打印的代码(如符号表条目)可以通过stream()写入同一块缓冲区
+class DumpWriter : private std::streambuf {
+public:
+    explicit DumpWriter(std::streambuf* sink = nullptr);
+    ~DumpWriter() override;
+
+    // 刷新到原来的sink后改为写入新的sink, sink为空时丢弃后续输出
+    void open(std::streambuf* sink);
+    void flush();
+    bool isOpen() const { return m_sink != nullptr; }
+    std::ostream& stream() { return m_stream; }
+
+    DumpWriter& write(const char* str, std::size_t len) {
+        if (len <= static_cast<std::size_t>(epptr() - pptr())) {
+            std::memcpy(pptr(), str, len);
+            pbump(static_cast<int>(len));
+        } else {
+            writeSlow(str, len);
+        }
+        return *this;
+    }
+    DumpWriter& operator<<(char c) {
+        if (pptr() == epptr()) {
+            overflow(traits_type::to_int_type(c));
+        } else {
+            *pptr() = c;
+            pbump(1);
+        }
+        return *this;
+    }
+    DumpWriter& operator<<(const char* str) { return write(str, std::strlen(str)); }
+    DumpWriter& operator<<(const std::string& str) { return write(str.data(), str.size()); }
+    DumpWriter& operator<<(int value) { return writeSigned(value); }
+    DumpWriter& operator<<(long value) { return writeSigned(value); }
+    DumpWriter& operator<<(long long value) { return writeSigned(value); }
+    DumpWriter& operator<<(unsigned value) { return writeUnsigned(value); }
+    DumpWriter& operator<<(unsigned long value) { return writeUnsigned(value); }
+    DumpWriter& operator<<(unsigned long long value) { return writeUnsigned(value); }
+    // 只支持std::endl, 输出换行
+    DumpWriter& operator<<(std::ostream& (*)(std::ostream&)) { return *this << '\n'; }
+
+private:
+    DumpWriter(const DumpWriter&) = delete;
+    DumpWriter& operator=(const DumpWriter&) = delete;
+
+private:
+    template <typename T>
+    DumpWriter& writeSigned(T value) {
+        if (value < 0) {
+            *this << '-';
+            return writeUnsigned(0ULL - static_cast<unsigned long long>(value));
+        }
+        return writeUnsigned(static_cast<unsigned long long>(value));
+    }
+    DumpWriter& writeUnsigned(unsigned long long value) {
+        char buf[24];
+        char* end = buf + sizeof(buf);
+        char* begin = end;
+        do {
+            *--begin = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value);
+        return write(begin, end - begin);
+    }
+    void writeSlow(const char* str, std::size_t len);
+
+    int_type overflow(int_type ch) override;
+    int sync() override;
+
+private:
+    static constexpr std::size_t BUFFER_SIZE = 64 * 1024;
+    std::streambuf* m_sink;
+    std::unique_ptr<char[]> m_buffer;
+    std::ostream m_stream;
+};
+
+#endif
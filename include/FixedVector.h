@@ -0,0 +1,38 @@
+#ifndef FIXED_VECTOR_H
+#define FIXED_VECTOR_H
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+
+// 容量固定为N的vector, 元素直接存放在对象内, 不分配内存
+// 用于元素个数有小上界, 又需要按值返回的场合, 元素类型需要可默认构造
+template <typename T, std::size_t N>
+class FixedVector {
+public:
+    FixedVector() = default;
+    FixedVector(std::initializer_list<T> elems) {
+        for (auto& elem : elems) {
+            push_back(elem);
+        }
+    }
+
+    void push_back(const T& elem) {
+        assert(m_size < N && "FixedVector overflow");
+        m_data[m_size++] = elem;
+    }
+    void clear() { m_size = 0; }
+    T* begin() { return m_data; }
+    T* end() { return m_data + m_size; }
+    const T* begin() const { return m_data; }
+    const T* end() const { return m_data + m_size; }
+    T& operator[](std::size_t i) { return m_data[i]; }
+    const T& operator[](std::size_t i) const { return m_data[i]; }
+    std::size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+private:
+    T m_data[N]{};
+    std::size_t m_size{0};
+};
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef ILIST_H
+#define ILIST_H
+#include <cstddef>
+#include <iterator>
+
+template <typename T>
+class IList;
+
+// 侵入式链表的节点, 元素类型T继承IListNode<T>, 前后指针直接存放在元素里
+// 一个元素同一时刻只能属于一个IList
+template <typename T>
+class IListNode {
+    friend class IList<T>;
+
+public:
+    T* getPrev() const { return m_prev; }
+    T* getNext() const { return m_next; }
+
+private:
+    T* m_prev{nullptr};
+    T* m_next{nullptr};
+};
+
+// 拥有元素的侵入式双向链表, 元素由new创建, 插入后归链表所有, erase或链表析构时delete
+// 已知元素指针时插入, 删除和取前后元素都是O(1), 删除元素不影响指向其它元素的迭代器
+template <typename T>
+class IList {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T*;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T* const*;
+        using reference = T*;
+
+        Iterator(const IList* list, T* node) :
+            m_list(list), m_node(node) {}
+        T* operator*() const { return m_node; }
+        T* operator->() const { return m_node; }
+        Iterator& operator++() {
+            m_node = node(m_node)->m_next;
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator ret = *this;
+            ++*this;
+            return ret;
+        }
+        // end()退一步得到最后一个元素
+        Iterator& operator--() {
+            m_node = m_node ? node(m_node)->m_prev : m_list->m_tail;
+            return *this;
+        }
+        Iterator operator--(int) {
+            Iterator ret = *this;
+            --*this;
+            return ret;
+        }
+        bool operator==(const Iterator& rhs) const { return m_node == rhs.m_node; }
+        bool operator!=(const Iterator& rhs) const { return m_node != rhs.m_node; }
+
+    private:
+        const IList* m_list;
+        T* m_node;
+    };
+    using ReverseIterator = std::reverse_iterator<Iterator>;
+
+    IList() = default;
+    ~IList() { clear(); }
+
+    Iterator begin() const { return Iterator(this, m_head); }
+    Iterator end() const { return Iterator(this, nullptr); }
+    ReverseIterator rbegin() const { return ReverseIterator(end()); }
+    ReverseIterator rend() const { return ReverseIterator(begin()); }
+    bool empty() const { return m_head == nullptr; }
+    std::size_t size() const { return m_size; }
+    T* front() const { return m_head; }
+    T* back() const { return m_tail; }
+
+    T* pushBack(T* elem) { return insertBefore(nullptr, elem); }
+    T* pushFront(T* elem) { return insertBefore(m_head, elem); }
+    // pos为空时插入到末尾
+    T* insertBefore(T* pos, T* elem) {
+        auto n = node(elem);
+        n->m_next = pos;
+        n->m_prev = pos ? node(pos)->m_prev : m_tail;
+        if (n->m_prev) {
+            node(n->m_prev)->m_next = elem;
+        } else {
+            m_head = elem;
+        }
+        if (pos) {
+            node(pos)->m_prev = elem;
+        } else {
+            m_tail = elem;
+        }
+        m_size++;
+        return elem;
+    }
+    T* insertAfter(T* pos, T* elem) { return insertBefore(node(pos)->m_next, elem); }
+    // 从链表中摘下但不释放, 返回原来的后一个元素
+    T* remove(T* elem) {
+        auto n = node(elem);
+        T* next = n->m_next;
+        if (n->m_prev) {
+            node(n->m_prev)->m_next = n->m_next;
+        } else {
+            m_head = n->m_next;
+        }
+        if (n->m_next) {
+            node(n->m_next)->m_prev = n->m_prev;
+        } else {
+            m_tail = n->m_prev;
+        }
+        n->m_prev = n->m_next = nullptr;
+        m_size--;
+        return next;
+    }
+    T* erase(T* elem) {
+        T* next = remove(elem);
+        delete elem;
+        return next;
+    }
+    void clear() {
+        while (m_head) {
+            erase(m_head);
+        }
+    }
+
+private:
+    IList(const IList&) = delete;
+    IList& operator=(const IList&) = delete;
+
+    static IListNode<T>* node(T* elem) { return static_cast<IListNode<T>*>(elem); }
+
+private:
+    T* m_head{nullptr};
+    T* m_tail{nullptr};
+    std::size_t m_size{0};
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define LOG_H
 #include <vector>
 #include <iostream>
+#include <sstream>
 #include <Error.h>
 
 #ifndef NDEBUG
@@ -23,14 +24,51 @@ struct ErrorLog {
     }
 };
 
+// 一次编译的日志去向: 错误码收集在errors中, 提示文本写到stream
+struct LogSink {
+    std::vector<ErrorLog> errors;
+    std::ostream* stream{&std::cout};
+};
+
+// 先缓存在内存中的日志, 用于并行的任务, 之后由Logger::append按需要的顺序写回
+struct LogBuffer {
+    LogBuffer() { sink.stream = &text; }
+    LogBuffer(const LogBuffer&) = delete;
+    LogBuffer& operator=(const LogBuffer&) = delete;
+
+    std::ostringstream text;
+    LogSink sink;
+};
+
 class Logger {
 public:
+    // 在生命周期内把sink设为当前线程的日志去向, 结束时恢复原来的
+    class Scope {
+    public:
+        explicit Scope(LogSink& sink) :
+            m_prev(s_current) { s_current = &sink; }
+        ~Scope() { s_current = m_prev; }
+
+    private:
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        LogSink* m_prev;
+    };
+
     static void logError(ErrorType error, int lineNum, const std::string& meta = "", const std::string& target = "");
     static void logError(const std::string& error);
     static void logInfo(const std::string& info);
     static void logWarning(const std::string& warning);
     static void logDebug(const std::string& message);
-    static std::vector<ErrorLog> s_errorDump;
+    // 把buffer中的提示文本和错误码追加到当前的日志去向
+    static void append(const LogBuffer& buffer);
+
+private:
+    // 没有设置Scope时写到std::cout, 错误码收集在线程自己的默认sink中
+    static LogSink& current();
+    static thread_local LogSink* s_current;
 };
 
 #endif
\ No newline at end of file
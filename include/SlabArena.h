@@ -0,0 +1,56 @@
+#ifndef SLAB_ARENA_H
+#define SLAB_ARENA_H
+#include <cstddef>
+#include <vector>
+
+// 按大小分级的slab分配器, 每个函数一个, 为它的IR/MIPS指令和基本块分配内存
+// 每次分配前面带一个头部记录所属的arena, 释放的块回到该arena对应大小的空闲链表, arena析构时整体归还所有大块内存
+// 这些类的operator new从当前线程的"当前arena"分配(见Scope), 没有当前arena时退回到全局堆
+class SlabArena {
+public:
+    // 在生命周期内把arena设为当前线程的当前arena, 结束时恢复原来的
+    class Scope {
+    public:
+        explicit Scope(SlabArena& arena) :
+            m_prev(s_current) { s_current = &arena; }
+        ~Scope() { s_current = m_prev; }
+
+    private:
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        SlabArena* m_prev;
+    };
+
+    SlabArena() = default;
+    ~SlabArena();
+
+    static void* allocate(std::size_t size);
+    static void deallocate(void* ptr, std::size_t size);
+
+private:
+    SlabArena(const SlabArena&) = delete;
+    SlabArena& operator=(const SlabArena&) = delete;
+
+    struct FreeNode {
+        FreeNode* next;
+    };
+    static std::size_t sizeClassOf(std::size_t size) { return (size + HEADER_SIZE + ALIGN - 1) / ALIGN; }
+    void* allocateSlot(std::size_t sizeClass);
+    void freeSlot(void* slot, std::size_t sizeClass);
+
+private:
+    static constexpr std::size_t ALIGN = 16;
+    static constexpr std::size_t HEADER_SIZE = 16; // 保持对象按16字节对齐
+    static constexpr std::size_t MAX_CLASS = 32;   // 超过MAX_CLASS * ALIGN的对象直接用全局堆
+    static constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+    static thread_local SlabArena* s_current;
+
+    std::vector<char*> m_chunks;
+    char* m_curr{nullptr};
+    char* m_end{nullptr};
+    FreeNode* m_freeLists[MAX_CLASS + 1]{};
+};
+
+#endif
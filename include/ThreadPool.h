@@ -0,0 +1,60 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 固定数量工作线程的work-stealing线程池
+// 每个工作线程有自己的任务队列, 先从自己队列的尾部取任务, 空了再从其他线程队列的头部窃取
+// 外部线程提交的任务轮流放入各个队列, 工作线程中提交的任务放入自己的队列
+// 任务之间不能互相等待; 任务抛出的异常不会被捕获
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t threadNum);
+    // 等待已提交的任务全部完成后结束工作线程
+    ~ThreadPool();
+
+    void submit(std::function<void()> task);
+    // 等待已提交的任务全部完成, 不能在任务中调用
+    void wait();
+    std::size_t size() const { return m_workers.size(); }
+    // 硬件线程数, 取不到时为1
+    static std::size_t defaultThreadNum();
+
+private:
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+    void workerLoop(std::size_t index);
+    void takeTask(std::size_t index, std::function<void()>& task);
+
+private:
+    std::vector<std::unique_ptr<WorkQueue>> m_queues; // 下标与m_workers相同
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex; // 保护下面的计数
+    std::condition_variable m_taskReady;
+    std::condition_variable m_allDone;
+    std::size_t m_pending{0};    // 在队列中还没有被工作线程认领的任务数
+    std::size_t m_unfinished{0}; // 已提交但未执行完的任务数
+    std::size_t m_nextQueue{0};  // 外部提交时放入的队列
+    bool m_stop{false};
+
+    // 当前线程所属的线程池和它的下标, 不是工作线程时为nullptr
+    static thread_local ThreadPool* s_owner;
+    static thread_local std::size_t s_index;
+};
+
+// 对[0, n)中的每个下标执行body, pool为空时在当前线程中按顺序执行
+// 有任务抛出异常时, 等全部任务结束后重新抛出下标最小的那个
+void parallelFor(ThreadPool* pool, std::size_t n, const std::function<void(std::size_t)>& body);
+
+#endif
@@ -7,20 +7,60 @@
 #include <sstream>
 #include <vector>
 
-static bool isNewline(const char c) {
+// 字符分类表, 词法分析时每个字符只查一次表
+enum CharClass : unsigned char {
+    CC_SPACE = 1,
+    CC_DIGIT = 2,
+    CC_ALPHA = 4, // 字母和下划线
+    CC_PUNCT = 8,
+};
+
+constexpr bool isPunctChar(int c) {
+    return c == ';' || c == ',' || c == '(' || c == ')' || c == '[' || c == ']' || c == '{' || c == '}'
+           || c == '+' || c == '-' || c == '*' || c == '/' || c == '%' || c == '=' || c == '<' || c == '>'
+           || c == '!' || c == '&' || c == '|';
+}
+
+constexpr unsigned char charClassOf(int c) {
+    return (c == ' ' || c == '\n' || c == '\t' || c == '\v' || c == '\f' || c == '\r') ? CC_SPACE :
+           (c >= '0' && c <= '9') ? CC_DIGIT :
+           ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_') ? CC_ALPHA :
+           isPunctChar(c) ? CC_PUNCT : 0;
+}
+
+#define CHAR_CLASS_4(i) charClassOf(i), charClassOf(i + 1), charClassOf(i + 2), charClassOf(i + 3)
+#define CHAR_CLASS_16(i) CHAR_CLASS_4(i), CHAR_CLASS_4(i + 4), CHAR_CLASS_4(i + 8), CHAR_CLASS_4(i + 12)
+#define CHAR_CLASS_64(i) CHAR_CLASS_16(i), CHAR_CLASS_16(i + 16), CHAR_CLASS_16(i + 32), CHAR_CLASS_16(i + 48)
+static constexpr unsigned char s_charClassTable[256] = {
+    CHAR_CLASS_64(0), CHAR_CLASS_64(64), CHAR_CLASS_64(128), CHAR_CLASS_64(192)};
+#undef CHAR_CLASS_64
+#undef CHAR_CLASS_16
+#undef CHAR_CLASS_4
+
+inline bool hasCharClass(const char c, unsigned char cls) {
+    return (s_charClassTable[static_cast<unsigned char>(c)] & cls) != 0;
+}
+inline bool isNewline(const char c) {
     return c == '\n';
 }
-static bool isTab(const char c) {
+inline bool isTab(const char c) {
     return c == '\t';
 }
-static bool isIdentChar(const char c) {
-    return c == '_' || isalnum(c);
+inline bool isVacant(const char c) {
+    return hasCharClass(c, CC_SPACE);
+}
+inline bool isDigit(const char c) {
+    return hasCharClass(c, CC_DIGIT);
+}
+inline bool isIdentStart(const char c) {
+    return hasCharClass(c, CC_ALPHA);
+}
+inline bool isIdentChar(const char c) {
+    return hasCharClass(c, CC_ALPHA | CC_DIGIT);
+}
+inline bool isPunct(const char c) {
+    return hasCharClass(c, CC_PUNCT);
 }
-static bool isPunct(const char c) {
-    static const std::set<char> punctSet = {';', ',', '(', ')', '[', ']', '{', '}', '+', '-', '*', '/',
-                                            '%', '=', '<', '>', '<', '>', '=', '!', '!', '&', '|'};
-    return punctSet.count(c);
-};
 
 static void toUpper(std::string& str) {
     std::transform(str.begin(), str.end(), str.begin(), ::toupper);
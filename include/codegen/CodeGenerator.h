@@ -2,16 +2,23 @@
 #define CODE_GENERATOR_H
 #include "Visitor.h"
 #include <mips/MipsContext.h>
+#include <ThreadPool.h>
 
 class CodeGenerator {
 public:
-    CodeGenerator(std::shared_ptr<VNodeBase> astRoot);
+    // jobs大于1时建立线程池, 按函数并行生成
+    CodeGenerator(VNodeBase* astRoot = nullptr, std::size_t jobs = 1);
+    // 条目流式解析时由解析器逐条送入编译单元的顶层条目(各自完整的子树), 全部送完后调用endCompUnit
+    // 只用于没有线程池的串行生成, 函数体不会推迟, 条目返回后即可丢弃
+    void visitUnitItem(VNodeBase* item);
+    void endCompUnit();
     void generate(int optLevel, bool genMips = true);
     void dumpTable(std::filebuf& file);
     void dumpIr(std::filebuf& file, bool isTest);
     void dumpMips(std::filebuf& file);
 
 private:
+    std::unique_ptr<ThreadPool> m_pool; // 单线程时为空
     std::unique_ptr<Visitor> m_visitor;
     SymbolTable m_table;
     IrContext m_irCtx;
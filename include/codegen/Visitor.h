@@ -4,95 +4,130 @@
 #include <symbol/ValueType.h>
 #include <grammar/VNode.h>
 #include <ir/IR.h>
-#define MAKE_INT_VAR() m_table.makeItem<VarItem<IntType>>({})
-#define MAKE_CHAR_VAR() m_table.makeItem<VarItem<CharType>>({})
-#define MAKE_VOID_VAR() m_table.makeItem<VarItem<VoidType>>({})
-#define MAKE_INT_ARRAY(dims) m_table.makeItem<VarItem<ArrayType<IntType>>>({{{{}, dims}}, {{{}, dims}}, false})
-#define MAKE_CHAR_ARRAY(dims) m_table.makeItem<VarItem<ArrayType<CharType>>>({{{{}, dims}}, {{{}, dims}}, false})
+#include <unordered_map>
+class ThreadPool;
+// 表达式求值的结果
+// 中间结果只携带IR值和类型信息, 不在符号表中创建临时符号
+struct ExpValue {
+    Value* value{nullptr};                        // 对应的IR值, 为空表示求值失败
+    ValueTypeEnum type{ValueTypeEnum::VOID_TYPE}; // 基本类型
+    bool isConst{false};                          // 是否为常量折叠的结果
+    int constVar{0};                              // 常量折叠得到的值
+    std::vector<size_t> dims;                     // 数组(切片)的维数, 非数组为空
 
-#define MAKE_VAR() m_table.makeItem<VarItem<Type>>({})
-#define MAKE_CONST_VAR() m_table.makeItem<ConstVarItem<Type>>(0)
+    ExpValue() = default;
+    ExpValue(Value* value, ValueTypeEnum type) :
+        value(value), type(type) {}
+    ExpValue(Value* value, ValueTypeEnum type, std::vector<size_t>&& dims) :
+        value(value), type(type), dims(std::move(dims)) {}
+    bool isArray() const { return !dims.empty(); }
+    explicit operator bool() const { return value != nullptr; }
+};
 
+// 每个函数体由自己的Visitor生成, 它有函数自己的符号表(作用域栈)和IrBuilder
+// 有线程池时各函数体推迟到endCompUnit中并行生成
 class Visitor {
 public:
-    explicit Visitor(std::shared_ptr<VNodeBase> astRoot, SymbolTable& table, IrContext& ctx);
+    explicit Visitor(VNodeBase* astRoot, SymbolTable& table, IrContext& ctx, ThreadPool* pool = nullptr);
     void visit();
+    // 编译单元中的一个decl/funcDef/mainFuncDef, 返回true表示函数体推迟生成, 之后还要访问它的节点
+    bool visitUnitItem(VNodeBase* node);
+    void endCompUnit();
 
 private:
-    bool expect(std::shared_ptr<VNodeBase> node, VNodeEnum nodeEnum);
-    bool expect(std::shared_ptr<VNodeBase> node, SymbolEnum symbolEnum);
-    void compUnit(std::shared_ptr<VNodeBase> node);  // 编译单元
-    void decl(std::shared_ptr<VNodeBase> node);      // 声明
-    void constDecl(std::shared_ptr<VNodeBase> node); // 常量声明
+    bool expect(VNodeBase* node, VNodeEnum nodeEnum);
+    bool expect(VNodeBase* node, SymbolEnum symbolEnum);
+    void compUnit(VNodeBase* node);  // 编译单元
+    bool unitItem(VNodeBase* node);  // 编译单元中的一个条目
+    void decl(VNodeBase* node);      // 声明
+    void constDecl(VNodeBase* node); // 常量声明
     template <typename Type>
-    void constDef(std::shared_ptr<VNodeBase> node); // 常量定义
+    void constDef(VNodeBase* node); // 常量定义
     template <typename Type>
-    typename Type::InternalType constInitVal(std::shared_ptr<VNodeBase> node, std::vector<size_t>& dims, int level); // 常量初值
+    typename Type::InternalType constInitVal(VNodeBase* node, std::vector<size_t>& dims, int level); // 常量初值
     template <typename Type>
-    typename ArrayType<Type>::InternalType constInitValArray(std::shared_ptr<VNodeBase> node, std::vector<size_t>& dims, int level);
+    typename ArrayType<Type>::InternalType constInitValArray(VNodeBase* node, std::vector<size_t>& dims, int level);
     template <typename Type>
-    typename Type::InternalType constExp(std::shared_ptr<VNodeBase> node); // 常量表达式
-    void varDecl(std::shared_ptr<VNodeBase> node);                         // 变量声明
+    typename Type::InternalType constExp(VNodeBase* node); // 常量表达式
+    void varDecl(VNodeBase* node);                         // 变量声明
     template <typename Type>
-    void varDef(std::shared_ptr<VNodeBase> node); // 变量定义
+    void varDef(VNodeBase* node); // 变量定义
     template <typename Type>
-    typename Type::InternalType initValGlobal(std::shared_ptr<VNodeBase> node, std::vector<size_t>& dims, int level); // 变量初值
+    typename Type::InternalType initValGlobal(VNodeBase* node, std::vector<size_t>& dims, int level); // 变量初值
     template <typename Type>
-    typename ArrayType<Type>::InternalType initValGlobalArray(std::shared_ptr<VNodeBase> node, std::vector<size_t>& dims, int level);
+    typename ArrayType<Type>::InternalType initValGlobalArray(VNodeBase* node, std::vector<size_t>& dims, int level);
     template <typename Type>
-    typename Type::InternalItem initVal(std::shared_ptr<VNodeBase> node, std::vector<size_t>& dims, int level);
+    typename Type::InternalItem initVal(VNodeBase* node, std::vector<size_t>& dims, int level);
     template <typename Type>
-    typename ArrayType<Type>::InternalItem initValArray(std::shared_ptr<VNodeBase> node, std::vector<size_t>& dims, int level);
+    typename ArrayType<Type>::InternalItem initValArray(VNodeBase* node, std::vector<size_t>& dims, int level);
 
     template <typename Type>
-    SymbolTableItem* exp(std::shared_ptr<VNodeBase> node);  // 表达式
-    void block(std::shared_ptr<VNodeBase> node);            // 语句块
-    void blockItem(std::shared_ptr<VNodeBase> node);        // 语句块项
-    void stmt(std::shared_ptr<VNodeBase> node);             // 语句
-    SymbolTableItem* lVal(std::shared_ptr<VNodeBase> node); // 左值
+    ExpValue exp(VNodeBase* node);                             // 表达式
+    void block(VNodeBase* node);                               // 语句块
+    void blockItem(VNodeBase* node);                           // 语句块项
+    void stmt(VNodeBase* node);                                // 语句
+    std::pair<SymbolTableItem*, Value*> lVal(VNodeBase* node); // 左值, 返回对应的符号和写入的地址
     template <typename Type>
-    SymbolTableItem* rVal(std::shared_ptr<VNodeBase> node); // 右值（生成式中依然是左值，只不过是右值的功能）
-    Value* cond(std::shared_ptr<VNodeBase> node);           // 条件表达式
+    ExpValue rVal(VNodeBase* node); // 右值（生成式中依然是左值，只不过是右值的功能）
+    Value* cond(VNodeBase* node);   // 条件表达式
     template <typename Type>
-    ConstVarItem<Type>* number(std::shared_ptr<VNodeBase> node); // 数字
+    ExpValue number(VNodeBase* node); // 数字
     template <typename Type>
-    SymbolTableItem* primaryExp(std::shared_ptr<VNodeBase> node); // 基本表达式
+    ExpValue primaryExp(VNodeBase* node); // 基本表达式
     template <typename Type>
-    SymbolTableItem* unaryExp(std::shared_ptr<VNodeBase> node); // 一元表达式
-    SymbolEnum unaryOp(std::shared_ptr<VNodeBase> node);        // 单目运算符
+    ExpValue unaryExp(VNodeBase* node);  // 一元表达式
+    SymbolEnum unaryOp(VNodeBase* node); // 单目运算符
     template <typename Type>
-    SymbolTableItem* addExp(std::shared_ptr<VNodeBase> node); // 加减模运算
+    ExpValue addExp(VNodeBase* node); // 加减模运算
     template <typename Type>
-    SymbolTableItem* mulExp(std::shared_ptr<VNodeBase> node); // 乘除模运算
+    ExpValue mulExp(VNodeBase* node); // 乘除模运算
     template <typename Type>
-    SymbolTableItem* relExp(std::shared_ptr<VNodeBase> node); // 关系表达式
+    ExpValue relExp(VNodeBase* node); // 关系表达式
     template <typename Type>
-    SymbolTableItem* eqExp(std::shared_ptr<VNodeBase> node); // 相等性表达式
+    ExpValue eqExp(VNodeBase* node); // 相等性表达式
     template <typename Type>
-    Value* lAndExp(std::shared_ptr<VNodeBase> node); // 逻辑与表达式
+    Value* lAndExp(VNodeBase* node); // 逻辑与表达式
     template <typename Type>
-    Value* lOrExp(std::shared_ptr<VNodeBase> node);                                                          // 逻辑或表达式
-    void funcDef(std::shared_ptr<VNodeBase> node);                                                           // 函数定义
-    void mainFuncDef(std::shared_ptr<VNodeBase> node);                                                       // 主函数定义
-    ValueTypeEnum funcType(std::shared_ptr<VNodeBase> node);                                                 // 函数类型
-    std::vector<SymbolTableItem*> funcFParams(std::shared_ptr<VNodeBase> node);                              // 函数形参表
-    SymbolTableItem* funcFParam(std::shared_ptr<VNodeBase> node);                                            // 函数形参
-    std::vector<SymbolTableItem*> funcRParams(std::shared_ptr<VNodeBase> node, FuncItem* func, int lineNum); // 函数实参表
+    Value* lOrExp(VNodeBase* node);                                                          // 逻辑或表达式
+    bool funcDef(VNodeBase* node);                                                           // 函数定义
+    bool mainFuncDef(VNodeBase* node);                                                       // 主函数定义
+    ValueTypeEnum funcType(VNodeBase* node);                                                 // 函数类型
+    std::vector<SymbolTableItem*> funcFParams(VNodeBase* node);                              // 函数形参表
+    SymbolTableItem* funcFParam(VNodeBase* node);                                            // 函数形参
+    std::vector<Value*> funcRParams(VNodeBase* node, FuncItem* func, int lineNum);           // 函数实参表
     template <typename Type>
-    SymbolTableItem* funcRParam(std::shared_ptr<VNodeBase> node, SymbolTableItem* formalParam);
-    ValueTypeEnum bType(std::shared_ptr<VNodeBase> node); // 基本类型
+    Value* funcRParam(VNodeBase* node, SymbolTableItem* formalParam);
+    ValueTypeEnum bType(VNodeBase* node); // 基本类型
 
 private:
+    Visitor* beginFunc(FuncItem* funcItem);            // 建立函数体的Visitor
+    bool endFunc(Visitor* visitor, VNodeBase* body);   // 生成或推迟生成函数体
+    void finishFunc(Visitor& visitor);                 // 合并函数体生成的结果
+    void funcBody();                                   // 生成函数体
+    Value* irValue(SymbolTableItem* item);             // 符号在当前函数中的IR值
+    template <typename Type>
+    std::pair<typename Type::InternalType, bool> calConstExp(VNodeBase* node); // 计算常量表达式
+    template <typename Type>
+    std::pair<typename Type::InternalType, bool> foldConstExp(VNodeBase* node); // 由子节点的结果折叠当前节点
+    void undeclIdents(VNodeBase* node);                                         // 报告表达式中未定义的名字
+    template <typename Type>
+    ExpValue makeConstValue(typename Type::InternalType val); // 常量折叠的结果
     template <typename Type>
-    std::pair<typename Type::InternalType, bool> calConstExp(std::shared_ptr<VNodeBase> node); // 计算常量表达式
-    SymbolTableItem* makeTempItem(ValueTypeEnum type, bool isArray = false, std::vector<size_t>&& dims = {});
+    ExpValue makeVarValue(Value* value); // 运算得到的Type类型的值
     template <typename Type>
-    bool checkConvertiable(SymbolTableItem* item);
+    bool checkConvertiable(const ExpValue& val);
 
 private:
     SymbolTable& m_table;
     IrContext& m_ctx;
-    std::shared_ptr<VNodeBase> m_astRoot;
+    VNodeBase* m_astRoot; // 函数体的Visitor中是函数体的block
+    ThreadPool* m_pool;
+    IrBuilder m_builder;
+    std::vector<std::unique_ptr<Visitor>> m_funcVisitors; // 还没有合并的函数体, 按函数定义的顺序
+    // 推迟生成函数体时当前线程的日志, 第i段是第i个函数体之前的条目产生的, 合并时与函数体的日志交替输出
+    std::vector<std::unique_ptr<LogBuffer>> m_itemLogs;
+    // calConstExp的结果, 按节点缓存, 下标0为IntType, 1为CharType
+    std::unordered_map<const VNodeBase*, std::pair<int, bool>> m_constCache[2];
 };
 
 #endif
\ No newline at end of file
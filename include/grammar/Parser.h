@@ -1,63 +1,73 @@
 #ifndef PARSER_H
 #define PARSER_H
-#include <token/Tokenizer.h>
+#include <token/TokenStream.h>
+#include <functional>
 #include "VNode.h"
 class Parser {
 public:
-    explicit Parser(std::vector<Token>& tokenList);
+    using ItemHandler = std::function<void(VNodeBase*)>;
+    explicit Parser(TokenStream& tokenStream, VNodeArena& arena);
     void parse();
-    std::shared_ptr<VNodeBase> getASTRoot() const;
+    // 条目流式解析: 每个顶层的decl/funcDef/mainFuncDef仍完整建出子树, 解析完交给handler, 返回后其节点即被丢弃
+    // 语法成分本身不生成IR, 节点的分配和遍历与先建整棵AST时相同, 只是不同时保留整棵AST
+    // handler返回后不能再引用条目的节点
+    void parseItems(const ItemHandler& handler);
+    VNodeBase* getASTRoot() const;
     void traversalAST(std::filebuf& file);
 
 private:
-    std::shared_ptr<VNodeBase> expect(SymbolEnum symbol, int level);
-    std::shared_ptr<VNodeBase> expect(std::initializer_list<SymbolEnum> symbolList, int level);
+    VNodeBase* expect(SymbolEnum symbol, int level);
+    VNodeBase* expect(std::initializer_list<SymbolEnum> symbolList, int level);
     bool expectAssignment();
     bool expectPureExp();
     bool expectUnaryOp();
-    bool expectFuncRParams();
-    void postTraversal(std::shared_ptr<VNodeBase> node, std::ostream& os);
-    void preTraversal(std::shared_ptr<VNodeBase> node, std::ostream& os);
+    int scanLVal(int offset);
+    int scanExp(int offset);
+    int scanMulExp(int offset);
+    int scanUnaryExp(int offset);
+    void postTraversal(VNodeBase* node, DumpWriter& os);
+    void preTraversal(VNodeBase* node, DumpWriter& os);
     std::string handleGrammarError(SymbolEnum symbol);
 
 private:
-    std::shared_ptr<VNodeBase> compUnit(int level);                          // 编译单元
-    std::shared_ptr<VNodeBase> decl(int level, bool needSemicn = true);      // 声明
-    std::shared_ptr<VNodeBase> constDecl(int level, bool needSemicn = true); // 常量声明
-    std::shared_ptr<VNodeBase> bType(int level);                             // 基本类型
-    std::shared_ptr<VNodeBase> constDef(int level);                          // 常量定义
-    std::shared_ptr<VNodeBase> constInitVal(int level);                      // 常量初值
-    std::shared_ptr<VNodeBase> constExp(int level);                          // 常量表达式
-    std::shared_ptr<VNodeBase> varDecl(int level, bool needSemicn = true);   // 变量声明
-    std::shared_ptr<VNodeBase> varDef(int level);                            // 变量定义
-    std::shared_ptr<VNodeBase> initVal(int level);                           // 变量初值
-    std::shared_ptr<VNodeBase> block(int level);                             // 语句块
-    std::shared_ptr<VNodeBase> blockItem(int level, bool needSemicn = true); // 语句块项
-    std::shared_ptr<VNodeBase> stmt(int level, bool needSemicn = true);      // 语句
-    std::shared_ptr<VNodeBase> lVal(int level);                              // 左值
-    std::shared_ptr<VNodeBase> exp(int level);                               // 表达式
-    std::shared_ptr<VNodeBase> cond(int level);                              // 条件表达式
-    std::shared_ptr<VNodeBase> number(int level);                            // 数字
-    std::shared_ptr<VNodeBase> primaryExp(int level);                        // 基本表达式
-    std::shared_ptr<VNodeBase> unaryExp(int level);                          // 一元表达式
-    std::shared_ptr<VNodeBase> unaryOp(int level);                           // 单目运算符
-    std::shared_ptr<VNodeBase> addExp(int level);                            // 加减模运算
-    std::shared_ptr<VNodeBase> mulExp(int level);                            // 乘除模运算
-    std::shared_ptr<VNodeBase> relExp(int level);                            // 关系表达式
-    std::shared_ptr<VNodeBase> eqExp(int level);                             // 相等性表达式
-    std::shared_ptr<VNodeBase> lAndExp(int level);                           // 逻辑与表达式
-    std::shared_ptr<VNodeBase> lOrExp(int level);                            // 逻辑或表达式
-    std::shared_ptr<VNodeBase> funcDef(int level);                           // 函数定义
-    std::shared_ptr<VNodeBase> mainFuncDef(int level);                       // 主函数定义
-    std::shared_ptr<VNodeBase> funcType(int level);                          // 函数类型
-    std::shared_ptr<VNodeBase> funcFParams(int level);                       // 函数形参表
-    std::shared_ptr<VNodeBase> funcFParam(int level);                        // 函数形参
-    std::shared_ptr<VNodeBase> funcRParams(int level);                       // 函数实参表
+    VNodeBase* compUnit(int level);                          // 编译单元
+    VNodeBase* decl(int level, bool needSemicn = true);      // 声明
+    VNodeBase* constDecl(int level, bool needSemicn = true); // 常量声明
+    VNodeBase* bType(int level);                             // 基本类型
+    VNodeBase* constDef(int level);                          // 常量定义
+    VNodeBase* constInitVal(int level);                      // 常量初值
+    VNodeBase* constExp(int level);                          // 常量表达式
+    VNodeBase* varDecl(int level, bool needSemicn = true);   // 变量声明
+    VNodeBase* varDef(int level);                            // 变量定义
+    VNodeBase* initVal(int level);                           // 变量初值
+    VNodeBase* block(int level);                             // 语句块
+    VNodeBase* blockItem(int level, bool needSemicn = true); // 语句块项
+    VNodeBase* stmt(int level, bool needSemicn = true);      // 语句
+    VNodeBase* lVal(int level);                              // 左值
+    VNodeBase* exp(int level);                               // 表达式
+    VNodeBase* cond(int level);                              // 条件表达式
+    VNodeBase* number(int level);                            // 数字
+    VNodeBase* primaryExp(int level);                        // 基本表达式
+    VNodeBase* unaryExp(int level);                          // 一元表达式
+    VNodeBase* unaryOp(int level);                           // 单目运算符
+    VNodeBase* addExp(int level);                            // 加减模运算
+    VNodeBase* mulExp(int level);                            // 乘除模运算
+    VNodeBase* relExp(int level);                            // 关系表达式
+    VNodeBase* eqExp(int level);                             // 相等性表达式
+    VNodeBase* lAndExp(int level);                           // 逻辑与表达式
+    VNodeBase* lOrExp(int level);                            // 逻辑或表达式
+    VNodeBase* funcDef(int level);                           // 函数定义
+    VNodeBase* mainFuncDef(int level);                       // 主函数定义
+    VNodeBase* funcType(int level);                          // 函数类型
+    VNodeBase* funcFParams(int level);                       // 函数形参表
+    VNodeBase* funcFParam(int level);                        // 函数形参
+    VNodeBase* funcRParams(int level);                       // 函数实参表
 
 private:
-    std::vector<Token> m_tokenList;
-    std::shared_ptr<VNodeBase> m_astRoot;
-    Tokenizer::TokenIter m_currToken;
-    bool m_probingMode{false};
+    TokenStream& m_tokens;
+    VNodeBase* m_astRoot;
+    StringPool& m_stringPool;
+    VNodeArena& m_arena;
+    ItemHandler m_itemHandler;
 };
 #endif
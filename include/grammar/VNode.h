@@ -3,78 +3,83 @@
 #include <token/Tokenizer.h>
 #include <Log.h>
 #include "VNodeEnum.h"
-#include <memory>
+#include "VNodeArena.h"
+#include <cstring>
 #include <vector>
 #include <utility>
 
+class VNodeBase;
+
+// 子节点数组的只读视图
+class VNodeRange {
+public:
+    VNodeRange(VNodeBase* const* begin, VNodeBase* const* end) :
+        m_begin(begin), m_end(end) {}
+    VNodeBase* const* begin() const { return m_begin; }
+    VNodeBase* const* end() const { return m_end; }
+    size_t size() const { return m_end - m_begin; }
+    VNodeBase* operator[](size_t i) const { return m_begin[i]; }
+
+private:
+    VNodeBase* const* m_begin;
+    VNodeBase* const* m_end;
+};
+
+// AST节点都分配在VNodeArena中, 父子之间用裸指针相连
+// 建树完成后节点是只读的, 遍历状态由调用方持有(见VNodeCursor)
 class VNodeBase {
 public:
-    using ChidrenIter = std::vector<std::shared_ptr<VNodeBase>>::const_iterator;
     VNodeBase() = default;
     explicit VNodeBase(bool isCorrect) :
         m_isCorrect(isCorrect) {}
     virtual VType getType() const = 0;
-    virtual void addChild(std::shared_ptr<VNodeBase>&& child) = 0;
-    virtual const std::vector<std::shared_ptr<VNodeBase>>& getChildren(int offset = 0) const = 0;
-    virtual ChidrenIter getChildIter(int offset = 0, bool enableDbg = true) const = 0;
-    virtual void resetIter() = 0;
+    virtual void addChild(VNodeBase* child) = 0;
+    virtual VNodeRange getChildren() const = 0;
+    virtual VNodeBase* getChild(size_t index) const = 0;
     virtual size_t getChildrenNum() const = 0;
-    virtual bool nextChild(int offset = 1, bool enableDbg = true) = 0;
-    virtual void dumpToFile(std::ostream& os) = 0;
+    virtual void dumpToFile(DumpWriter& os) = 0;
     virtual VNodeEnum getNodeEnum() const = 0;
     virtual SymbolEnum getSymbol() const = 0;
 
 public:
     int getLevel() const { return m_level; }
     void setLevel(int level) { m_level = level; }
-    std::weak_ptr<VNodeBase> getParent() { return m_parent; }
-    void setParent(const std::shared_ptr<VNodeBase> parent) {
-        m_parent = std::weak_ptr<VNodeBase>(parent);
-    }
+    VNodeBase* getParent() const { return m_parent; }
+    void setParent(VNodeBase* parent) { m_parent = parent; }
     void setCorrect(bool correct) { m_isCorrect = correct; }
     bool isCorrect() const { return m_isCorrect; }
 
 protected:
-    std::weak_ptr<VNodeBase> m_parent;
+    VNodeBase* m_parent{nullptr};
     int m_level{-1};
     bool m_isCorrect{false};
 };
 
 class VNodeLeaf : public VNodeBase {
 public:
-    explicit VNodeLeaf(SymbolEnum symbol, Token token, bool isCorrect = true) :
+    explicit VNodeLeaf(SymbolEnum symbol, const Token& token, bool isCorrect = true) :
         VNodeBase(isCorrect),
         m_symbol(symbol), m_token(token) {}
     virtual VType getType() const override { return VType::VT; }
-    virtual void addChild(std::shared_ptr<VNodeBase>&& child) override {
+    virtual void addChild(VNodeBase* child) override {
         DBG_ERROR("Leaf node add child error");
     }
-    virtual void dumpToFile(std::ostream& os) override {
+    virtual void dumpToFile(DumpWriter& os) override {
         for (int i = 1; i < m_level; i++) os << "  ";
-        os << getSymbolText(m_symbol) << " " << m_token.literal << "\n";
+        os << getSymbolText(m_symbol) << " " << m_token.getLiteral() << "\n";
     }
-    virtual const std::vector<std::shared_ptr<VNodeBase>>& getChildren(int offset = 0) const override {
+    virtual VNodeRange getChildren() const override {
         DBG_ERROR("Try to get children from a leaf node!");
-        static const std::vector<std::shared_ptr<VNodeBase>> dummy;
-        return dummy;
+        return VNodeRange(nullptr, nullptr);
     };
-    virtual ChidrenIter getChildIter(int offset = 0, bool enableDbg = true) const override {
-        if (enableDbg) {
-            DBG_ERROR("Try to get childIter from a leaf node!");
-        }
-        return ChidrenIter();
-    }
-    virtual void resetIter() override {
-        // Do nothing
+    virtual VNodeBase* getChild(size_t /*index*/) const override {
+        DBG_ERROR("Try to get child from a leaf node!");
+        return nullptr;
     }
     virtual size_t getChildrenNum() const override {
         DBG_ERROR("Try to get children number from a leaf node!");
         return 0;
     }
-    virtual bool nextChild(int offset = 1, bool enableDbg = true) override {
-        DBG_ERROR("Try to iterate children nodes of a leaf node!");
-        return false;
-    }
     virtual VNodeEnum getNodeEnum() const override {
         DBG_ERROR("Try to get node enum of a leaf node!");
         return VNodeEnum::UNKNOWNN;
@@ -87,65 +92,89 @@ private:
     Token m_token;
 };
 
-class VNodeBranch : public VNodeBase, public std::enable_shared_from_this<VNodeBranch> {
+class VNodeBranch : public VNodeBase {
 public:
-    explicit VNodeBranch(VNodeEnum nodeEnum, bool isCorrect = true) :
+    explicit VNodeBranch(VNodeArena& arena, VNodeEnum nodeEnum, bool isCorrect = true) :
         VNodeBase(isCorrect),
-        m_nodeEnum(nodeEnum) {}
+        m_arena(&arena), m_nodeEnum(nodeEnum) {}
     virtual VType getType() const override { return VType::VN; }
-    virtual void addChild(std::shared_ptr<VNodeBase>&& child) override {
-        child->setParent(shared_from_this());
+    virtual void addChild(VNodeBase* child) override {
+        child->setParent(this);
         if (!child->isCorrect()) {
             setCorrect(false);
         }
-        m_childrenNodes.push_back(std::move(child));
-        m_currentChild = m_childrenNodes.begin();
+        if (m_childrenNum == m_childrenCapacity) {
+            // 子节点数组同样在arena中分配, 扩容时旧数组随arena一起释放
+            size_t capacity = m_childrenCapacity == 0 ? 4 : m_childrenCapacity * 2;
+            auto children = static_cast<VNodeBase**>(m_arena->allocate(capacity * sizeof(VNodeBase*), alignof(VNodeBase*)));
+            if (m_childrenNum != 0) {
+                std::memcpy(children, m_childrenNodes, m_childrenNum * sizeof(VNodeBase*));
+            }
+            m_childrenNodes = children;
+            m_childrenCapacity = capacity;
+        }
+        m_childrenNodes[m_childrenNum++] = child;
     }
-    virtual void dumpToFile(std::ostream& os) override {
+    virtual void dumpToFile(DumpWriter& os) override {
         for (int i = 1; i < m_level; i++) os << "  ";
         os << "<" << getVNodeEnumText(m_nodeEnum) << ">\n";
     }
-    virtual const std::vector<std::shared_ptr<VNodeBase>>& getChildren(int offset = 0) const override { return m_childrenNodes; };
-    virtual ChidrenIter getChildIter(int offset = 0, bool enableDbg = true) const override {
-        if (m_currentChild + offset < m_childrenNodes.end()) {
-            return m_currentChild + offset;
+    virtual VNodeRange getChildren() const override { return VNodeRange(m_childrenNodes, m_childrenNodes + m_childrenNum); };
+    virtual VNodeBase* getChild(size_t index) const override {
+        if (index < m_childrenNum) {
+            return m_childrenNodes[index];
+        }
+        DBG_ERROR("Child index out of range!");
+        return nullptr;
+    }
+    virtual size_t getChildrenNum() const override {
+        return m_childrenNum;
+    }
+    virtual VNodeEnum getNodeEnum() const override { return m_nodeEnum; }
+    virtual SymbolEnum getSymbol() const override {
+        DBG_ERROR("Try to get symbol enum of a branch node!");
+        return SymbolEnum::UNKNOWN;
+    }
+
+private:
+    VNodeArena* m_arena;
+    VNodeEnum m_nodeEnum{VNodeEnum::COMPUNIT};
+    VNodeBase** m_childrenNodes{nullptr};
+    size_t m_childrenNum{0};
+    size_t m_childrenCapacity{0};
+};
+
+// 顺序遍历某个节点子节点的游标, 放在调用方的栈上, 多个遍历者可以同时读同一棵树
+// 越界时保持在原位置并返回当前子节点
+class VNodeCursor {
+public:
+    explicit VNodeCursor(const VNodeBase* node) :
+        m_children(node->getChildren()) {}
+    VNodeBase* get(size_t offset = 0, bool enableDbg = true) const {
+        if (m_index + offset < m_children.size()) {
+            return m_children[m_index + offset];
         } else {
             if (enableDbg) {
                 DBG_LOG("Iterator out of range!");
             }
-            return m_currentChild;
-        }
-    }
-    virtual void resetIter() override {
-        m_currentChild = m_childrenNodes.begin();
-        for (auto& child : m_childrenNodes) {
-            child->resetIter();
+            return m_index < m_children.size() ? m_children[m_index] : nullptr;
         }
     }
-    virtual size_t getChildrenNum() const override {
-        return m_childrenNodes.size();
-    }
-    virtual bool nextChild(int offset = 1, bool enableDbg = true) override {
-        m_currentChild += offset;
-        if (m_currentChild < m_childrenNodes.end()) {
+    bool next(size_t offset = 1, bool enableDbg = true) {
+        if (m_index + offset < m_children.size()) {
+            m_index += offset;
             return true;
         } else {
-            m_currentChild -= offset;
             if (enableDbg) {
                 DBG_LOG("Iterator out of range!");
             }
             return false;
         }
     }
-    virtual VNodeEnum getNodeEnum() const override { return m_nodeEnum; }
-    virtual SymbolEnum getSymbol() const override {
-        DBG_ERROR("Try to get symbol enum of a branch node!");
-        return SymbolEnum::UNKNOWN;
-    }
+    size_t getIndex() const { return m_index; }
 
 private:
-    VNodeEnum m_nodeEnum{VNodeEnum::COMPUNIT};
-    std::vector<std::shared_ptr<VNodeBase>> m_childrenNodes;
-    ChidrenIter m_currentChild;
+    VNodeRange m_children;
+    size_t m_index{0};
 };
 #endif
\ No newline at end of file
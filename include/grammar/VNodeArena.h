@@ -0,0 +1,56 @@
+#ifndef VNODE_ARENA_H
+#define VNODE_ARENA_H
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// AST节点的bump-pointer分配器
+// 节点及其子节点数组都从大块内存中顺序切分, 节点不会被单独析构, 整棵树随release一次性释放
+class VNodeArena {
+public:
+    VNodeArena() = default;
+    ~VNodeArena() { release(); }
+
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "Nodes in VNodeArena are never destructed");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    void* allocate(std::size_t size, std::size_t align) {
+        auto curr = (reinterpret_cast<std::uintptr_t>(m_curr) + align - 1) & ~(align - 1);
+        if (m_curr == nullptr || curr + size > reinterpret_cast<std::uintptr_t>(m_end)) {
+            return allocateSlow(size, align);
+        }
+        m_curr = reinterpret_cast<char*>(curr + size);
+        return reinterpret_cast<void*>(curr);
+    }
+
+    // 丢弃已分配的全部节点但保留普通大小的块, 之后的分配从第一块重新开始
+    void reset();
+    void release();
+    std::size_t getAllocatedBytes() const { return m_allocatedBytes + m_largeBytes; }
+
+private:
+    VNodeArena(const VNodeArena&) = delete;
+    VNodeArena& operator=(const VNodeArena&) = delete;
+
+private:
+    void* allocateSlow(std::size_t size, std::size_t align);
+    void useBlock(std::size_t index);
+
+private:
+    static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+    std::vector<char*> m_blocks;      // 大小为BLOCK_SIZE的块
+    std::vector<char*> m_largeBlocks; // 超大分配单独占用的块
+    std::size_t m_blockIndex{0};      // 当前正在切分的块在m_blocks中的下标
+    char* m_curr{nullptr};
+    char* m_end{nullptr};
+    std::size_t m_allocatedBytes{0}; // 普通块占用的字节数
+    std::size_t m_largeBytes{0};     // 超大块占用的字节数
+};
+
+#endif
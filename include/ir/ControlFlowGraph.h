@@ -36,6 +36,7 @@ struct LoopInfo {
     // 返回bb所处的最深的循环
     std::unordered_map<BasicBlock*, Loop*> bbLoop;
     std::vector<Loop*> topLevel;
+    std::vector<std::unique_ptr<Loop>> loops; // 持有所有循环
 
     // 若bb不在任何循环中，返回0
     int depthOf(BasicBlock* bb) {
@@ -8,13 +8,20 @@
 #include <unordered_set>
 #include <map>
 #include <functional>
+#include <array>
+#include <mutex>
+#include <unordered_map>
 
 #include "IRTypeEnum.h"
 #include <symbol/SymbolTableItem.h>
 #include <symbol/ValueType.h>
 #include <Utils.h>
+#include <DumpWriter.h>
+#include <IList.h>
+#include <SlabArena.h>
+#include <Casting.h>
 
-static void printDimensions(std::ostream& os, std::vector<size_t>& dims);
+class ThreadPool;
 
 struct Use;
 /*
@@ -64,117 +71,165 @@ constexpr static std::pair<IRType, IRType>
         {IRType::Or, IRType::Or},
 };
 
-template <class T>
-class IndexMapper {
+// value的使用链表的只读视图, 按加入的先后顺序遍历
+class UseList {
 public:
-    int alloc() { return m_index++; }
-    int get(T* t) {
-        auto res = m_mapper.insert({t, m_index});
-        auto it = res.first;
-        auto inserted = res.second;
-        m_index += inserted;
-        return it->second;
-    }
-    void reset() {
-        m_index = 0;
-        m_mapper.clear();
-    }
+    class Iterator {
+    public:
+        explicit Iterator(Use* use) :
+            m_use(use) {}
+        Use* operator*() const { return m_use; }
+        Iterator& operator++();
+        bool operator!=(const Iterator& rhs) const { return m_use != rhs.m_use; }
+
+    private:
+        Use* m_use;
+    };
+    explicit UseList(Use* head) :
+        m_head(head) {}
+    Iterator begin() const { return Iterator(m_head); }
+    Iterator end() const { return Iterator(nullptr); }
+    bool empty() const { return m_head == nullptr; }
+    Use* front() const { return m_head; }
+
+private:
+    Use* m_head;
+};
+
+// 指令操作数的只读视图, 按值返回, 不分配内存
+// 固定的操作数(至多2个)直接存放指针, 变长的参数列表只记录vector中的首地址和个数
+class OperandRange {
+public:
+    class Iterator {
+    public:
+        Iterator(const OperandRange* range, std::size_t index) :
+            m_range(range), m_index(index) {}
+        Use* operator*() const { return (*m_range)[m_index]; }
+        Iterator& operator++() {
+            m_index++;
+            return *this;
+        }
+        bool operator!=(const Iterator& rhs) const { return m_index != rhs.m_index; }
+
+    private:
+        const OperandRange* m_range;
+        std::size_t m_index;
+    };
+    OperandRange() = default;
+    OperandRange(Use* op) :
+        m_fixed{op}, m_fixedNum(1) {}
+    OperandRange(Use* op0, Use* op1) :
+        m_fixed{op0, op1}, m_fixedNum(2) {}
+    OperandRange(std::vector<Use>& ops) :
+        m_rest(ops.data()), m_restNum(ops.size()) {}
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, size()); }
+    std::size_t size() const { return m_fixedNum + m_restNum; }
+    bool empty() const { return size() == 0; }
+    inline Use* operator[](std::size_t i) const;
 
 private:
-    std::map<T*, int> m_mapper;
-    int m_index{0};
+    Use* m_fixed[2]{nullptr, nullptr};
+    std::size_t m_fixedNum{0};
+    Use* m_rest{nullptr};
+    std::size_t m_restNum{0};
 };
 
 class Value {
-    friend class Use;
+    friend struct Use;
 
 public:
     explicit Value(IRType type) :
         m_type(type){};
     virtual ~Value() {}
-    void addUse(Use* use) { m_uses.push_back(use); };
-    void removeUse(Use* use) {
-        for (auto it = m_uses.begin(); it != m_uses.end(); it++) {
-            if (*it == use) {
-                it = m_uses.erase(it);
-                break;
-            }
-        }
-    };
-    std::vector<Use*>& getUses() { return m_uses; }
+    // Use本身就是链表节点, 加入和删除都是O(1)
+    // 常量由模块中的各个函数共享, 不记录使用, 这样各个函数可以并行修改自己的指令
+    inline void addUse(Use* use);
+    inline void removeUse(Use* use);
+    UseList getUses() const { return UseList(m_useHead); }
     void replaceAllUse(Value* value);
     IRType getIrType() const { return m_type; }
-    virtual void printValue(std::ostream& os) {
-        os << "%_x" << s_valueMapper.get(this);
+    virtual void printValue(DumpWriter& os) {
+        os << "%_x" << m_id;
     };
     virtual bool isGlob() { return false; }
-    static IndexMapper<Value> s_valueMapper;
 
 protected:
     IRType m_type;
-    std::vector<Use*> m_uses;
+    int m_id{-1}; // 函数内的稠密编号, 由IrFunc::renumber清空, 首次打印时分配
+    Use* m_useHead{nullptr};
+    Use* m_useTail{nullptr};
 };
 class BasicBlock;
-class Inst : public Value {
+class Inst : public Value, public IListNode<Inst> {
     friend class BasicBlock;
+    friend class IrFunc;
 
 public:
     Inst(IRType type) :
         Value(type){};
     virtual ~Inst() {}
-    virtual std::vector<Use*> getOperands() { return {}; };
-    virtual void toCode(std::ostream& os) { os << "vacantInst"; };
-    void printValue(std::ostream& os) override {
-        Value::printValue(os);
+    static bool classof(const Value* v) {
+        auto type = v->getIrType();
+        return type != IRType::Const && type != IRType::Global && type != IRType::String && type != IRType::Param;
+    }
+    static void* operator new(std::size_t size) { return SlabArena::allocate(size); }
+    static void operator delete(void* ptr, std::size_t size) { SlabArena::deallocate(ptr, size); }
+    virtual OperandRange getOperands() { return {}; };
+    virtual void toCode(DumpWriter& os) { os << "vacantInst"; };
+    void printValue(DumpWriter& os) override {
+        os << "%_x" << getId();
     }
     BasicBlock* getAtBlock() { return m_atBlock; }
+    int getId();
+    int allocTempId();
 
 protected:
-    BasicBlock* m_atBlock;
+    BasicBlock* m_atBlock{nullptr};
 };
 
-class BasicBlock {
+class IrFunc;
+class BasicBlock : public IListNode<BasicBlock> {
     friend class IrFunc;
-    friend class MipsContext;
+    friend class MipsFuncConverter;
 
 public:
     BasicBlock() = default;
+    static void* operator new(std::size_t size) { return SlabArena::allocate(size); }
+    static void operator delete(void* ptr, std::size_t size) { SlabArena::deallocate(ptr, size); }
     std::vector<BasicBlock*>& getPreds() { return m_pred; }
     std::array<BasicBlock*, 2> getSuccs();
     std::array<BasicBlock**, 2> getSuccsRef();
     Inst* pushBackInst(Inst* inst) {
         inst->m_atBlock = this;
-        m_insts.push_back(std::unique_ptr<Inst>(inst));
-        return m_insts.back().get();
+        return m_insts.pushBack(inst);
     };
     void removeInst(Inst* inst) {
-        m_insts.remove_if([inst](std::unique_ptr<Inst>& in) {
-            return inst == in.get();
-        });
+        m_insts.erase(inst);
     }
     Inst* insertFrontInst(Inst* inst) {
         inst->m_atBlock = this;
-        m_insts.push_front(std::unique_ptr<Inst>(inst));
-        return m_insts.front().get();
+        return m_insts.pushFront(inst);
     }
     Inst* nextInst(Inst* inst) {
-        auto finded = std::find_if(m_insts.begin(), m_insts.end(), [inst](std::unique_ptr<Inst>& in) {
-            return in.get() == inst;
-        });
-        if (finded != m_insts.end() && finded != std::prev(m_insts.end())) {
-            return std::next(finded)->get();
+        if (inst->m_atBlock == this && inst->getNext()) {
+            return inst->getNext();
         } else {
             DBG_ERROR("Can not find next inst of current inst!");
             return inst;
         }
     }
-    std::list<std::unique_ptr<Inst>>& getInsts() { return m_insts; }
+    IList<Inst>& getInsts() { return m_insts; }
+    IrFunc* getFunc() { return m_func; }
+    int getId() { return m_id; }
     bool valid();
 
 private:
+    IrFunc* m_func{nullptr};
+    int m_id{-1}; // 在函数中的序号, 由IrFunc::renumber分配
     std::vector<BasicBlock*> m_pred;
     bool m_vis{false};
-    std::list<std::unique_ptr<Inst>> m_insts;
+    IList<Inst> m_insts;
 
 public:
     BasicBlock* idom;                      // 直接支配节点
@@ -182,53 +237,56 @@ public:
     std::vector<BasicBlock*> doms;         // 它支配的节点集
     int domLevel;                          // dom树中的深度，根深度为0
     bool vis;
-    static IndexMapper<BasicBlock> s_bbMapper;
 };
 
 class IrModule;
 class IrFunc {
     friend class IrModule;
     friend class CallInst;
-    friend class MipsContext;
+    friend class MipsFuncConverter;
 
 public:
     explicit IrFunc(FuncItem* funcItem) :
         m_funcItem(funcItem) {}
     explicit IrFunc(const std::string& funcName, const std::string& builtinArgType, ValueTypeEnum retType) :
-        m_isBuiltin(true), m_builtinArgType(builtinArgType) {
-        m_funcItem = new FuncItem(funcName, retType);
-        s_builtinFuncItemsMap[funcName] = m_funcItem;
+        m_isBuiltin(true), m_builtinArgType(builtinArgType), m_builtinFuncItem(new FuncItem(funcName, retType)) {
+        m_funcItem = m_builtinFuncItem.get();
     }
     BasicBlock* firstBasicBlock() {
-        return m_basicBlocks.front().get();
+        return m_basicBlocks.front();
     }
     BasicBlock* pushBackBasicBlock(BasicBlock* basicBlock) {
-        m_basicBlocks.push_back(std::unique_ptr<BasicBlock>(basicBlock));
-        return m_basicBlocks.back().get();
+        basicBlock->m_func = this;
+        return m_basicBlocks.pushBack(basicBlock);
     }
     BasicBlock* nextBasicBlock(BasicBlock* block) {
-        auto finded = std::find_if(m_basicBlocks.begin(), m_basicBlocks.end(), [block](std::unique_ptr<BasicBlock>& b) {
-            return b.get() == block;
-        });
-        if (finded != m_basicBlocks.end() && finded != std::prev(m_basicBlocks.end())) {
-            return std::next(finded)->get();
+        if (block->getNext()) {
+            return block->getNext();
         } else {
             DBG_ERROR("Can not find next block of current block!");
             return block;
         }
     }
     void removeBasicBlock(BasicBlock* block) {
-        m_basicBlocks.remove_if([block](std::unique_ptr<BasicBlock>& bb) {
-            return block == bb.get();
-        });
+        m_basicBlocks.erase(block);
+    }
+    IList<BasicBlock>& getBasicBlocks() { return m_basicBlocks; }
+    // 函数内引用全局变量和参数的value, 随函数释放
+    template <class T>
+    T* addLocalValue(T* value) {
+        m_localValues.emplace_back(value);
+        return value;
     }
-    std::list<std::unique_ptr<BasicBlock>>& getBasicBlocks() { return m_basicBlocks; }
+    SlabArena& getArena() { return m_arena; }
     FuncItem* getFuncItem() { return m_funcItem; }
     bool hasReturn() { return m_funcItem->getReturnValueType() != ValueTypeEnum::VOID_TYPE; }
-    void toCode(std::ostream& os);
+    void toCode(DumpWriter& os);
+    void renumber();
+    int allocId() { return m_idCount++; }
+    void dropAllReferences();
     IrModule* getFromModule() { return m_fromModule; }
     void clearAllVisitFlag() {
-        for (auto& bb : m_basicBlocks) {
+        for (auto bb : m_basicBlocks) {
             bb->vis = false;
         }
     }
@@ -236,14 +294,67 @@ public:
 private:
     FuncItem* m_funcItem{nullptr};
     IrModule* m_fromModule{nullptr};
-    std::list<std::unique_ptr<BasicBlock>> m_basicBlocks;
+    SlabArena m_arena; // 基本块和指令的内存, 必须在m_basicBlocks之后析构
+    IList<BasicBlock> m_basicBlocks;
+    std::vector<std::unique_ptr<Value>> m_localValues;
     bool m_isBuiltin{false};
     std::string m_builtinArgType;
+    std::unique_ptr<FuncItem> m_builtinFuncItem; // 内建函数没有符号表项, 由自己持有
+    int m_idCount{0}; // 下一个value编号, 临时值%_t与%_x共用
 
 public:
     std::set<IrFunc*> callee;
     std::set<IrFunc*> caller;
-    static std::map<std::string, FuncItem*> s_builtinFuncItemsMap;
+};
+
+class ConstValue : public Value {
+    friend class ConstPool;
+
+public:
+    virtual ~ConstValue() {}
+    static bool classof(const Value* v) { return v->getIrType() == IRType::Const; }
+    const int getImm() const { return m_imm; }
+    void printValue(DumpWriter& os) override {
+        os << m_imm;
+    }
+
+private:
+    const int m_imm;
+
+    // 由IrModule::getConst取得
+    explicit ConstValue(int imm) :
+        Value(IRType::Const), m_imm(imm) {}
+};
+
+// 模块拥有的常量池, 同一个整数只对应一个ConstValue
+// [SMALL_MIN, SMALL_MAX]内的常量预先连续创建, 直接按下标取; 其余的放在线性探测的开放寻址哈希表里
+class ConstPool {
+public:
+    ConstPool();
+    ~ConstPool();
+    ConstValue* get(int imm) {
+        if (imm >= SMALL_MIN && imm <= SMALL_MAX) {
+            return &m_small[imm - SMALL_MIN];
+        }
+        return getLarge(imm);
+    }
+
+private:
+    ConstPool(const ConstPool&) = delete;
+    ConstPool& operator=(const ConstPool&) = delete;
+
+    // 加锁, 并行生成函数体时可能同时加入新的常量
+    ConstValue* getLarge(int imm);
+    std::size_t findSlot(int imm);
+    void rehash(std::size_t capacity);
+
+private:
+    static constexpr int SMALL_MIN = -1024;
+    static constexpr int SMALL_MAX = 1024;
+    ConstValue* m_small;              // SMALL_MAX - SMALL_MIN + 1个连续的常量
+    std::vector<ConstValue*> m_table; // 容量为2的幂, 空槽为nullptr
+    std::size_t m_size{0};
+    std::mutex m_mutex;
 };
 
 class GlobalVariable : public Value {
@@ -253,8 +364,9 @@ public:
     explicit GlobalVariable(SymbolTableItem* globalItem) :
         Value(IRType::Global), m_globalItem(globalItem) {}
     virtual ~GlobalVariable() {}
+    static bool classof(const Value* v) { return v->getIrType() == IRType::Global; }
     virtual bool isGlob() override { return true; }
-    virtual void printValue(std::ostream& os) override {
+    virtual void printValue(DumpWriter& os) override {
         os << "%g_" << m_globalItem->getName();
     }
     SymbolTableItem* getGlobalItem() { return m_globalItem; }
@@ -268,17 +380,18 @@ class StringVariable : public Value {
 
 public:
     explicit StringVariable(std::string name, std::string str) :
-        Value(IRType::Global), m_name(name), m_str(str) {
+        Value(IRType::String), m_name(name), m_str(str) {
         int num = replaceAll(m_str, "\\n", "\\0a");
         m_len = m_str.size() - num * 2 + 1;
         m_str += "\\00";
     }
     virtual ~StringVariable() {}
-    virtual void printValue(std::ostream& os) override {
+    static bool classof(const Value* v) { return v->getIrType() == IRType::String; }
+    virtual void printValue(DumpWriter& os) override {
         os << "@" << m_name;
     }
-    void printStrType(std::ostream& os);
-    void printString(std::ostream& os);
+    void printStrType(DumpWriter& os);
+    void printString(DumpWriter& os);
     const std::string& getName() { return m_name; }
     const std::string& getRawStr() {
         replaceAll(m_str, "\\0a", "\\n");
@@ -296,7 +409,8 @@ public:
     explicit ParamVariable(SymbolTableItem* paramItem) :
         Value(IRType::Param), m_paramItem(paramItem) {}
     virtual ~ParamVariable() {}
-    void printValue(std::ostream& os) override {
+    static bool classof(const Value* v) { return v->getIrType() == IRType::Param; }
+    void printValue(DumpWriter& os) override {
         os << "%" << m_paramItem->getName();
     }
     SymbolTableItem* getParamItem() { return m_paramItem; }
@@ -308,14 +422,14 @@ private:
 class IrModule {
     friend class MipsModule;
     friend class MipsContext;
-    friend void memToReg(IrModule& module);
 
 public:
     IrModule() {
         for (int i = 0; i < FUNC_NUM; i++) {
-            s_builtinFuncs.insert({BUILTIN_FUNCS[i][0], new IrFunc(BUILTIN_FUNCS[i][0], BUILTIN_FUNCS[i][1], BUILTIN_FUNCS_RETURN_TYPE[i])});
+            m_builtinFuncs[BUILTIN_FUNCS[i][0]].reset(new IrFunc(BUILTIN_FUNCS[i][0], BUILTIN_FUNCS[i][1], BUILTIN_FUNCS_RETURN_TYPE[i]));
         }
     }
+    ~IrModule();
     IrFunc* addFunc(IrFunc* func) {
         m_funcs.push_back(std::unique_ptr<IrFunc>(func));
         func->m_fromModule = this;
@@ -327,26 +441,30 @@ public:
         return m_globalVariables.back().get();
     }
 
-    StringVariable* addStrVar(const std::string& str) {
-        std::string name = ".str" + std::to_string(m_strVariables.size() + 1);
-        m_strVariables.push_back(std::unique_ptr<StringVariable>(new StringVariable(name, str)));
+    // 字符串按加入模块的顺序命名, 函数体生成完毕后才按函数的顺序加入
+    StringVariable* addStrVar(std::unique_ptr<StringVariable> str) {
+        str->m_name = ".str" + std::to_string(m_strVariables.size() + 1);
+        m_strVariables.push_back(std::move(str));
         return m_strVariables.back().get();
     }
 
     void calPredSucc();
     void addImplicitReturn();
-    void optimizeIrCode(int level);
+    // 各个函数互不依赖, pool不为空时按函数并行执行passes, 期间模块级的数据只读
+    void optimizeIrCode(int level, const std::vector<std::function<void(IrFunc*)>>& passes, ThreadPool* pool = nullptr);
 
+    // 以下三个在并行生成函数体时会被同时调用
     IrFunc* getFunc(FuncItem* funcItem);
-    static IrFunc* getBuiltinFunc(const std::string& funcName);
+    ConstValue* getConst(int imm) { return m_constPool.get(imm); }
+    IrFunc* getBuiltinFunc(const std::string& funcName);
     std::vector<std::unique_ptr<GlobalVariable>>& getGlobalVariables() { return m_globalVariables; }
-    void toCode(std::ostream& os, bool isTest);
-
-public:
-    static std::map<std::string, IrFunc*> s_builtinFuncs;
-    static std::set<IrFunc*> s_usedBuiltinFuncs;
+    void toCode(DumpWriter& os, bool isTest);
 
 private:
+    ConstPool m_constPool; // 在所有函数之后析构
+    std::map<std::string, std::unique_ptr<IrFunc>> m_builtinFuncs;
+    std::set<IrFunc*> m_usedBuiltinFuncs;
+    std::mutex m_builtinMutex; // 保护m_usedBuiltinFuncs
     std::vector<std::unique_ptr<IrFunc>> m_funcs;
     std::vector<std::unique_ptr<GlobalVariable>> m_globalVariables;
     std::vector<std::unique_ptr<StringVariable>> m_strVariables;
@@ -355,6 +473,8 @@ private:
 struct Use {
     Value* value{nullptr};
     Inst* user{nullptr};
+    Use* prev{nullptr}; // value的使用链表中的前后节点
+    Use* next{nullptr};
     Use() = default;
     Use(Value* v, Inst* u) :
         value(v), user(u) {
@@ -382,11 +502,52 @@ struct Use {
     }
 };
 
+void Value::addUse(Use* use) {
+    if (m_type == IRType::Const) {
+        return;
+    }
+    use->prev = m_useTail;
+    use->next = nullptr;
+    if (m_useTail) {
+        m_useTail->next = use;
+    } else {
+        m_useHead = use;
+    }
+    m_useTail = use;
+}
+
+void Value::removeUse(Use* use) {
+    if (m_type == IRType::Const) {
+        return;
+    }
+    if (use->prev) {
+        use->prev->next = use->next;
+    } else {
+        m_useHead = use->next;
+    }
+    if (use->next) {
+        use->next->prev = use->prev;
+    } else {
+        m_useTail = use->prev;
+    }
+    use->prev = use->next = nullptr;
+}
+
+inline UseList::Iterator& UseList::Iterator::operator++() {
+    m_use = m_use->next;
+    return *this;
+}
+
+Use* OperandRange::operator[](std::size_t i) const {
+    return i < m_fixedNum ? m_fixed[i] : m_rest + (i - m_fixedNum);
+}
+
 class BinaryInst : public Inst {
 public:
     BinaryInst(IRType type, Value* lhs, Value* rhs) :
         Inst(type), m_lhs(lhs, this), m_rhs(rhs, this) {}
     virtual ~BinaryInst() {}
+    static bool classof(const Value* v) { return v->getIrType() >= IRType::Add && v->getIrType() <= IRType::Or; }
     bool rhsCanBeImm() {
         // Add, Sub, Rsb, Mul, Div, Mod, Lt, Le, Ge, Gt, Eq, Ne, And, Or
         return (m_type >= IRType::Add && m_type <= IRType::Rsb) || (m_type >= IRType::Lt && m_type <= IRType::Or);
@@ -410,8 +571,8 @@ public:
         return false;
     }
 
-    virtual std::vector<Use*> getOperands() override { return {&m_lhs, &m_rhs}; };
-    virtual void toCode(std::ostream& os) override;
+    virtual OperandRange getOperands() override { return {&m_lhs, &m_rhs}; };
+    virtual void toCode(DumpWriter& os) override;
     Value* getLhsValue() { return m_lhs.value; }
     Value* getRhsValue() { return m_rhs.value; }
 
@@ -420,30 +581,6 @@ private:
     Use m_rhs;
 };
 
-class ConstValue : public Value {
-public:
-    static ConstValue* get(int imm) {
-        auto pair = POOL.insert({imm, nullptr});
-        auto& inserted = pair.second;
-        auto& it = pair.first;
-        if (inserted) it->second = new ConstValue(imm);
-        return it->second;
-    }
-    virtual ~ConstValue() {}
-    const int getImm() const { return m_imm; }
-    void printValue(std::ostream& os) override {
-        os << m_imm;
-    }
-
-private:
-    const int m_imm;
-    static std::map<int, ConstValue*> POOL;
-
-    // use ConstValue::get instead
-    explicit ConstValue(int imm) :
-        Value(IRType::Const), m_imm(imm) {}
-};
-
 struct BranchInst : public Inst {
     friend class BasicBlock;
 
@@ -451,8 +588,9 @@ public:
     explicit BranchInst(Value* cond, BasicBlock* left, BasicBlock* right) :
         Inst(IRType::Branch), m_cond(cond, this), m_left(left), m_right(right) {}
     virtual ~BranchInst() {}
-    virtual std::vector<Use*> getOperands() override { return {&m_cond}; };
-    virtual void toCode(std::ostream& os) override;
+    static bool classof(const Value* v) { return v->getIrType() == IRType::Branch; }
+    virtual OperandRange getOperands() override { return {&m_cond}; };
+    virtual void toCode(DumpWriter& os) override;
     Value* getCondValue() { return m_cond.value; };
     BasicBlock* getTrueBasicBlock() { return m_left; }
     BasicBlock* getFalseBasicBlock() { return m_right; }
@@ -472,8 +610,9 @@ public:
     explicit JumpInst(BasicBlock* next) :
         Inst(IRType::Jump), m_next(next) {}
     virtual ~JumpInst() {}
-    virtual std::vector<Use*> getOperands() override { return {}; };
-    virtual void toCode(std::ostream& os) override;
+    static bool classof(const Value* v) { return v->getIrType() == IRType::Jump; }
+    virtual OperandRange getOperands() override { return {}; };
+    virtual void toCode(DumpWriter& os) override;
     BasicBlock* getNextBasicBlock() { return m_next; }
 
 private:
@@ -487,8 +626,9 @@ public:
     explicit ReturnInst(Value* ret) :
         Inst(IRType::Return), m_ret(ret, this) {}
     virtual ~ReturnInst() {}
-    virtual std::vector<Use*> getOperands() override { return {&m_ret}; };
-    virtual void toCode(std::ostream& os) override;
+    static bool classof(const Value* v) { return v->getIrType() == IRType::Return; }
+    virtual OperandRange getOperands() override { return {&m_ret}; };
+    virtual void toCode(DumpWriter& os) override;
     Value* getReturnValue() { return m_ret.value; }
 
 private:
@@ -502,9 +642,10 @@ public:
     explicit AccessInst(IRType type, SymbolTableItem* lhs_sym, Value* arr, Value* index) :
         Inst(type), m_lhsSym(lhs_sym), m_arr(arr, this), m_index(index, this) {}
     virtual ~AccessInst(){};
-    virtual std::vector<Use*> getOperands() override { return {&m_arr, &m_index}; };
-    virtual void toCode(std::ostream& os) override { Inst::toCode(os); }
-    virtual void printValue(std::ostream& os) override { Inst::printValue(os); };
+    static bool classof(const Value* v) { return v->getIrType() >= IRType::GetElementPtr && v->getIrType() <= IRType::Store; }
+    virtual OperandRange getOperands() override { return {&m_arr, &m_index}; };
+    virtual void toCode(DumpWriter& os) override { Inst::toCode(os); }
+    virtual void printValue(DumpWriter& os) override { Inst::printValue(os); };
     SymbolTableItem* getLhsSym() { return m_lhsSym; }
     Value* getArrValue() { return m_arr.value; }
     void setArrValue(Value* v) { m_arr.value = v; }
@@ -523,8 +664,9 @@ public:
     explicit GetElementPtrInst(SymbolTableItem* lhsSym, Value* arr, Value* index, int multiplier) :
         AccessInst(IRType::GetElementPtr, lhsSym, arr, index), m_multiplier(multiplier) {}
     virtual ~GetElementPtrInst() {}
-    virtual std::vector<Use*> getOperands() override { return AccessInst::getOperands(); };
-    virtual void toCode(std::ostream& os) override;
+    static bool classof(const Value* v) { return v->getIrType() == IRType::GetElementPtr; }
+    virtual OperandRange getOperands() override { return AccessInst::getOperands(); };
+    virtual void toCode(DumpWriter& os) override;
     int getMultiplier() { return m_multiplier; }
 
 private:
@@ -538,8 +680,9 @@ public:
     explicit LoadInst(SymbolTableItem* lhsSym, Value* arr, Value* index) :
         AccessInst(IRType::Load, lhsSym, arr, index), m_memToken(nullptr, this) {}
     virtual ~LoadInst() {}
-    virtual std::vector<Use*> getOperands() override { return {&m_arr, &m_memToken}; };
-    virtual void toCode(std::ostream& os) override;
+    static bool classof(const Value* v) { return v->getIrType() == IRType::Load; }
+    virtual OperandRange getOperands() override { return {&m_arr, &m_memToken}; };
+    virtual void toCode(DumpWriter& os) override;
 
 private:
     Use m_memToken; // 由memdep pass计算
@@ -552,10 +695,11 @@ public:
     explicit StoreInst(SymbolTableItem* lhsSym, Value* arr, Value* data, Value* index) :
         AccessInst(IRType::Store, lhsSym, arr, index), m_data(data, this) {}
     virtual ~StoreInst() {}
-    virtual std::vector<Use*> getOperands() override { return {&m_arr, &m_data}; };
-    virtual void toCode(std::ostream& os) override;
-    virtual void printValue(std::ostream& os) override {
-        os << "store" << s_valueMapper.get(this);
+    static bool classof(const Value* v) { return v->getIrType() == IRType::Store; }
+    virtual OperandRange getOperands() override { return {&m_arr, &m_data}; };
+    virtual void toCode(DumpWriter& os) override;
+    virtual void printValue(DumpWriter& os) override {
+        os << "store" << getId();
     }
     Value* getDataValue() { return m_data.value; }
 
@@ -573,25 +717,12 @@ public:
         }
     }
     virtual ~CallInst() {}
-    virtual std::vector<Use*> getOperands() override {
-        std::vector<Use*> usePtrs;
-        usePtrs.reserve(m_args.size());
-        for (auto& use : m_args) {
-            usePtrs.push_back(&use);
-        }
-        return usePtrs;
-    };
-    virtual void toCode(std::ostream& os) override;
+    static bool classof(const Value* v) { return v->getIrType() == IRType::Call; }
+    virtual OperandRange getOperands() override { return m_args; };
+    virtual void toCode(DumpWriter& os) override;
 
     IrFunc* getIrFunc() { return m_func; }
-    std::vector<Value*> getArgsValue() {
-        std::vector<Value*> values;
-        values.reserve(m_args.size());
-        for (auto& arg : m_args) {
-            values.push_back(arg.value);
-        }
-        return values;
-    }
+    const std::vector<Use>& getArgs() { return m_args; }
 
 private:
     IrFunc* m_func;
@@ -603,8 +734,9 @@ public:
     AllocaInst(SymbolTableItem* sym) :
         Inst(IRType::Alloca), m_sym(sym) {}
     virtual ~AllocaInst() {}
-    virtual std::vector<Use*> getOperands() override { return {}; };
-    virtual void toCode(std::ostream& os) override;
+    static bool classof(const Value* v) { return v->getIrType() == IRType::Alloca; }
+    virtual OperandRange getOperands() override { return {}; };
+    virtual void toCode(DumpWriter& os) override;
     SymbolTableItem* getSym() { return m_sym; }
 
 private:
@@ -624,23 +756,17 @@ public:
         }
     }
     virtual ~PhiInst() {}
+    static bool classof(const Value* v) { return v->getIrType() == IRType::Phi; }
     std::vector<Use>& getIncomingValues() { return m_incomingValues; }
-    virtual std::vector<Use*> getOperands() override {
-        std::vector<Use*> usePtrs;
-        usePtrs.reserve(m_incomingValues.size());
-        for (auto& use : m_incomingValues) {
-            usePtrs.push_back(&use);
-        }
-        return usePtrs;
-    };
-    virtual void toCode(std::ostream& os) override;
+    virtual OperandRange getOperands() override { return m_incomingValues; };
+    virtual void toCode(DumpWriter& os) override;
 
 private:
     std::vector<Use> m_incomingValues;
 };
 
 class PrintInst : public Inst {
-    friend class MipsContext;
+    friend class MipsFuncConverter;
 
 public:
     explicit PrintInst(const std::vector<StringVariable*>& strParts, std::vector<Value*> args) :
@@ -652,19 +778,13 @@ public:
         m_strParts.assign(strParts.begin(), strParts.end());
     }
     virtual ~PrintInst() {}
-    virtual std::vector<Use*> getOperands() override {
-        std::vector<Use*> usePtrs;
-        usePtrs.reserve(m_args.size());
-        for (auto& use : m_args) {
-            usePtrs.push_back(&use);
-        }
-        return usePtrs;
-    };
-    virtual void toCode(std::ostream& os) override;
+    static bool classof(const Value* v) { return v->getIrType() == IRType::Print; }
+    virtual OperandRange getOperands() override { return m_args; };
+    virtual void toCode(DumpWriter& os) override;
 
 private:
-    void printPutInt(const Use& arg, std::ostream& os);
-    void printPutStr(StringVariable* strPart, std::ostream& os);
+    void printPutInt(const Use& arg, DumpWriter& os);
+    void printPutStr(StringVariable* strPart, DumpWriter& os);
 
 private:
     std::vector<Use> m_args;
@@ -672,11 +792,18 @@ private:
 };
 
 struct IrContext {
+    IrContext();
     IrModule module;
-    IrFunc* function;
-    BasicBlock* basicBlock;
-    std::vector<std::pair<BasicBlock*, BasicBlock*>> loopStk; // <continue, break>
-    static std::vector<std::function<void(IrModule&)>> s_irPasses;
+    std::vector<std::function<void(IrFunc*)>> irPasses; // 逐个函数执行的优化
+};
+
+// 生成一个函数的IR时的状态, 每个函数各有一份, 因此不同函数的函数体可以并行生成
+struct IrBuilder {
+    IrFunc* function{nullptr};
+    BasicBlock* basicBlock{nullptr};
+    std::vector<std::pair<BasicBlock*, BasicBlock*>> loopStk;   // <continue, break>
+    std::unordered_map<SymbolTableItem*, Value*> globalValues; // 全局变量在本函数中的引用
+    std::vector<std::unique_ptr<StringVariable>> strVars;     // 本函数用到的字符串, 尚未加入模块
 };
 
 #endif
\ No newline at end of file
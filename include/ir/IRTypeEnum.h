@@ -12,6 +12,7 @@ enum class IRType {
     Alloca,
     Const,
     Global,
+    String,
     Param,
     Phi,
     Print
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include <ir/IR.h>
+#include <FixedVector.h>
 #include "MipsCodeTypeEnum.h"
 #include "MipsRegEnum.h"
 
@@ -82,12 +83,17 @@ struct Shift {
     }
 };
 
-inline std::ostream& operator<<(std::ostream& os, const Shift& shift) {
-    os << std::string(shift);
+inline DumpWriter& operator<<(DumpWriter& os, const Shift& shift) {
+    switch (shift.type) {
+    case Shift::Type::Sra: os << "sra"; break;
+    case Shift::Type::Sll: os << "sll"; break;
+    case Shift::Type::Srl: os << "srl"; break;
+    default: break;
+    }
     return os;
 }
 
-inline std::ostream& operator<<(std::ostream& os, const MipsCond& cond) {
+inline DumpWriter& operator<<(DumpWriter& os, const MipsCond& cond) {
     if (cond == MipsCond::Eq) {
         os << "seq";
     } else if (cond == MipsCond::Ne) {
@@ -108,9 +114,7 @@ inline std::ostream& operator<<(std::ostream& os, const MipsCond& cond) {
 
 class MipsModule {
     friend class IrModule;
-    friend void allocateRegister(MipsModule& module);
-    friend void computeStackInfo(MipsModule& module);
-    friend void peepholeOpt(MipsModule& module);
+    friend class MipsContext;
 
 public:
     MipsFunc* addFunc(MipsFunc* func) {
@@ -125,7 +129,7 @@ public:
         m_strs.push_back(str);
         return m_strs.back();
     }
-    void toCode(std::ostream& os);
+    void toCode(DumpWriter& os);
 
 private:
     std::vector<std::unique_ptr<MipsFunc>> m_funcs;
@@ -151,10 +155,13 @@ public:
     int getVirtualMax() { return m_virtualMax; }
     int getStackSize() { return m_stackSize; }
     void addStackSize(int addStackSize) { m_stackSize += addStackSize; }
-    void toCode(std::ostream& os);
+    void toCode(DumpWriter& os);
+    int renumber(int firstId);
     std::vector<std::unique_ptr<MipsBasicBlock>>& getMipsBasicBlocks() { return m_basicBlocks; }
+    SlabArena& getArena() { return m_arena; }
 
 private:
+    SlabArena m_arena; // 基本块和指令的内存, 必须在m_basicBlocks之后析构
     std::vector<std::unique_ptr<MipsBasicBlock>> m_basicBlocks;
     IrFunc* m_irFunc;
     // number of virtual registers allocated
@@ -170,87 +177,82 @@ public:
     std::set<MipsReg> usedCalleeSavedRegs;
     std::vector<MipsInst*> spArgFixup;
 };
-class MipsInst {
+class MipsInst : public IListNode<MipsInst> {
     friend class MipsBasicBlock;
 
 public:
     MipsInst(MipsCodeType type) :
         m_type(type) {}
+    virtual ~MipsInst() {}
+    static void* operator new(std::size_t size) { return SlabArena::allocate(size); }
+    static void operator delete(void* ptr, std::size_t size) { SlabArena::deallocate(ptr, size); }
     MipsBasicBlock* getAtBlock() { return m_atBlock; }
-    virtual void toCode(std::ostream& os) = 0;
+    MipsCodeType getCodeType() const { return m_type; }
+    virtual void toCode(DumpWriter& os) = 0;
     void markUseless(bool useless) {
         m_useless = useless;
     }
     bool isUseless() { return m_useless; }
 
 protected:
-    MipsBasicBlock* m_atBlock;
+    MipsBasicBlock* m_atBlock{nullptr};
     MipsCodeType m_type;
     bool m_useless{false};
 };
 
 class MipsBasicBlock {
+    friend class MipsFunc;
     friend void livenessAnalysis(MipsFunc* f);
 
 public:
     explicit MipsBasicBlock(BasicBlock* irbb) :
         m_irBasicBlock(irbb) {}
+    static void* operator new(std::size_t size) { return SlabArena::allocate(size); }
+    static void operator delete(void* ptr, std::size_t size) { SlabArena::deallocate(ptr, size); }
     std::vector<MipsBasicBlock*>& getPreds() { return m_pred; }
     std::array<MipsBasicBlock*, 2>& getSuccs() { return m_succ; };
 
     MipsInst* pushBackInst(MipsInst* inst) {
         inst->m_atBlock = this;
-        m_insts.push_back(std::unique_ptr<MipsInst>(inst));
-        return m_insts.back().get();
+        return m_insts.pushBack(inst);
     };
 
+    // insertBefore不在本块中时不插入并返回nullptr
     MipsInst* insertBeforeInst(MipsInst* insertBefore, MipsInst* inst) {
-        inst->m_atBlock = this;
-        auto finded = std::find_if(m_insts.begin(), m_insts.end(), [insertBefore](std::unique_ptr<MipsInst>& in) {
-            return insertBefore == in.get();
-        });
-        if (finded != m_insts.end()) {
-            return m_insts.insert(finded, std::unique_ptr<MipsInst>(inst))->get();
-        } else {
+        if (insertBefore->m_atBlock != this) {
             return nullptr;
         }
+        inst->m_atBlock = this;
+        return m_insts.insertBefore(insertBefore, inst);
     }
 
     MipsInst* insertAfterInst(MipsInst* insertAfter, MipsInst* inst) {
-        inst->m_atBlock = this;
-        auto finded = std::find_if(m_insts.begin(), m_insts.end(), [insertAfter](std::unique_ptr<MipsInst>& in) {
-            return insertAfter == in.get();
-        });
-        if (finded != m_insts.end()) {
-            return m_insts.insert(std::next(finded), std::unique_ptr<MipsInst>(inst))->get();
-        } else {
+        if (insertAfter->m_atBlock != this) {
             return nullptr;
         }
+        inst->m_atBlock = this;
+        return m_insts.insertAfter(insertAfter, inst);
     }
 
     void removeInst(MipsInst* inst) {
-        m_insts.remove_if([inst](std::unique_ptr<MipsInst>& in) {
-            return inst == in.get();
-        });
+        m_insts.erase(inst);
     }
     MipsInst* insertFrontInst(MipsInst* inst) {
         inst->m_atBlock = this;
-        m_insts.push_front(std::unique_ptr<MipsInst>(inst));
-        return m_insts.front().get();
+        return m_insts.pushFront(inst);
     }
-    MipsInst* getFrontInst() { return m_insts.front().get(); }
+    MipsInst* getFrontInst() { return m_insts.front(); }
     void setControlTransferInst(MipsInst* inst) { m_controlTransferInst = inst; }
     MipsInst* getControlTransferInst() { return m_controlTransferInst; }
-    void toCode(std::ostream& os);
-    std::list<std::unique_ptr<MipsInst>>& getMipsInsts() { return m_insts; }
+    void toCode(DumpWriter& os);
+    IList<MipsInst>& getMipsInsts() { return m_insts; }
     BasicBlock* getIrBasicBlock() { return m_irBasicBlock; }
-
-public:
-    static IndexMapper<MipsBasicBlock> s_bbMapper;
+    int getId() { return m_id; }
 
 private:
     BasicBlock* m_irBasicBlock;
-    std::list<std::unique_ptr<MipsInst>> m_insts;
+    int m_id{-1}; // 标号.b后的序号, 由MipsFunc::renumber分配
+    IList<MipsInst> m_insts;
     // predecessor and successor
     std::vector<MipsBasicBlock*> m_pred;
     std::array<MipsBasicBlock*, 2> m_succ;
@@ -326,11 +328,14 @@ struct MipsOperand {
         return prefix + std::to_string(this->value);
     }
 
-    friend std::ostream& operator<<(std::ostream& os, const MipsOperand& op) {
+    friend DumpWriter& operator<<(DumpWriter& os, const MipsOperand& op) {
         if (op.isAllocated() || op.isPrecolored()) {
-            os << s_realRegMap[(MipsReg)op.value];
+            os << s_realRegNames[op.value];
         } else {
-            os << std::string(op);
+            if (op.isVirtual()) {
+                os << 'v';
+            }
+            os << op.value;
         }
         return os;
     }
@@ -355,13 +360,19 @@ struct hash<std::pair<MipsOperand, MipsOperand>> {
 };
 } // namespace std
 
+// 一条指令的def和use, 按值返回不分配内存
+// call最多def a0-a3和sp共5个, use a0-a3共4个; 其余指令def至多1个, use至多2个
+using MipsDefUse = std::pair<FixedVector<MipsOperand, 5>, FixedVector<MipsOperand, 4>>;
+using MipsDefUsePtr = std::pair<MipsOperand*, FixedVector<MipsOperand*, 2>>;
+
 class MipsBinary : public MipsInst {
-    friend std::pair<std::vector<MipsOperand>, std::vector<MipsOperand>> getDefUse(MipsInst* inst);
-    friend std::pair<MipsOperand*, std::vector<MipsOperand*>> getDefUsePtr(MipsInst* inst);
+    friend MipsDefUse getDefUse(MipsInst* inst);
+    friend MipsDefUsePtr getDefUsePtr(MipsInst* inst);
 
 public:
     MipsBinary(MipsCodeType type, MipsOperand dst, MipsOperand lhs, MipsOperand rhs) :
         MipsInst(type), m_dst(dst), m_lhs(lhs), m_rhs(rhs) {}
+    static bool classof(const MipsInst* inst) { return inst->getCodeType() >= MipsCodeType::Add && inst->getCodeType() <= MipsCodeType::Or; }
 
     bool isIdentity() {
         switch (m_type) {
@@ -372,8 +383,8 @@ public:
             return false;
         }
     }
-    void toCode(std::ostream& os) override;
-    std::string instString() {
+    void toCode(DumpWriter& os) override;
+    const char* instString() {
         switch (m_type) {
         case MipsCodeType::Add: return "add";
         case MipsCodeType::Sub: return "sub";
@@ -394,13 +405,14 @@ private:
 
 class MipsMove : public MipsInst {
     friend struct MipsMoveCompare;
-    friend std::pair<std::vector<MipsOperand>, std::vector<MipsOperand>> getDefUse(MipsInst* inst);
-    friend std::pair<MipsOperand*, std::vector<MipsOperand*>> getDefUsePtr(MipsInst* inst);
+    friend MipsDefUse getDefUse(MipsInst* inst);
+    friend MipsDefUsePtr getDefUsePtr(MipsInst* inst);
 
 public:
     MipsMove(MipsOperand dst, MipsOperand rhs) :
         MipsInst(MipsCodeType::Move), m_dst(dst), m_rhs(rhs) {}
-    virtual void toCode(std::ostream& os) override;
+    static bool classof(const MipsInst* inst) { return inst->getCodeType() == MipsCodeType::Move; }
+    virtual void toCode(DumpWriter& os) override;
     MipsOperand getDst() { return m_dst; }
     MipsOperand getRhs() { return m_rhs; }
 
@@ -418,13 +430,14 @@ struct MipsMoveCompare {
 };
 
 class MipsShift : public MipsInst {
-    friend std::pair<std::vector<MipsOperand>, std::vector<MipsOperand>> getDefUse(MipsInst* inst);
-    friend std::pair<MipsOperand*, std::vector<MipsOperand*>> getDefUsePtr(MipsInst* inst);
+    friend MipsDefUse getDefUse(MipsInst* inst);
+    friend MipsDefUsePtr getDefUsePtr(MipsInst* inst);
 
 public:
     MipsShift(Shift shiftKind, MipsOperand dst, MipsOperand lhs, int shift) :
         MipsInst(MipsCodeType::Shift), m_shiftKind(shiftKind), m_dst(dst), m_lhs(lhs), m_shift(shift) {}
-    virtual void toCode(std::ostream& os) override;
+    static bool classof(const MipsInst* inst) { return inst->getCodeType() == MipsCodeType::Shift; }
+    virtual void toCode(DumpWriter& os) override;
 
 private:
     Shift m_shiftKind;
@@ -434,13 +447,14 @@ private:
 };
 
 class MipsBranch : public MipsInst {
-    friend std::pair<std::vector<MipsOperand>, std::vector<MipsOperand>> getDefUse(MipsInst* inst);
-    friend std::pair<MipsOperand*, std::vector<MipsOperand*>> getDefUsePtr(MipsInst* inst);
+    friend MipsDefUse getDefUse(MipsInst* inst);
+    friend MipsDefUsePtr getDefUsePtr(MipsInst* inst);
 
 public:
     MipsBranch(MipsOperand lhs, MipsOperand rhs, MipsBasicBlock* target) :
         MipsInst(MipsCodeType::Branch), m_lhs(lhs), m_rhs(rhs), m_target(target) {}
-    virtual void toCode(std::ostream& os) override;
+    static bool classof(const MipsInst* inst) { return inst->getCodeType() == MipsCodeType::Branch; }
+    virtual void toCode(DumpWriter& os) override;
 
 private:
     MipsOperand m_lhs;
@@ -449,13 +463,14 @@ private:
 };
 
 class MipsJump : public MipsInst {
-    friend std::pair<std::vector<MipsOperand>, std::vector<MipsOperand>> getDefUse(MipsInst* inst);
-    friend std::pair<MipsOperand*, std::vector<MipsOperand*>> getDefUsePtr(MipsInst* inst);
+    friend MipsDefUse getDefUse(MipsInst* inst);
+    friend MipsDefUsePtr getDefUsePtr(MipsInst* inst);
 
 public:
     MipsJump(MipsBasicBlock* target) :
         MipsInst(MipsCodeType::Jump), m_target(target) {}
-    virtual void toCode(std::ostream& os) override;
+    static bool classof(const MipsInst* inst) { return inst->getCodeType() == MipsCodeType::Jump; }
+    virtual void toCode(DumpWriter& os) override;
     MipsBasicBlock* getTarget() { return m_target; }
 
 private:
@@ -463,26 +478,28 @@ private:
 };
 
 class MipsReturn : public MipsInst {
-    friend std::pair<std::vector<MipsOperand>, std::vector<MipsOperand>> getDefUse(MipsInst* inst);
-    friend std::pair<MipsOperand*, std::vector<MipsOperand*>> getDefUsePtr(MipsInst* inst);
+    friend MipsDefUse getDefUse(MipsInst* inst);
+    friend MipsDefUsePtr getDefUsePtr(MipsInst* inst);
 
 public:
     MipsReturn(MipsFunc* func) :
         MipsInst(MipsCodeType::Return), m_retFunc(func) {}
-    virtual void toCode(std::ostream& os) override;
+    static bool classof(const MipsInst* inst) { return inst->getCodeType() == MipsCodeType::Return; }
+    virtual void toCode(DumpWriter& os) override;
 
 private:
     MipsFunc* m_retFunc;
 };
 
 class MipsAccess : public MipsInst {
-    friend std::pair<std::vector<MipsOperand>, std::vector<MipsOperand>> getDefUse(MipsInst* inst);
-    friend std::pair<MipsOperand*, std::vector<MipsOperand*>> getDefUsePtr(MipsInst* inst);
+    friend MipsDefUse getDefUse(MipsInst* inst);
+    friend MipsDefUsePtr getDefUsePtr(MipsInst* inst);
 
 public:
     MipsAccess(MipsCodeType type, MipsOperand addr, int offset) :
         MipsInst(type), m_addr(addr), m_offset(offset) {}
-    virtual void toCode(std::ostream& os) override{};
+    static bool classof(const MipsInst* inst) { return inst->getCodeType() == MipsCodeType::Load || inst->getCodeType() == MipsCodeType::Store; }
+    virtual void toCode(DumpWriter& os) override{};
     void setOffset(int offset) { m_offset = offset; }
     int getOffset() { return m_offset; }
     MipsOperand getAddr() { return m_addr; }
@@ -493,13 +510,14 @@ protected:
 };
 
 class MipsLoad : public MipsAccess {
-    friend std::pair<std::vector<MipsOperand>, std::vector<MipsOperand>> getDefUse(MipsInst* inst);
-    friend std::pair<MipsOperand*, std::vector<MipsOperand*>> getDefUsePtr(MipsInst* inst);
+    friend MipsDefUse getDefUse(MipsInst* inst);
+    friend MipsDefUsePtr getDefUsePtr(MipsInst* inst);
 
 public:
     MipsLoad(MipsOperand dst, MipsOperand addr, int offset) :
         MipsAccess(MipsCodeType::Load, addr, offset), m_dst(dst) {}
-    virtual void toCode(std::ostream& os) override;
+    static bool classof(const MipsInst* inst) { return inst->getCodeType() == MipsCodeType::Load; }
+    virtual void toCode(DumpWriter& os) override;
     MipsOperand getDst() { return m_dst; }
 
 private:
@@ -507,13 +525,14 @@ private:
 };
 
 class MipsStore : public MipsAccess {
-    friend std::pair<std::vector<MipsOperand>, std::vector<MipsOperand>> getDefUse(MipsInst* inst);
-    friend std::pair<MipsOperand*, std::vector<MipsOperand*>> getDefUsePtr(MipsInst* inst);
+    friend MipsDefUse getDefUse(MipsInst* inst);
+    friend MipsDefUsePtr getDefUsePtr(MipsInst* inst);
 
 public:
     explicit MipsStore(MipsOperand data, MipsOperand addr, int offset) :
         MipsAccess(MipsCodeType::Store, addr, offset), m_data(data) {}
-    virtual void toCode(std::ostream& os) override;
+    static bool classof(const MipsInst* inst) { return inst->getCodeType() == MipsCodeType::Store; }
+    virtual void toCode(DumpWriter& os) override;
     MipsOperand getData() { return m_data; }
 
 private:
@@ -521,13 +540,14 @@ private:
 };
 
 class MipsCompare : public MipsInst {
-    friend std::pair<std::vector<MipsOperand>, std::vector<MipsOperand>> getDefUse(MipsInst* inst);
-    friend std::pair<MipsOperand*, std::vector<MipsOperand*>> getDefUsePtr(MipsInst* inst);
+    friend MipsDefUse getDefUse(MipsInst* inst);
+    friend MipsDefUsePtr getDefUsePtr(MipsInst* inst);
 
 public:
     explicit MipsCompare(MipsCond cond, MipsOperand dst, MipsOperand lhs, MipsOperand rhs) :
         MipsInst(MipsCodeType::Compare), m_cond(cond), m_dst(dst), m_lhs(lhs), m_rhs(rhs) {}
-    virtual void toCode(std::ostream& os) override;
+    static bool classof(const MipsInst* inst) { return inst->getCodeType() == MipsCodeType::Compare; }
+    virtual void toCode(DumpWriter& os) override;
 
 private:
     MipsCond m_cond;
@@ -537,36 +557,39 @@ private:
 };
 
 class MipsCall : public MipsInst {
-    friend std::pair<std::vector<MipsOperand>, std::vector<MipsOperand>> getDefUse(MipsInst* inst);
-    friend std::pair<MipsOperand*, std::vector<MipsOperand*>> getDefUsePtr(MipsInst* inst);
+    friend MipsDefUse getDefUse(MipsInst* inst);
+    friend MipsDefUsePtr getDefUsePtr(MipsInst* inst);
 
 public:
     explicit MipsCall(FuncItem* func) :
         MipsInst(MipsCodeType::Call), m_func(func) {}
-    virtual void toCode(std::ostream& os) override;
+    static bool classof(const MipsInst* inst) { return inst->getCodeType() == MipsCodeType::Call; }
+    virtual void toCode(DumpWriter& os) override;
 
 private:
     FuncItem* m_func;
 };
 
 class MipsSysCall : public MipsInst {
-    friend std::pair<std::vector<MipsOperand>, std::vector<MipsOperand>> getDefUse(MipsInst* inst);
-    friend std::pair<MipsOperand*, std::vector<MipsOperand*>> getDefUsePtr(MipsInst* inst);
+    friend MipsDefUse getDefUse(MipsInst* inst);
+    friend MipsDefUsePtr getDefUsePtr(MipsInst* inst);
 
 public:
     explicit MipsSysCall() :
-        MipsInst(MipsCodeType::Call) {}
-    virtual void toCode(std::ostream& os) override;
+        MipsInst(MipsCodeType::SysCall) {}
+    static bool classof(const MipsInst* inst) { return inst->getCodeType() == MipsCodeType::SysCall; }
+    virtual void toCode(DumpWriter& os) override;
 };
 
 class MipsGlobal : public MipsInst {
-    friend std::pair<std::vector<MipsOperand>, std::vector<MipsOperand>> getDefUse(MipsInst* inst);
-    friend std::pair<MipsOperand*, std::vector<MipsOperand*>> getDefUsePtr(MipsInst* inst);
+    friend MipsDefUse getDefUse(MipsInst* inst);
+    friend MipsDefUsePtr getDefUsePtr(MipsInst* inst);
 
 public:
     MipsGlobal(SymbolTableItem* sym, MipsOperand dst) :
         MipsInst(MipsCodeType::Global), m_sym(sym), m_dst(dst) {}
-    virtual void toCode(std::ostream& os) override;
+    static bool classof(const MipsInst* inst) { return inst->getCodeType() == MipsCodeType::Global; }
+    virtual void toCode(DumpWriter& os) override;
 
 private:
     MipsOperand m_dst;
@@ -574,19 +597,20 @@ private:
 };
 
 class MipsString : public MipsInst {
-    friend std::pair<std::vector<MipsOperand>, std::vector<MipsOperand>> getDefUse(MipsInst* inst);
-    friend std::pair<MipsOperand*, std::vector<MipsOperand*>> getDefUsePtr(MipsInst* inst);
+    friend MipsDefUse getDefUse(MipsInst* inst);
+    friend MipsDefUsePtr getDefUsePtr(MipsInst* inst);
 
 public:
     MipsString(MipsOperand dst, StringVariable* strVar) :
-        MipsInst(MipsCodeType::Global), m_strVar(strVar), m_dst(dst) {}
-    virtual void toCode(std::ostream& os) override;
+        MipsInst(MipsCodeType::String), m_strVar(strVar), m_dst(dst) {}
+    static bool classof(const MipsInst* inst) { return inst->getCodeType() == MipsCodeType::String; }
+    virtual void toCode(DumpWriter& os) override;
 
 private:
     MipsOperand m_dst;
     StringVariable* m_strVar;
 };
 
-std::pair<std::vector<MipsOperand>, std::vector<MipsOperand>> getDefUse(MipsInst* inst);
-std::pair<MipsOperand*, std::vector<MipsOperand*>> getDefUsePtr(MipsInst* inst);
+MipsDefUse getDefUse(MipsInst* inst);
+MipsDefUsePtr getDefUsePtr(MipsInst* inst);
 #endif
\ No newline at end of file
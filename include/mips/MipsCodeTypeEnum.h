@@ -12,7 +12,9 @@ enum class MipsCodeType {
     Store, // Memory
     Compare,
     Call,
+    SysCall,
     Global,
+    String,
     Print, // for printing
 };
 #endif
\ No newline at end of file
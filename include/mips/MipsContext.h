@@ -4,12 +4,14 @@
 #include <functional>
 
 #include "MipsCode.h"
-class MipsContext {
-    friend class CodeGenerator;
+class ThreadPool;
 
+// 把一个IrFunc翻译成MipsFunc, 只读访问模块级的数据, 不同函数的翻译可以并行
+class MipsFuncConverter {
 public:
-    void convertMipsCode(IrModule& irModule);
-    void optimizeMipsCode(int optLevel);
+    MipsFuncConverter(IrFunc* irFunc, MipsFunc* mipsFunc) :
+        m_irFunc(irFunc), m_mipsFunc(mipsFunc) {}
+    void convert();
 
 private:
     void mapBasicBlocks();
@@ -30,11 +32,10 @@ private:
     void convertPrintInst(PrintInst* inst);
 
 private:
-    MipsModule m_module;
     IrFunc* m_irFunc;
     MipsFunc* m_mipsFunc;
-    MipsBasicBlock* m_mipsBasicBlock;
-    BasicBlock* m_basicBlock;
+    MipsBasicBlock* m_mipsBasicBlock{nullptr};
+    BasicBlock* m_basicBlock{nullptr};
     //  machine bb 1-to-1
     std::map<BasicBlock*, MipsBasicBlock*> m_bbMap;
     // map value to MipsOperand
@@ -51,9 +52,21 @@ private:
     std::map<BasicBlock*, std::vector<std::pair<MipsOperand, MipsOperand>>> m_mv;
     // virtual registers
     int m_virtualMax = 0;
-    // optimize passes
+};
+
+class MipsContext {
+    friend class CodeGenerator;
+
 public:
-    static std::vector<std::function<void(MipsModule&)>> s_mipsPasses;
+    MipsContext();
+    // pool不为空时按函数并行, MipsFunc的顺序与IrFunc相同
+    void convertMipsCode(IrModule& irModule, ThreadPool* pool = nullptr);
+    void optimizeMipsCode(int optLevel, ThreadPool* pool = nullptr);
+
+private:
+    MipsModule m_module;
+    // optimize passes, 逐个函数执行
+    std::vector<std::function<void(MipsFunc*)>> m_mipsPasses;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,5 +1,5 @@
 #ifndef IR_OPT_PASS_H
 #define IR_OPT_PASS_H
-class IrModule;
-void memToReg(IrModule& module);
+class IrFunc;
+void memToReg(IrFunc* func);
 #endif
\ No newline at end of file
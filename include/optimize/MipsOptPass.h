@@ -1,7 +1,7 @@
 #ifndef ALLOCATE_REGISTER_H
 #define ALLOCATE_REGISTER_H
-class MipsModule;
-void allocateRegister(MipsModule& module);
-void peepholeOpt(MipsModule& module);
-void computeStackInfo(MipsModule& module);
+class MipsFunc;
+void allocateRegister(MipsFunc* f);
+void peepholeOpt(MipsFunc* func);
+void computeStackInfo(MipsFunc* f);
 #endif
\ No newline at end of file
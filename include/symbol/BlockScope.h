@@ -14,13 +14,12 @@ enum class BlockScopeType : unsigned int {
 };
 
 class SymbolTable;
+// 作用域只负责保存其中定义的符号(按定义顺序, 用于dumpTable), 名字查找由SymbolTable的作用域哈希表完成
 class BlockScope {
 public:
     explicit BlockScope(SymbolTable& table, BlockScopeType type, int level, BlockScopeHandle parent);
-    SymbolTableItem* findItem(const std::string& name);
-    FuncItem* findFunc(const std::string& name);
-    std::pair<SymbolTableItem*, bool> insertItem(std::unique_ptr<SymbolTableItem>&& item);
-    std::pair<FuncItem*, bool> insertFunc(std::unique_ptr<FuncItem>&& func);
+    SymbolTableItem* insertItem(std::unique_ptr<SymbolTableItem>&& item);
+    FuncItem* insertFunc(std::unique_ptr<FuncItem>&& func);
     std::vector<SymbolTableItem*>& getParamItems() const;
     int getLevel() const { return m_level; }
     BlockScopeType getType() const { return m_type; }
@@ -2,6 +2,7 @@
 #define SYMBOL_TABLE_H
 #include "BlockScope.h"
 #include "SymbolTableItem.h"
+#include <token/Tokenizer.h>
 
 class SymbolTable {
 public:
@@ -14,46 +15,67 @@ public:
     void pushScope(BlockScopeType type);
     void popScope();
 
+    // 名字以标识符token在StringPool中的id为键, 查找时不再对字符串求哈希
     template <typename ItemType>
-    std::pair<ItemType*, bool> insertItem(const std::string& name, typename ItemType::Data data);
-    std::pair<FuncItem*, bool> insertFunc(const std::string& name, FuncItem::Data data);
-    template <typename ItemType>
-    ItemType* makeItem(typename ItemType::Data data);
-    SymbolTableItem* findItem(const std::string& name);
-    FuncItem* findFunc(const std::string& name);
+    std::pair<ItemType*, bool> insertItem(const Token& ident, typename ItemType::Data data);
+    std::pair<FuncItem*, bool> insertFunc(const Token& ident, FuncItem::Data data);
+    SymbolTableItem* findItem(const Token& ident);
+    FuncItem* findFunc(const Token& ident);
+    // 为刚定义的函数建立函数体使用的符号表, 由全局符号表持有
+    SymbolTable* addFuncTable();
     void dumpTable(std::ostream& os);
     void clearSymbolTable();
 
+private:
+    // 函数体的符号表: 局部作用域由自己保存, 在自己的作用域中找不到的名字再到全局符号表中查找
+    // 只能看到在它之前定义的函数; 生成函数体时全局符号表只读, 不同函数的符号表可以在不同线程中使用
+    explicit SymbolTable(SymbolTable* global);
+    SymbolTableItem* findGlobalItem(std::uint32_t nameId) const;
+    FuncItem* findGlobalFunc(std::uint32_t nameId, std::size_t visibleFuncs) const;
+
+    // 名字在某个作用域中的一次定义
+    struct Binding {
+        SymbolTableItem* item;
+        BlockScopeHandle scope;
+        std::uint32_t nameId;
+        int shadowed; // 被它遮蔽的外层绑定在m_bindings中的下标, -1表示没有
+    };
+    Binding* findBinding(std::uint32_t nameId);
+    void bindItem(std::uint32_t nameId, SymbolTableItem* item);
+    void resetBindings();
+
 private:
     std::vector<BlockScope> m_blockScopes;
     BlockScopeHandle m_currScopeHandle;
-    std::vector<SymbolTableItem*> m_tempItems;
+    // 作用域表: 名字id即token字面量的稠密id, 每个名字一条绑定链, 链头是当前可见的最内层定义
+    // 绑定按定义顺序压栈, 退出作用域时弹出该作用域的所有绑定并恢复被遮蔽的链头
+    std::vector<int> m_nameHeads;          // 名字id -> 最内层绑定的下标
+    std::vector<FuncItem*> m_funcs;        // 名字id -> 函数, 函数只定义在全局作用域
+    std::vector<std::size_t> m_funcOrders; // 名字id -> 函数是第几个定义的
+    std::size_t m_funcCount{0};
+    std::vector<Binding> m_bindings;       // 当前可见的所有绑定
+    std::vector<std::size_t> m_scopeMarks; // 每层作用域进入时m_bindings的大小
+    // 函数体的符号表按函数定义的顺序保存, 第0个作用域只是占位
+    std::vector<std::unique_ptr<SymbolTable>> m_funcTables;
+    SymbolTable* m_global{nullptr}; // 函数体的符号表所属的全局符号表
+    std::size_t m_visibleFuncs{0};  // 函数体中可见的函数个数
 };
 
 template <typename ItemType>
-std::pair<ItemType*, bool> SymbolTable::insertItem(const std::string& name, typename ItemType::Data data) {
+std::pair<ItemType*, bool> SymbolTable::insertItem(const Token& ident, typename ItemType::Data data) {
     if (std::is_base_of<SymbolTableItem, ItemType>::value) {
-        auto pair = getCurrentScope().insertItem(std::unique_ptr<ItemType>(new ItemType(name, data)));
-        return std::make_pair(dynamic_cast<ItemType*>(pair.first), pair.second);
+        auto nameId = ident.literalId;
+        // 链头属于当前作用域说明是重定义
+        auto binding = findBinding(nameId);
+        if (binding && binding->scope == m_currScopeHandle) {
+            return std::make_pair(dynamic_cast<ItemType*>(binding->item), false);
+        }
+        auto item = getCurrentScope().insertItem(std::unique_ptr<ItemType>(new ItemType(ident.getLiteral(), data)));
+        bindItem(nameId, item);
+        return std::make_pair(dynamic_cast<ItemType*>(item), true);
     } else {
         return std::make_pair(nullptr, false);
     }
 }
 
-template <typename ItemType>
-ItemType* SymbolTable::makeItem(typename ItemType::Data data) {
-    if (std::is_base_of<SymbolTableItem, ItemType>::value) {
-        auto num = std::to_string(m_tempItems.size() + 1);
-        SymbolTableItem* item = nullptr;
-        try {
-            item = new ItemType("@var" + num, data);
-        } catch (std::bad_alloc e) {
-            std::cout << e.what() << std::endl;
-        }
-        m_tempItems.push_back(item);
-        return dynamic_cast<ItemType*>(m_tempItems.back());
-    } else {
-        return nullptr;
-    }
-}
-#endif
\ No newline at end of file
+#endif
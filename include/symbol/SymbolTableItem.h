@@ -3,6 +3,7 @@
 #include "BlockScopeHandle.h"
 #include <vector>
 #include <memory>
+#include <string>
 #include <iostream>
 #include <algorithm>
 
@@ -64,7 +65,7 @@ public:
     explicit ConstVarItem(const std::string& name, typename Type::InternalType constVar) :
         TypedItem<Type>(name), m_constVar(constVar){};
     virtual ~ConstVarItem() {}
-    typename Type::InternalType getConstVar() const { return m_constVar; }
+    const typename Type::InternalType& getConstVar() const { return m_constVar; }
     virtual void dumpSymbolItem(std::ostream& os, bool hasType = true) override {
         if (hasType) {
             TypedItem<Type>::m_type.dumpType(os);
@@ -1,6 +1,8 @@
 #ifndef VALUE_TYPE_H
 #define VALUE_TYPE_H
 #include <Log.h>
+#include <algorithm>
+#include <vector>
 #include "SymbolTableItem.h"
 
 static const size_t INT_SIZE = 4;
@@ -18,7 +20,7 @@ public:
 class IntType : public ValueType {
 public:
     using InternalType = int;
-    using InternalItem = SymbolTableItem*;
+    using InternalItem = Value*;
     virtual size_t valueSize() const override { return INT_SIZE; }
     virtual ValueTypeEnum getValueTypeEnum() override {
         return ValueTypeEnum::INT_TYPE;
@@ -32,7 +34,7 @@ public:
 class CharType : public ValueType {
 public:
     using InternalType = char;
-    using InternalItem = SymbolTableItem*;
+    using InternalItem = Value*;
     virtual size_t valueSize() const override { return CHAR_SIZE; }
     virtual ValueTypeEnum getValueTypeEnum() override {
         return ValueTypeEnum::CHAR_TYPE;
@@ -46,7 +48,7 @@ public:
 class VoidType : public ValueType {
 public:
     using InternalType = void*;
-    using InternalItem = SymbolTableItem*;
+    using InternalItem = Value*;
     virtual size_t valueSize() const override { return VOID_SIZE; }
     virtual ValueTypeEnum getValueTypeEnum() override {
         return ValueTypeEnum::VOID_TYPE;
@@ -57,6 +59,26 @@ public:
     }
 };
 
+// 多维数组的下标, 只引用调用方的存储, 不足维数的部分视为0
+class IndexSpan {
+public:
+    IndexSpan(const size_t* data, size_t size) :
+        m_data(data), m_size(size) {}
+    IndexSpan(const std::vector<size_t>& pos) :
+        m_data(pos.data()), m_size(pos.size()) {}
+    template <size_t N>
+    IndexSpan(const size_t (&pos)[N]) :
+        m_data(pos), m_size(N) {}
+    size_t size() const { return m_size; }
+    size_t operator[](size_t i) const { return m_data[i]; }
+
+private:
+    const size_t* m_data;
+    size_t m_size;
+};
+
+// 按行展开的多维数组
+// 元素按段存储: 非零段的值连续放在m_values中, 零段只记录长度, 大片补零的初值不占用空间
 template <typename T>
 class MultiFlatArray {
 public:
@@ -65,37 +87,93 @@ public:
         std::vector<size_t> dimensions;
     };
     MultiFlatArray() = default;
-    MultiFlatArray(Data data) :
-        m_data(data) {
+    MultiFlatArray(Data data) {
+        for (auto& val : data.values) {
+            insert(val);
+        }
+        setDimensions(data.dimensions);
     }
     MultiFlatArray(T val, size_t n) {
-        m_data.values.assign(val, n);
+        if (val == T()) {
+            insertZeros(n);
+        } else {
+            m_values.assign(n, val);
+            m_runs.push_back({n, 0});
+            m_size = n;
+        }
     }
 
-    std::vector<T>& getValues() { return m_data.values; }
+    // 顺序遍历所有元素, 零段中的元素以T()返回
+    class ConstIterator {
+    public:
+        ConstIterator(const MultiFlatArray<T>* array, size_t index, size_t run) :
+            m_array(array), m_index(index), m_run(run) {}
+        T operator*() const {
+            auto& run = m_array->m_runs[m_run];
+            if (run.valueBegin == ZERO_RUN) {
+                return T();
+            }
+            return m_array->m_values[run.valueBegin + m_index - m_array->runBegin(m_run)];
+        }
+        ConstIterator& operator++() {
+            m_index++;
+            if (m_index == m_array->m_runs[m_run].end) {
+                m_run++;
+            }
+            return *this;
+        }
+        bool operator==(const ConstIterator& other) const { return m_index == other.m_index; }
+        bool operator!=(const ConstIterator& other) const { return m_index != other.m_index; }
+
+    private:
+        const MultiFlatArray<T>* m_array;
+        size_t m_index;
+        size_t m_run;
+    };
+    ConstIterator begin() const { return ConstIterator(this, 0, 0); }
+    ConstIterator end() const { return ConstIterator(this, m_size, m_runs.size()); }
+    size_t size() const { return m_size; }
+
+    // 展开成连续的数组, 仅在确实需要逐个元素的值时使用
+    std::vector<T> getValues() const {
+        std::vector<T> values;
+        values.reserve(m_size);
+        for (auto val : *this) {
+            values.push_back(val);
+        }
+        return values;
+    }
 
-    T& operator[](std::vector<size_t>&& pos) {
+    T operator[](IndexSpan pos) const {
         size_t index = 0;
-        int diff = m_data.dimensions.size() - pos.size();
-        for (int i = 0; i < diff; i++) {
-            pos.push_back(0);
+        size_t num = pos.size() < m_strides.size() ? pos.size() : m_strides.size();
+        for (size_t i = 0; i < num; i++) {
+            index += pos[i] * m_strides[i];
         }
-        for (int i = 0; i < m_data.dimensions.size(); i++) {
-            size_t term = 1;
-            for (int j = i + 1; j < m_data.dimensions.size(); j++) {
-                term *= m_data.dimensions[j];
-            }
-            index += pos[i] * term;
+        return at(index);
+    }
+
+    T at(size_t index) const {
+        if (index >= m_size) {
+            return T();
+        }
+        size_t run = 0;
+        if (m_runs.size() > 1) {
+            run = std::upper_bound(m_runs.begin(), m_runs.end(), index, [](size_t i, const Run& r) { return i < r.end; }) - m_runs.begin();
+        }
+        if (m_runs[run].valueBegin == ZERO_RUN) {
+            return T();
         }
-        return m_data.values[index];
+        return m_values[m_runs[run].valueBegin + index - runBegin(run)];
     }
 
     friend std::ostream& operator<<(std::ostream& os, const MultiFlatArray<T>& array) {
-        if (!array.m_data.values.empty()) {
+        if (array.m_size != 0) {
             os << "[";
-            for (auto val = array.m_data.values.begin(); val != array.m_data.values.end(); val++) {
-                os << "i" << sizeof(T) * 8 << " " << *val;
-                if (val != array.m_data.values.end() - 1) {
+            size_t i = 0;
+            for (auto val : array) {
+                os << "i" << sizeof(T) * 8 << " " << val;
+                if (++i != array.m_size) {
                     os << ", ";
                 }
             }
@@ -105,38 +183,94 @@ public:
     }
 
     void append(MultiFlatArray<T>&& appendance) {
-        m_data.values.insert(m_data.values.end(), appendance.m_data.values.begin(), appendance.m_data.values.end());
+        for (size_t i = 0; i < appendance.m_runs.size(); i++) {
+            auto& run = appendance.m_runs[i];
+            size_t len = run.end - appendance.runBegin(i);
+            if (run.valueBegin == ZERO_RUN) {
+                insertZeros(len);
+            } else {
+                auto first = appendance.m_values.begin() + run.valueBegin;
+                insertValues(first, first + len);
+            }
+        }
     }
 
     void insert(T val) {
-        m_data.values.push_back(val);
+        if (val == T()) {
+            insertZeros(1);
+        } else {
+            insertValues(&val, &val + 1);
+        }
     }
 
-    void setDimensions(std::vector<size_t>& dims) {
-        m_data.dimensions.assign(dims.begin(), dims.end());
+    void insertZeros(size_t n) {
+        if (n == 0) return;
+        if (m_runs.empty() || m_runs.back().valueBegin != ZERO_RUN) {
+            m_runs.push_back({m_size, ZERO_RUN});
+        }
+        m_size += n;
+        m_runs.back().end = m_size;
+    }
+
+    void setDimensions(const std::vector<size_t>& dims) {
+        m_dimensions.assign(dims.begin(), dims.end());
+        m_strides.resize(dims.size());
+        size_t stride = 1;
+        for (size_t i = dims.size(); i > 0; i--) {
+            m_strides[i - 1] = stride;
+            stride *= dims[i - 1];
+        }
     }
 
     const std::vector<size_t>& getDimensions() const {
-        return m_data.dimensions;
+        return m_dimensions;
     }
 
     size_t spaceSize(size_t unitSize) {
         size_t count = unitSize;
-        for (size_t dimension : m_data.dimensions) {
+        for (size_t dimension : m_dimensions) {
             count *= dimension;
         }
         return count;
     }
 
 private:
-    Data m_data;
+    template <typename Iter>
+    void insertValues(Iter first, Iter last) {
+        size_t n = last - first;
+        if (n == 0) return;
+        if (m_runs.empty() || m_runs.back().valueBegin == ZERO_RUN) {
+            m_runs.push_back({m_size, m_values.size()});
+        }
+        m_values.insert(m_values.end(), first, last);
+        m_size += n;
+        m_runs.back().end = m_size;
+    }
+    size_t runBegin(size_t run) const {
+        return run == 0 ? 0 : m_runs[run - 1].end;
+    }
+
+private:
+    static constexpr size_t ZERO_RUN = static_cast<size_t>(-1);
+    struct Run {
+        size_t end;        // 段结束处的下标(不含)
+        size_t valueBegin; // 段首元素在m_values中的位置, 零段为ZERO_RUN
+    };
+    std::vector<T> m_values;
+    std::vector<Run> m_runs;
+    std::vector<size_t> m_dimensions;
+    std::vector<size_t> m_strides; // 每一维下标对应的步长
+    size_t m_size{0};
 };
 
+template <typename T>
+constexpr size_t MultiFlatArray<T>::ZERO_RUN;
+
 template <typename Type>
 class ArrayType : public ValueType {
 public:
     using InternalType = MultiFlatArray<typename Type::InternalType>;
-    using InternalItem = MultiFlatArray<SymbolTableItem*>;
+    using InternalItem = MultiFlatArray<Value*>;
     virtual size_t valueSize() const override {
         return m_basicType.valueSize();
     }
@@ -0,0 +1,38 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// 字符串驻留池, 相同内容只保存一份, 返回的指针在池的生命周期内保持有效
+// 因此可以直接用指针比较/哈希代替字符串比较
+// 每个字符串还有一个从0开始的稠密id, 可以直接作为下标使用
+class StringPool {
+public:
+    static constexpr std::uint32_t NPOS = UINT32_MAX; // 无效的id
+
+    StringPool();
+    const std::string* intern(const char* str, std::size_t length) { return &m_strings[internId(str, length)]; }
+    const std::string* intern(const std::string& str) { return intern(str.data(), str.size()); }
+    std::uint32_t internId(const char* str, std::size_t length);
+    std::uint32_t internId(const std::string& str) { return internId(str.data(), str.size()); }
+    const std::string& getString(std::uint32_t id) const { return m_strings[id]; }
+    std::size_t size() const { return m_strings.size(); }
+
+private:
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+private:
+    static std::uint32_t hash(const char* str, std::size_t length);
+    void rehash();
+
+private:
+    static constexpr std::uint32_t EMPTY_SLOT = UINT32_MAX;
+    std::deque<std::string> m_strings;  // deque扩容不会移动已有元素
+    std::vector<std::uint32_t> m_slots; // 开放寻址(线性探测)哈希表, 存放字符串id
+};
+
+#endif
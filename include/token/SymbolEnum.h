@@ -3,7 +3,7 @@
 #include <vector>
 #include <string>
 #include <algorithm>
-#include <map>
+#include <cstring>
 enum class SymbolEnum : int {
     UNKNOWN = 0,
     IDENFR,  // 标识符
@@ -98,33 +98,6 @@ static const std::vector<std::string> s_symbolText{
     "PRINTFTK",
 };
 
-static const std::map<std::string, SymbolEnum> s_punctSymbolMap = {
-
-    {";", SymbolEnum::SEMICN},
-    {",", SymbolEnum::COMMA},
-    {"(", SymbolEnum::LPARENT},
-    {")", SymbolEnum::RPARENT},
-    {"[", SymbolEnum::LBRACK},
-    {"]", SymbolEnum::RBRACK},
-    {"{", SymbolEnum::LBRACE},
-    {"}", SymbolEnum::RBRACE},
-    {"+", SymbolEnum::PLUS},
-    {"-", SymbolEnum::MINU},
-    {"*", SymbolEnum::MULT},
-    {"/", SymbolEnum::DIV},
-    {"%", SymbolEnum::MOD},
-    {"=", SymbolEnum::ASSIGN},
-    {"<", SymbolEnum::LSS},
-    {">", SymbolEnum::GRE},
-    {"<=", SymbolEnum::LEQ},
-    {">=", SymbolEnum::GEQ},
-    {"==", SymbolEnum::EQL},
-    {"!=", SymbolEnum::NEQ},
-    {"!", SymbolEnum::NOT},
-    {"&&", SymbolEnum::AND},
-    {"||", SymbolEnum::OR},
-};
-
 static const std::string& getSymbolText(SymbolEnum symbol) {
     return s_symbolText[static_cast<std::underlying_type<SymbolEnum>::type>(symbol)];
 }
@@ -138,11 +111,117 @@ static const SymbolEnum getSymbolEnumByText(const std::string& text) {
     }
 }
 
-static const SymbolEnum getSymbolEnumByPunct(const std::string& punct) {
-    if (s_punctSymbolMap.count(punct)) {
-        return s_punctSymbolMap.at(punct);
-    } else {
-        return SymbolEnum::UNKNOWN;
+// 单字符分界符
+inline SymbolEnum getSymbolEnumByPunct(char c) {
+    switch (c) {
+    case ';': return SymbolEnum::SEMICN;
+    case ',': return SymbolEnum::COMMA;
+    case '(': return SymbolEnum::LPARENT;
+    case ')': return SymbolEnum::RPARENT;
+    case '[': return SymbolEnum::LBRACK;
+    case ']': return SymbolEnum::RBRACK;
+    case '{': return SymbolEnum::LBRACE;
+    case '}': return SymbolEnum::RBRACE;
+    case '+': return SymbolEnum::PLUS;
+    case '-': return SymbolEnum::MINU;
+    case '*': return SymbolEnum::MULT;
+    case '/': return SymbolEnum::DIV;
+    case '%': return SymbolEnum::MOD;
+    case '=': return SymbolEnum::ASSIGN;
+    case '<': return SymbolEnum::LSS;
+    case '>': return SymbolEnum::GRE;
+    case '!': return SymbolEnum::NOT;
+    default: return SymbolEnum::UNKNOWN;
+    }
+}
+
+// 双字符分界符, 不构成时返回UNKNOWN
+inline SymbolEnum getSymbolEnumByPunct(char first, char second) {
+    if (second == '=') {
+        switch (first) {
+        case '<': return SymbolEnum::LEQ;
+        case '>': return SymbolEnum::GEQ;
+        case '=': return SymbolEnum::EQL;
+        case '!': return SymbolEnum::NEQ;
+        default: return SymbolEnum::UNKNOWN;
+        }
+    }
+    if (first == second) {
+        return first == '&' ? SymbolEnum::AND : first == '|' ? SymbolEnum::OR : SymbolEnum::UNKNOWN;
+    }
+    return SymbolEnum::UNKNOWN;
+}
+
+// 保留字的完美哈希表, 用首尾字符散列到32个槽位, 槽位由下方static_assert在编译期校验
+struct KeywordEntry {
+    const char* text;
+    std::size_t length;
+    SymbolEnum symbol;
+};
+
+constexpr std::size_t keywordHash(const char* str, std::size_t length) {
+    return (static_cast<unsigned char>(str[0]) + static_cast<unsigned char>(str[length - 1]) * 15u) & 31u;
+}
+
+static constexpr KeywordEntry s_keywordTable[32] = {
+    {nullptr, 0, SymbolEnum::UNKNOWN},
+    {nullptr, 0, SymbolEnum::UNKNOWN},
+    {"while", 5, SymbolEnum::WHILETK},
+    {"if", 2, SymbolEnum::IFTK},
+    {"return", 6, SymbolEnum::RETURNTK},
+    {nullptr, 0, SymbolEnum::UNKNOWN},
+    {nullptr, 0, SymbolEnum::UNKNOWN},
+    {"break", 5, SymbolEnum::BREAKTK},
+    {nullptr, 0, SymbolEnum::UNKNOWN},
+    {nullptr, 0, SymbolEnum::UNKNOWN},
+    {"printf", 6, SymbolEnum::PRINTFTK},
+    {nullptr, 0, SymbolEnum::UNKNOWN},
+    {nullptr, 0, SymbolEnum::UNKNOWN},
+    {nullptr, 0, SymbolEnum::UNKNOWN},
+    {"continue", 8, SymbolEnum::CONTINUETK},
+    {"const", 5, SymbolEnum::CONSTTK},
+    {"else", 4, SymbolEnum::ELSETK},
+    {"char", 4, SymbolEnum::CHARTK},
+    {"void", 4, SymbolEnum::VOIDTK},
+    {"getint", 6, SymbolEnum::GETINTTK},
+    {"for", 3, SymbolEnum::FORTK},
+    {"int", 3, SymbolEnum::INTTK},
+    {nullptr, 0, SymbolEnum::UNKNOWN},
+    {nullptr, 0, SymbolEnum::UNKNOWN},
+    {nullptr, 0, SymbolEnum::UNKNOWN},
+    {nullptr, 0, SymbolEnum::UNKNOWN},
+    {nullptr, 0, SymbolEnum::UNKNOWN},
+    {nullptr, 0, SymbolEnum::UNKNOWN},
+    {nullptr, 0, SymbolEnum::UNKNOWN},
+    {nullptr, 0, SymbolEnum::UNKNOWN},
+    {nullptr, 0, SymbolEnum::UNKNOWN},
+    {"main", 4, SymbolEnum::MAINTK},
+};
+
+#define KEYWORD_SLOT_CHECK(word, sym) \
+    static_assert(s_keywordTable[keywordHash(word, sizeof(word) - 1)].symbol == SymbolEnum::sym, "keyword hash collision: " word);
+KEYWORD_SLOT_CHECK("const", CONSTTK)
+KEYWORD_SLOT_CHECK("main", MAINTK)
+KEYWORD_SLOT_CHECK("int", INTTK)
+KEYWORD_SLOT_CHECK("char", CHARTK)
+KEYWORD_SLOT_CHECK("void", VOIDTK)
+KEYWORD_SLOT_CHECK("return", RETURNTK)
+KEYWORD_SLOT_CHECK("if", IFTK)
+KEYWORD_SLOT_CHECK("else", ELSETK)
+KEYWORD_SLOT_CHECK("break", BREAKTK)
+KEYWORD_SLOT_CHECK("continue", CONTINUETK)
+KEYWORD_SLOT_CHECK("while", WHILETK)
+KEYWORD_SLOT_CHECK("for", FORTK)
+KEYWORD_SLOT_CHECK("getint", GETINTTK)
+KEYWORD_SLOT_CHECK("printf", PRINTFTK)
+#undef KEYWORD_SLOT_CHECK
+
+// 保留字返回对应的symbol, 否则是标识符
+inline SymbolEnum getReservedWordSymbol(const char* str, std::size_t length) {
+    const KeywordEntry& entry = s_keywordTable[keywordHash(str, length)];
+    if (entry.length == length && std::memcmp(entry.text, str, length) == 0) {
+        return entry.symbol;
     }
+    return SymbolEnum::IDENFR;
 }
-#endif
+#endif
\ No newline at end of file
@@ -0,0 +1,40 @@
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+#include "Tokenizer.h"
+
+// 按需从Tokenizer拉取token的流, 只在环形缓冲区中保留当前token和向前看的若干token
+class TokenStream {
+public:
+    explicit TokenStream(Tokenizer& tokenizer);
+
+    // offset为0时是当前(最近一次advance得到的)token, 1是下一个, 以此类推
+    // 位置0是一个哑元token, 超出末尾时返回UNKNOWN的空token
+    const Token& peek(int offset = 1);
+    void advance() { m_pos++; }
+    bool hasNext() { return fill(m_pos + 1); }
+
+    // 读入的每个token同时输出到buf中
+    void tee(std::streambuf* buf);
+    // 读完剩余的token
+    void drain();
+    StringPool& getStringPool() { return m_tokenizer.getStringPool(); }
+
+private:
+    TokenStream(const TokenStream&) = delete;
+    TokenStream& operator=(const TokenStream&) = delete;
+
+private:
+    bool fill(std::size_t pos);
+    void grow();
+
+private:
+    Tokenizer& m_tokenizer;
+    DumpWriter m_teeWriter;
+    std::vector<Token> m_ring;         // 容量是2的幂, 绝对位置i存放于m_ring[i & (size - 1)]
+    std::size_t m_head{0};             // 缓冲区中最早的token的绝对位置
+    std::size_t m_tail{1};             // 下一个读入的token的绝对位置
+    std::size_t m_pos{0};              // 当前token的绝对位置
+    bool m_exhausted{false};
+};
+
+#endif
@@ -1,40 +1,50 @@
 #ifndef TOKENIZER_H
 #define TOKENIZER_H
 #include <fstream>
+#include <iterator>
 #include <iostream>
 #include <vector>
 #include <set>
+#include <type_traits>
 
 #include "SymbolEnum.h"
+#include "StringPool.h"
+#include <DumpWriter.h>
 
 struct Token {
     SymbolEnum symbol;
-    std::string literal;
+    const std::string* literal; // 字面量驻留在StringPool中, Token本身可以按位拷贝
+    std::uint32_t literalId;    // 字面量在StringPool中的id, 符号表直接用它作为名字的键
     int value;
     int lineNum;
-    explicit Token(int line, SymbolEnum sym, const std::string& lit, int val) :
-        lineNum(line), symbol(sym), literal(lit), value(val) {}
+    explicit Token(int line, SymbolEnum sym, StringPool& pool, const std::string& lit, int val) :
+        lineNum(line), symbol(sym), literalId(pool.internId(lit)), value(val) {
+        literal = &pool.getString(literalId);
+    }
     Token() :
-        symbol(SymbolEnum::UNKNOWN), literal(""), value(0), lineNum(0){};
-    friend std::ostream& operator<<(std::ostream& os, const Token& token) {
+        symbol(SymbolEnum::UNKNOWN), literal(nullptr), literalId(StringPool::NPOS), value(0), lineNum(0){};
+    const std::string& getLiteral() const {
+        static const std::string empty;
+        return literal ? *literal : empty;
+    }
+    friend DumpWriter& operator<<(DumpWriter& os, const Token& token) {
         os << getSymbolText(token.symbol) << " ";
         if (token.symbol == SymbolEnum::INTCON) {
             os << token.value << "\n";
         } else {
-            os << token.literal << "\n";
+            os << token.getLiteral() << "\n";
         }
         return os;
     }
 };
+static_assert(std::is_trivially_copyable<Token>::value, "Token should be trivially copyable");
 
 class Tokenizer {
-public:
-    using TokenIter = std::vector<Token>::iterator;
-
 public:
     explicit Tokenizer(std::filebuf& fileBuf);
 
-    std::vector<Token>& tokenize();
+    bool next(Token& token);
+    StringPool& getStringPool() { return m_stringPool; }
 
 private:
     Tokenizer(const Tokenizer&) = delete;
@@ -43,8 +53,6 @@ private:
     Tokenizer& operator=(Tokenizer&&) = delete;
 
 private:
-    TokenIter makeToken(int lineNum, const SymbolEnum& symbolNum, const std::string& literal, int value = 0);
-    static SymbolEnum getReservedWordSymbol(std::string& word);
     bool skipVacant();
     SymbolEnum skipComment();
     SymbolEnum readIdent();
@@ -54,11 +62,14 @@ private:
     void checkFormatChar();
     void extractChar();
     void unextractChar();
+    bool reachEnd() const { return m_curr == m_end; }
 
 private:
-    std::istream m_istream;
-    std::vector<Token> m_tokenList;
-    TokenIter m_currToken{nullptr};
+    std::string m_source; // 一次性读入的源码缓冲区
+    const char* m_curr{nullptr};
+    const char* m_end{nullptr};
+    bool m_extractFail{false}; // 读到末尾后再读, 与istream的failbit语义一致
+    StringPool m_stringPool;
     char m_currChar;
     unsigned int m_currLine{1};
     SymbolEnum m_symbol{SymbolEnum::UNKNOWN};
@@ -1,4 +1,8 @@
 #include <Compiler.h>
+#include <ThreadPool.h>
+#include <fstream>
+#include <future>
+#include <sstream>
 
 bool Compiler::firstPass(std::filebuf& file) {
     std::filebuf token;
@@ -7,106 +11,234 @@ bool Compiler::firstPass(std::filebuf& file) {
     std::filebuf error;
     std::filebuf ir;
     std::filebuf mips;
+    Logger::Scope logScope(m_log);
     try {
         m_tokenizer = std::unique_ptr<Tokenizer>(new Tokenizer(file));
-        m_tokenList = m_tokenizer->tokenize();
-        if (s_dumpToken) {
+        m_tokenStream = std::unique_ptr<TokenStream>(new TokenStream(*m_tokenizer));
+        if (m_options.dumpToken) {
             dumpToken(token);
+        }
+        m_parser = std::unique_ptr<Parser>(new Parser(*m_tokenStream, m_astArena));
+        // 并行生成函数体(-jN)时函数体推迟到全部条目之后, 节点都要保留, 直接建整棵AST
+        if (m_options.dumpAST || m_options.jobs > 1) {
+            m_parser->parse();
+        } else {
+            // 串行且不输出AST时按顶层条目流式处理: 每解析完一个条目就遍历它生成IR, 之后复用它的节点的内存
+            // 条目仍完整建出子树再由Visitor遍历, 省下的只是同时保留整棵AST的内存
+            m_generator = std::unique_ptr<CodeGenerator>(new CodeGenerator(nullptr));
+            // 语义错误先缓存, 解析结束后再输出, 与先建完整AST再生成时的提示顺序相同
+            LogBuffer semanticLog;
+            try {
+                m_parser->parseItems([this, &semanticLog](VNodeBase* item) {
+                    Logger::Scope semanticScope(semanticLog.sink);
+                    m_generator->visitUnitItem(item);
+                });
+            } catch (...) {
+                // 编译中止时也要输出已经缓存的语义错误
+                Logger::append(semanticLog);
+                throw;
+            }
+            Logger::append(semanticLog);
+            m_generator->endCompUnit();
+        }
+        if (m_options.dumpToken) {
+            m_tokenStream->drain();
+            m_tokenStream->tee(nullptr);
             token.close();
         }
-        m_parser = std::unique_ptr<Parser>(new Parser(m_tokenList));
-        m_parser->parse();
-        if (s_dumpAST) {
+        if (m_options.dumpAST) {
             dumpAST(ast);
             ast.close();
         }
-
-        m_generator = std::unique_ptr<CodeGenerator>(new CodeGenerator(m_parser->getASTRoot()));
-        m_generator->generate(s_optLevel, s_dumpMips);
-        if (s_dumpIr) {
-            dumpIr(ir, s_isTest);
+        if (!m_generator) {
+            m_generator = std::unique_ptr<CodeGenerator>(new CodeGenerator(m_parser->getASTRoot(), m_options.jobs));
+        }
+        m_generator->generate(m_options.optLevel, m_options.dumpMips);
+        m_astArena.release(); // IR生成完毕后AST不再使用
+        if (m_options.dumpIr) {
+            dumpIr(ir, m_options.isTest);
             ir.close();
         }
-        if (s_dumpTable) {
+        if (m_options.dumpTable) {
             dumpTable(table);
             table.close();
         }
-        if (s_dumpError) {
+        if (m_options.dumpError) {
             dumpError(error);
             error.close();
         }
-        if (s_dumpMips) {
+        if (m_options.dumpMips) {
             dumpMips(mips);
             mips.close();
         }
     } catch (std::exception& e) {
-        std::cerr << e.what() << std::endl;
+        *m_err << e.what() << std::endl;
         return false;
     }
     return true;
 }
 
 void Compiler::dumpToken(std::filebuf& file) {
-    if (!file.open(s_dumpTokenPath, std::ios::out)) {
+    if (!file.open(m_options.dumpTokenPath, std::ios::out)) {
         throw std::runtime_error("Fail to open the dump token file!");
     }
-    std::ostream tos(&file);
-    for (auto& token : m_tokenList) {
-        tos << token;
-    }
+    // token在语法分析拉取时同步输出
+    m_tokenStream->tee(&file);
 }
 
 void Compiler::dumpAST(std::filebuf& file) {
-    if (!file.open(s_dumpASTPath, std::ios::out)) {
+    if (!file.open(m_options.dumpASTPath, std::ios::out)) {
         throw std::runtime_error("Fail to open the dump ast file!");
     }
     m_parser->traversalAST(file);
 }
 
 void Compiler::dumpTable(std::filebuf& file) {
-    if (!file.open(s_dumpTablePath, std::ios::out)) {
+    if (!file.open(m_options.dumpTablePath, std::ios::out)) {
         throw std::runtime_error("Fail to open the dump table file!");
     }
     m_generator->dumpTable(file);
 }
 
 void Compiler::dumpError(std::filebuf& file) {
-    if (!file.open(s_dumpErrorPath, std::ios::out)) {
+    if (!file.open(m_options.dumpErrorPath, std::ios::out)) {
         throw std::runtime_error("Fail to open the dump error file!");
     }
     std::ostream os(&file);
-    std::sort(Logger::s_errorDump.begin(), Logger::s_errorDump.end(), [](const ErrorLog& log1, const ErrorLog& log2) -> bool {
+    std::sort(m_log.errors.begin(), m_log.errors.end(), [](const ErrorLog& log1, const ErrorLog& log2) -> bool {
         return (log1.lineNum == log2.lineNum) ? (log1.code < log2.code) : (log1.lineNum < log2.lineNum);
     });
-    for (auto& log : Logger::s_errorDump) {
+    for (auto& log : m_log.errors) {
         os << log;
     }
 }
 
 void Compiler::dumpIr(std::filebuf& file, bool isTest) {
-    if (!file.open(s_dumpIrPath, std::ios::out)) {
+    if (!file.open(m_options.dumpIrPath, std::ios::out)) {
         throw std::runtime_error("Fail to open the ir file!");
     }
     m_generator->dumpIr(file, isTest);
 }
 
 void Compiler::dumpMips(std::filebuf& file) {
-    if (!file.open(s_dumpMipsPath, std::ios::out)) {
+    if (!file.open(m_options.dumpMipsPath, std::ios::out)) {
         throw std::runtime_error("Fail to open the mips file!");
     }
     m_generator->dumpMips(file);
 }
 
-int main(int argc, char** argv) {
-    Compiler compiler;
+// 去掉目录和扩展名的文件名
+static std::string fileStem(const std::string& path) {
+    auto begin = path.find_last_of("/\\");
+    begin = begin == std::string::npos ? 0 : begin + 1;
+    auto end = path.find_last_of('.');
+    if (end == std::string::npos || end < begin) {
+        end = path.size();
+    }
+    return path.substr(begin, end - begin);
+}
+
+// 列表文件每行一个源文件路径, 忽略空行和#开头的行
+static bool readBatchList(const std::string& listPath, std::vector<std::string>& sources) {
+    std::ifstream list(listPath);
+    if (!list) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(list, line)) {
+        auto end = line.find_last_not_of(" \t\r");
+        if (end == std::string::npos || line[0] == '#') {
+            continue;
+        }
+        sources.push_back(line.substr(0, end + 1));
+    }
+    return true;
+}
+
+// 打开源文件并编译, 打不开时不再编译, 批量编译和单个文件编译共用
+static bool compileFile(Compiler& compiler, const std::string& sourcePath, std::ostream& err) {
     std::filebuf in;
-    int ret = 0;
+    if (!in.open(sourcePath, std::ios::in)) {
+        err << "Fail to open the source file!" << std::endl;
+        return false;
+    }
+    return compiler.firstPass(in);
+}
+
+// 把缓存的输出逐行加上源文件路径前缀后写到os
+static void writeWithSource(std::ostream& os, const std::string& sourcePath, const std::string& text) {
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        os << sourcePath << ": " << line << "\n";
+    }
+    os.flush();
+}
+
+// 每个源文件一个任务, 各自用一个Compiler在线程池中编译
+// 开启的每种输出写到对应--dump-*目录下的<文件名去掉扩展名>.txt, 因此列表中的文件名不能重复
+// 各文件的提示和异常信息先缓存起来, 按列表顺序输出, 每行以源文件路径开头
+static int runBatch(const CompileOptions& options) {
+    std::vector<std::string> sources;
+    if (!readBatchList(options.batchListPath, sources)) {
+        std::cerr << "Fail to open the batch list file!" << std::endl;
+        return 1;
+    }
+    std::set<std::string> stems;
+    for (auto& source : sources) {
+        if (!stems.insert(fileStem(source)).second) {
+            std::cerr << "Duplicate file name in batch list: " << source << std::endl;
+            return 1;
+        }
+    }
 
-    parseArgs(argc, argv);
-    if (!in.open(s_sourcePath, std::ios::in)) {
-        std::cerr << "Fail to open the source file!" << std::endl;
-        ret = 1;
+    struct BatchResult {
+        std::ostringstream log;
+        std::ostringstream err;
+        bool success{false};
+    };
+    std::vector<std::unique_ptr<BatchResult>> results;
+    std::vector<std::future<void>> done;
+    ThreadPool pool(options.jobs);
+    for (auto& source : sources) {
+        results.emplace_back(new BatchResult);
+        auto result = results.back().get();
+        CompileOptions fileOptions = options;
+        auto stem = fileStem(source);
+        fileOptions.sourcePath = source;
+        fileOptions.jobs = 1; // 已经按文件并行, 单个文件内不再开线程
+        fileOptions.dumpTokenPath = options.dumpTokenPath + "/" + stem + ".txt";
+        fileOptions.dumpASTPath = options.dumpASTPath + "/" + stem + ".txt";
+        fileOptions.dumpTablePath = options.dumpTablePath + "/" + stem + ".txt";
+        fileOptions.dumpErrorPath = options.dumpErrorPath + "/" + stem + ".txt";
+        fileOptions.dumpIrPath = options.dumpIrPath + "/" + stem + ".txt";
+        fileOptions.dumpMipsPath = options.dumpMipsPath + "/" + stem + ".txt";
+        auto task = std::make_shared<std::packaged_task<void()>>([fileOptions, result]() {
+            Compiler compiler(fileOptions);
+            compiler.setOutput(&result->log, &result->err);
+            result->success = compileFile(compiler, fileOptions.sourcePath, result->err);
+        });
+        done.push_back(task->get_future());
+        pool.submit([task]() { (*task)(); });
+    }
+
+    int ret = 0;
+    for (std::size_t i = 0; i < sources.size(); i++) {
+        done[i].wait();
+        writeWithSource(std::cout, sources[i], results[i]->log.str());
+        writeWithSource(std::cerr, sources[i], results[i]->err.str());
+        ret = results[i]->success ? ret : 1;
     }
-    ret = compiler.firstPass(in) ? ret : 1;
     return ret;
 }
+
+int main(int argc, char** argv) {
+    CompileOptions options;
+
+    parseArgs(argc, argv, options);
+    if (options.batch) {
+        return runBatch(options);
+    }
+    Compiler compiler(options);
+    return compileFile(compiler, options.sourcePath, std::cerr) ? 0 : 1;
+}
@@ -0,0 +1,53 @@
+#include <DumpWriter.h>
+
+constexpr std::size_t DumpWriter::BUFFER_SIZE;
+
+DumpWriter::DumpWriter(std::streambuf* sink) :
+    m_sink(nullptr), m_buffer(new char[BUFFER_SIZE]), m_stream(this) {
+    setp(m_buffer.get(), m_buffer.get() + BUFFER_SIZE);
+    open(sink);
+}
+
+DumpWriter::~DumpWriter() {
+    flush();
+}
+
+void DumpWriter::open(std::streambuf* sink) {
+    flush();
+    m_sink = sink;
+}
+
+void DumpWriter::flush() {
+    auto len = pptr() - pbase();
+    if (m_sink && len) {
+        m_sink->sputn(pbase(), len);
+    }
+    setp(m_buffer.get(), m_buffer.get() + BUFFER_SIZE);
+}
+
+void DumpWriter::writeSlow(const char* str, std::size_t len) {
+    flush();
+    if (len >= BUFFER_SIZE) {
+        // 超过缓冲区的大块直接写入sink
+        if (m_sink) {
+            m_sink->sputn(str, len);
+        }
+        return;
+    }
+    std::memcpy(pptr(), str, len);
+    pbump(static_cast<int>(len));
+}
+
+DumpWriter::int_type DumpWriter::overflow(int_type ch) {
+    flush();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+int DumpWriter::sync() {
+    flush();
+    return 0;
+}
@@ -18,25 +18,41 @@
 #define BOLDCYAN "\033[1m\033[36m"    /* Bold Cyan */
 #define BOLDWHITE "\033[1m\033[37m"   /* Bold White */
 
-std::vector<ErrorLog> Logger::s_errorDump;
+thread_local LogSink* Logger::s_current = nullptr;
+
+LogSink& Logger::current() {
+    if (s_current) {
+        return *s_current;
+    }
+    static thread_local LogSink defaultSink;
+    return defaultSink;
+}
+
 void Logger::logError(ErrorType error, int lineNum, const std::string& meta, const std::string& target) {
-    std::cout << BOLDRED << "[error]" << RESET
-              << " line:" << lineNum << " " << genErrorText(error, meta, target) << std::endl;
-    s_errorDump.emplace_back(lineNum, static_cast<std::underlying_type<ErrorType>::type>(error));
+    auto& sink = current();
+    *sink.stream << BOLDRED << "[error]" << RESET
+                 << " line:" << lineNum << " " << genErrorText(error, meta, target) << std::endl;
+    sink.errors.emplace_back(lineNum, static_cast<std::underlying_type<ErrorType>::type>(error));
 }
 
 void Logger::logError(const std::string& error) {
-    std::cout << BOLDRED << "[error]" << RESET << " " << error << std::endl;
+    *current().stream << BOLDRED << "[error]" << RESET << " " << error << std::endl;
 }
 
 void Logger::logWarning(const std::string& warning) {
-    std::cout << BOLDYELLOW << "[warning]" << RESET << " " << warning << std::endl;
+    *current().stream << BOLDYELLOW << "[warning]" << RESET << " " << warning << std::endl;
 }
 
 void Logger::logInfo(const std::string& info) {
-    std::cout << BOLDBLUE << "[info]" << RESET << " " << info << std::endl;
+    *current().stream << BOLDBLUE << "[info]" << RESET << " " << info << std::endl;
 }
 
 void Logger::logDebug(const std::string& message) {
-    std::cout << BOLDGREEN << "[debug]" << RESET << " " << message << std::endl;
+    *current().stream << BOLDGREEN << "[debug]" << RESET << " " << message << std::endl;
+}
+
+void Logger::append(const LogBuffer& buffer) {
+    auto& sink = current();
+    *sink.stream << buffer.text.str();
+    sink.errors.insert(sink.errors.end(), buffer.sink.errors.begin(), buffer.sink.errors.end());
 }
@@ -0,0 +1,55 @@
+#include <SlabArena.h>
+#include <new>
+
+constexpr std::size_t SlabArena::ALIGN;
+constexpr std::size_t SlabArena::HEADER_SIZE;
+constexpr std::size_t SlabArena::MAX_CLASS;
+constexpr std::size_t SlabArena::CHUNK_SIZE;
+thread_local SlabArena* SlabArena::s_current = nullptr;
+
+SlabArena::~SlabArena() {
+    for (auto chunk : m_chunks) {
+        ::operator delete(chunk);
+    }
+}
+
+void* SlabArena::allocate(std::size_t size) {
+    auto sizeClass = sizeClassOf(size);
+    SlabArena* arena = sizeClass <= MAX_CLASS ? s_current : nullptr;
+    char* slot = arena ? static_cast<char*>(arena->allocateSlot(sizeClass)) : static_cast<char*>(::operator new(size + HEADER_SIZE));
+    *reinterpret_cast<SlabArena**>(slot) = arena;
+    return slot + HEADER_SIZE;
+}
+
+void SlabArena::deallocate(void* ptr, std::size_t size) {
+    if (!ptr) return;
+    char* slot = static_cast<char*>(ptr) - HEADER_SIZE;
+    SlabArena* arena = *reinterpret_cast<SlabArena**>(slot);
+    if (arena) {
+        arena->freeSlot(slot, sizeClassOf(size));
+    } else {
+        ::operator delete(slot);
+    }
+}
+
+void* SlabArena::allocateSlot(std::size_t sizeClass) {
+    if (auto node = m_freeLists[sizeClass]) {
+        m_freeLists[sizeClass] = node->next;
+        return node;
+    }
+    std::size_t bytes = sizeClass * ALIGN;
+    if (m_curr == nullptr || m_curr + bytes > m_end) {
+        m_curr = static_cast<char*>(::operator new(CHUNK_SIZE));
+        m_end = m_curr + CHUNK_SIZE;
+        m_chunks.push_back(m_curr);
+    }
+    void* slot = m_curr;
+    m_curr += bytes;
+    return slot;
+}
+
+void SlabArena::freeSlot(void* slot, std::size_t sizeClass) {
+    auto node = static_cast<FreeNode*>(slot);
+    node->next = m_freeLists[sizeClass];
+    m_freeLists[sizeClass] = node;
+}
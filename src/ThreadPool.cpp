@@ -0,0 +1,131 @@
+#include <ThreadPool.h>
+#include <exception>
+
+thread_local ThreadPool* ThreadPool::s_owner = nullptr;
+thread_local std::size_t ThreadPool::s_index = 0;
+
+ThreadPool::ThreadPool(std::size_t threadNum) {
+    if (threadNum == 0) {
+        threadNum = 1;
+    }
+    m_queues.reserve(threadNum);
+    for (std::size_t i = 0; i < threadNum; i++) {
+        m_queues.emplace_back(new WorkQueue());
+    }
+    m_workers.reserve(threadNum);
+    for (std::size_t i = 0; i < threadNum; i++) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_taskReady.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    std::size_t index;
+    if (s_owner == this) {
+        index = s_index;
+    } else {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        index = m_nextQueue;
+        m_nextQueue = (m_nextQueue + 1) % m_queues.size();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+        m_queues[index]->tasks.push_back(std::move(task));
+    }
+    // 任务先入队再计数, 认领了计数的工作线程一定能在某个队列里找到任务
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending++;
+        m_unfinished++;
+    }
+    m_taskReady.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_allDone.wait(lock, [this] { return m_unfinished == 0; });
+}
+
+std::size_t ThreadPool::defaultThreadNum() {
+    auto num = std::thread::hardware_concurrency();
+    return num ? num : 1;
+}
+
+void ThreadPool::takeTask(std::size_t index, std::function<void()>& task) {
+    std::size_t n = m_queues.size();
+    while (true) {
+        for (std::size_t i = 0; i < n; i++) {
+            auto& queue = *m_queues[(index + i) % n];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) {
+                continue;
+            }
+            if (i == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            return;
+        }
+    }
+}
+
+void ThreadPool::workerLoop(std::size_t index) {
+    s_owner = this;
+    s_index = index;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_taskReady.wait(lock, [this] { return m_stop || m_pending > 0; });
+            if (m_pending == 0) {
+                return;
+            }
+            m_pending--;
+        }
+        std::function<void()> task;
+        takeTask(index, task);
+        task();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_unfinished == 0) {
+            m_allDone.notify_all();
+        }
+    }
+}
+
+void parallelFor(ThreadPool* pool, std::size_t n, const std::function<void(std::size_t)>& body) {
+    if (!pool || n <= 1) {
+        for (std::size_t i = 0; i < n; i++) {
+            body(i);
+        }
+        return;
+    }
+    std::vector<std::exception_ptr> errors(n);
+    for (std::size_t i = 0; i < n; i++) {
+        pool->submit([&body, &errors, i] {
+            try {
+                body(i);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    pool->wait();
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
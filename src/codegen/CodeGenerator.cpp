@@ -1,7 +1,19 @@
 #include <codegen/CodeGenerator.h>
 
-CodeGenerator::CodeGenerator(std::shared_ptr<VNodeBase> astRoot) {
-    m_visitor = std::unique_ptr<Visitor>(new Visitor(std::move(astRoot), m_table, m_irCtx));
+CodeGenerator::CodeGenerator(VNodeBase* astRoot, std::size_t jobs) {
+    // 函数体的IR生成、优化和生成MIPS都按函数并行, 输出与串行时相同
+    if (jobs > 1) {
+        m_pool.reset(new ThreadPool(jobs));
+    }
+    m_visitor = std::unique_ptr<Visitor>(new Visitor(astRoot, m_table, m_irCtx, m_pool.get()));
+}
+
+void CodeGenerator::visitUnitItem(VNodeBase* item) {
+    m_visitor->visitUnitItem(item);
+}
+
+void CodeGenerator::endCompUnit() {
+    m_visitor->endCompUnit();
 }
 
 void CodeGenerator::generate(int optLevel, bool genMips) {
@@ -9,13 +21,13 @@ void CodeGenerator::generate(int optLevel, bool genMips) {
     m_irCtx.module.calPredSucc();
     m_irCtx.module.addImplicitReturn();
     if (optLevel) {
-        m_irCtx.module.optimizeIrCode(optLevel);
+        m_irCtx.module.optimizeIrCode(optLevel, m_irCtx.irPasses, m_pool.get());
     }
     // Logger::logInfo("optLevel=" + std::to_string(optLevel) + "\n");
     if (genMips) {
-        m_mipsCtx.convertMipsCode(m_irCtx.module);
+        m_mipsCtx.convertMipsCode(m_irCtx.module, m_pool.get());
         if (optLevel) {
-            m_mipsCtx.optimizeMipsCode(optLevel);
+            m_mipsCtx.optimizeMipsCode(optLevel, m_pool.get());
         }
     }
 }
@@ -26,11 +38,11 @@ void CodeGenerator::dumpTable(std::filebuf& file) {
 }
 
 void CodeGenerator::dumpIr(std::filebuf& file, bool isTest) {
-    std::ostream os(&file);
+    DumpWriter os(&file);
     m_irCtx.module.toCode(os, isTest);
 }
 
 void CodeGenerator::dumpMips(std::filebuf& file) {
-    std::ostream os(&file);
+    DumpWriter os(&file);
     m_mipsCtx.m_module.toCode(os);
 }
\ No newline at end of file
@@ -1,9 +1,10 @@
 #include <codegen/Visitor.h>
 #include <Utils.h>
+#include <ThreadPool.h>
 
 #ifndef NDEBUG
-#define DBG_PROBE_BRANCH(name) auto name = (*node->getChildIter())->getNodeEnum()
-#define DBG_PROBE_LEAF(name) auto name = (*node->getChildIter())->getSymbol()
+#define DBG_PROBE_BRANCH(name) auto name = cursor.get()->getNodeEnum()
+#define DBG_PROBE_LEAF(name) auto name = cursor.get()->getSymbol()
 #define DBG_PROBE_VAL(val, expr) auto val = expr
 #else
 #define DBG_PROBE_BRANCH(name, node)
@@ -11,16 +12,16 @@
 #define DBG_PROBE_VAL(val, expr)
 #endif
 
-Visitor::Visitor(std::shared_ptr<VNodeBase> astRoot, SymbolTable& table, IrContext& ctx) :
-    m_astRoot(astRoot), m_table(table), m_ctx(ctx) {}
+Visitor::Visitor(VNodeBase* astRoot, SymbolTable& table, IrContext& ctx, ThreadPool* pool) :
+    m_astRoot(astRoot), m_table(table), m_ctx(ctx), m_pool(pool) {}
 
 void Visitor::visit() {
-    if (m_astRoot->getType() == VType::VN) {
+    if (m_astRoot && m_astRoot->getType() == VType::VN) {
         compUnit(m_astRoot);
     }
 }
 
-bool Visitor::expect(std::shared_ptr<VNodeBase> node, VNodeEnum nodeEnum) {
+bool Visitor::expect(VNodeBase* node, VNodeEnum nodeEnum) {
     if (node->getType() == VType::VN) {
         return node->getNodeEnum() == nodeEnum;
     } else {
@@ -28,7 +29,7 @@ bool Visitor::expect(std::shared_ptr<VNodeBase> node, VNodeEnum nodeEnum) {
     }
 }
 
-bool Visitor::expect(std::shared_ptr<VNodeBase> node, SymbolEnum symbolEnum) {
+bool Visitor::expect(VNodeBase* node, SymbolEnum symbolEnum) {
     if (node->getType() == VType::VT) {
         return node->getSymbol() == symbolEnum;
     } else {
@@ -36,179 +37,227 @@ bool Visitor::expect(std::shared_ptr<VNodeBase> node, SymbolEnum symbolEnum) {
     }
 }
 
-void Visitor::compUnit(std::shared_ptr<VNodeBase> node) {
-    while (expect(*node->getChildIter(), VNodeEnum::DECL)) {
-        decl(*node->getChildIter());
-        if (!node->nextChild()) break;
+void Visitor::compUnit(VNodeBase* node) {
+    VNodeCursor cursor(node);
+    do {
+        visitUnitItem(cursor.get());
+    } while (cursor.next(1, false));
+    endCompUnit();
+}
+
+bool Visitor::visitUnitItem(VNodeBase* node) {
+    if (!m_pool) {
+        return unitItem(node);
     }
-    while (expect(*node->getChildIter(), VNodeEnum::FUNCDEF)) {
-        funcDef(*node->getChildIter());
-        if (!node->nextChild()) break;
+    // 上一段之后又推迟了一个函数体, 开始新的一段
+    if (m_itemLogs.size() == m_funcVisitors.size()) {
+        m_itemLogs.emplace_back(new LogBuffer);
     }
-    if (expect(*node->getChildIter(), VNodeEnum::MAINFUNCDEF)) {
-        mainFuncDef(*node->getChildIter());
+    Logger::Scope logScope(m_itemLogs.back()->sink);
+    return unitItem(node);
+}
+
+bool Visitor::unitItem(VNodeBase* node) {
+    // 流式解析时不同条目的节点可能复用同一块内存, 缓存只在一个条目内有效
+    m_constCache[0].clear();
+    m_constCache[1].clear();
+    if (expect(node, VNodeEnum::DECL)) {
+        decl(node);
+    } else if (expect(node, VNodeEnum::FUNCDEF)) {
+        return funcDef(node);
+    } else if (expect(node, VNodeEnum::MAINFUNCDEF)) {
+        return mainFuncDef(node);
     }
+    return false;
+}
 
+void Visitor::endCompUnit() {
+    // 全局声明和全部函数的签名都已登记, 各函数体互不依赖, 并行生成后按函数的顺序合并日志和字符串
+    // 日志与逐个生成时的顺序相同
+    std::vector<LogBuffer> logs(m_funcVisitors.size());
+    parallelFor(m_pool, m_funcVisitors.size(), [this, &logs](std::size_t i) {
+        Logger::Scope logScope(logs[i].sink);
+        m_funcVisitors[i]->funcBody();
+    });
+    for (std::size_t i = 0; i < m_itemLogs.size(); i++) {
+        Logger::append(*m_itemLogs[i]);
+        if (i < m_funcVisitors.size()) {
+            Logger::append(logs[i]);
+            finishFunc(*m_funcVisitors[i]);
+        }
+    }
+    m_funcVisitors.clear();
+    m_itemLogs.clear();
     m_table.popScope();
 }
 
-void Visitor::decl(std::shared_ptr<VNodeBase> node) {
-    if (expect(*node->getChildIter(), VNodeEnum::CONSTDECL)) {
-        constDecl(*node->getChildIter());
+void Visitor::decl(VNodeBase* node) {
+    if (expect(node->getChild(0), VNodeEnum::CONSTDECL)) {
+        constDecl(node->getChild(0));
     } else {
-        varDecl(*node->getChildIter());
+        varDecl(node->getChild(0));
     }
 }
 
-void Visitor::constDecl(std::shared_ptr<VNodeBase> node) {
-    node->nextChild(); // jump 'const'
-    if (bType(*node->getChildIter()) == ValueTypeEnum::INT_TYPE) {
-        node->nextChild(); // jump 'int'
-        constDef<IntType>(*node->getChildIter());
-        node->nextChild(); // jump <ConstDef>
-        while (expect(*node->getChildIter(), SymbolEnum::COMMA)) {
-            node->nextChild(); // jump ','
-            constDef<IntType>(*node->getChildIter());
-            if (!node->nextChild()) break; // jump <ConstDef>
+void Visitor::constDecl(VNodeBase* node) {
+    VNodeCursor cursor(node);
+    cursor.next(); // jump 'const'
+    if (bType(cursor.get()) == ValueTypeEnum::INT_TYPE) {
+        cursor.next(); // jump 'int'
+        constDef<IntType>(cursor.get());
+        cursor.next(); // jump <ConstDef>
+        while (expect(cursor.get(), SymbolEnum::COMMA)) {
+            cursor.next(); // jump ','
+            constDef<IntType>(cursor.get());
+            if (!cursor.next()) break; // jump <ConstDef>
         }
-    } else if (bType(*node->getChildIter()) == ValueTypeEnum::CHAR_TYPE) {
-        node->nextChild(); // jump 'int'
-        constDef<CharType>(*node->getChildIter());
-        node->nextChild(); // jump <ConstDef>
-        while (expect(*node->getChildIter(), SymbolEnum::COMMA)) {
-            node->nextChild(); // jump ','
-            constDef<CharType>(*node->getChildIter());
-            if (!node->nextChild()) break; // jump <ConstDef>
+    } else if (bType(cursor.get()) == ValueTypeEnum::CHAR_TYPE) {
+        cursor.next(); // jump 'int'
+        constDef<CharType>(cursor.get());
+        cursor.next(); // jump <ConstDef>
+        while (expect(cursor.get(), SymbolEnum::COMMA)) {
+            cursor.next(); // jump ','
+            constDef<CharType>(cursor.get());
+            if (!cursor.next()) break; // jump <ConstDef>
         }
     }
 }
 
-void Visitor::varDecl(std::shared_ptr<VNodeBase> node) {
-    if (bType(*node->getChildIter()) == ValueTypeEnum::INT_TYPE) {
-        node->nextChild(); // jump 'int'
-        varDef<IntType>(*node->getChildIter());
-        node->nextChild(1, false); // jump <VarDef>
-        while (expect(*node->getChildIter(), SymbolEnum::COMMA)) {
-            node->nextChild(); // jump ','
-            varDef<IntType>(*node->getChildIter());
-            if (!node->nextChild()) break; // jump <VarDef>
+void Visitor::varDecl(VNodeBase* node) {
+    VNodeCursor cursor(node);
+    if (bType(cursor.get()) == ValueTypeEnum::INT_TYPE) {
+        cursor.next(); // jump 'int'
+        varDef<IntType>(cursor.get());
+        cursor.next(1, false); // jump <VarDef>
+        while (expect(cursor.get(), SymbolEnum::COMMA)) {
+            cursor.next(); // jump ','
+            varDef<IntType>(cursor.get());
+            if (!cursor.next()) break; // jump <VarDef>
         }
-    } else if (bType(*node->getChildIter()) == ValueTypeEnum::CHAR_TYPE) {
-        node->nextChild(); // jump 'int'
-        varDef<CharType>(*node->getChildIter());
-        node->nextChild(); // jump <VarDef>
-        while (expect(*node->getChildIter(), SymbolEnum::COMMA)) {
-            node->nextChild(); // jump ','
-            varDef<CharType>(*node->getChildIter());
-            if (!node->nextChild()) break; // jump <VarDef>
+    } else if (bType(cursor.get()) == ValueTypeEnum::CHAR_TYPE) {
+        cursor.next(); // jump 'int'
+        varDef<CharType>(cursor.get());
+        cursor.next(); // jump <VarDef>
+        while (expect(cursor.get(), SymbolEnum::COMMA)) {
+            cursor.next(); // jump ','
+            varDef<CharType>(cursor.get());
+            if (!cursor.next()) break; // jump <VarDef>
         }
     }
 }
 
 template <typename Type>
-typename Type::InternalType Visitor::constExp(std::shared_ptr<VNodeBase> node) {
-    return calConstExp<Type>(*node->getChildIter()).first;
+typename Type::InternalType Visitor::constExp(VNodeBase* node) {
+    auto res = calConstExp<Type>(node->getChild(0));
+    if (!res.second) {
+        undeclIdents(node); // 常量表达式不经过rVal, 在这里报告其中未定义的名字
+    }
+    return res.first;
+}
+
+void Visitor::undeclIdents(VNodeBase* node) {
+    if (node->getType() == VType::VT) return;
+    if (expect(node, VNodeEnum::LVAL)) {
+        auto leafNode = dynamic_cast<VNodeLeaf*>(node->getChild(0));
+        if (!m_table.findItem(leafNode->getToken())) {
+            Logger::logError(ErrorType::UNDECL_IDENT, leafNode->getToken().lineNum, leafNode->getToken().getLiteral());
+        }
+    }
+    for (auto& child : node->getChildren()) {
+        undeclIdents(child);
+    }
 }
 template <typename Type>
-SymbolTableItem* Visitor::exp(std::shared_ptr<VNodeBase> node) {
-    return addExp<Type>(*node->getChildIter());
+ExpValue Visitor::exp(VNodeBase* node) {
+    return addExp<Type>(node->getChild(0));
 }
 
 template <typename Type>
-SymbolTableItem* Visitor::addExp(std::shared_ptr<VNodeBase> node) {
+ExpValue Visitor::addExp(VNodeBase* node) {
+    VNodeCursor cursor(node);
     auto res = calConstExp<Type>(node);
     if (res.second) {
-        auto item = m_table.makeItem<ConstVarItem<Type>>(res.first);
-        item->setIrValue(ConstValue::get(res.first));
-        return item;
+        return makeConstValue<Type>(res.first);
     } else {
-        if (expect(*node->getChildIter(), VNodeEnum::MULEXP)) {
-            return mulExp<Type>(*node->getChildIter());
+        if (expect(cursor.get(), VNodeEnum::MULEXP)) {
+            return mulExp<Type>(cursor.get());
         } else {
-            auto add = addExp<Type>(*node->getChildIter());
-            node->nextChild();
-            SymbolEnum op = (*node->getChildIter())->getSymbol(); // get symbol of plus or minus
-            node->nextChild();
-            auto mul = mulExp<Type>(*node->getChildIter());
-            auto ret = MAKE_VAR();
+            auto add = addExp<Type>(cursor.get());
+            cursor.next();
+            SymbolEnum op = cursor.get()->getSymbol(); // get symbol of plus or minus
+            cursor.next();
+            auto mul = mulExp<Type>(cursor.get());
             /*---------------------------------codegen------------------------------------*/
             Value* inst = nullptr;
             if (op == SymbolEnum::PLUS) {
-                inst = m_ctx.basicBlock->pushBackInst(new BinaryInst(IRType::Add, add->getIrValue(), mul->getIrValue()));
+                inst = m_builder.basicBlock->pushBackInst(new BinaryInst(IRType::Add, add.value, mul.value));
             } else if (op == SymbolEnum::MINU) {
-                inst = m_ctx.basicBlock->pushBackInst(new BinaryInst(IRType::Sub, add->getIrValue(), mul->getIrValue()));
+                inst = m_builder.basicBlock->pushBackInst(new BinaryInst(IRType::Sub, add.value, mul.value));
             } else {
                 DBG_ERROR("Add expression only accept '+' & '-'");
-                return nullptr;
+                return {};
             }
-            ret->setIrValue(inst);
             /*----------------------------------------------------------------------------*/
-            return ret;
+            return makeVarValue<Type>(inst);
         }
     }
 }
 
 template <typename Type>
-SymbolTableItem* Visitor::mulExp(std::shared_ptr<VNodeBase> node) {
+ExpValue Visitor::mulExp(VNodeBase* node) {
+    VNodeCursor cursor(node);
     auto res = calConstExp<Type>(node);
     if (res.second) {
-        auto item = m_table.makeItem<ConstVarItem<Type>>(res.first);
-        item->setIrValue(ConstValue::get(res.first));
-        return item;
+        return makeConstValue<Type>(res.first);
     } else {
-        node->resetIter();
-        if (expect(*node->getChildIter(), VNodeEnum::UNARYEXP)) {
-            return unaryExp<Type>(*node->getChildIter());
+        if (expect(cursor.get(), VNodeEnum::UNARYEXP)) {
+            return unaryExp<Type>(cursor.get());
         } else {
-            auto mul = mulExp<Type>(*node->getChildIter());
-            node->nextChild();
-            SymbolEnum op = (*node->getChildIter())->getSymbol(); // get symbol of plus or minus
-            node->nextChild();
-            auto unary = unaryExp<Type>(*node->getChildIter());
-            auto ret = MAKE_VAR();
+            auto mul = mulExp<Type>(cursor.get());
+            cursor.next();
+            SymbolEnum op = cursor.get()->getSymbol(); // get symbol of plus or minus
+            cursor.next();
+            auto unary = unaryExp<Type>(cursor.get());
             /*---------------------------------codegen------------------------------------*/
             Value* inst = nullptr;
             if (op == SymbolEnum::MULT) {
-                inst = m_ctx.basicBlock->pushBackInst(new BinaryInst(IRType::Mul, mul->getIrValue(), unary->getIrValue()));
+                inst = m_builder.basicBlock->pushBackInst(new BinaryInst(IRType::Mul, mul.value, unary.value));
             } else if (op == SymbolEnum::DIV) {
-                inst = m_ctx.basicBlock->pushBackInst(new BinaryInst(IRType::Div, mul->getIrValue(), unary->getIrValue()));
+                inst = m_builder.basicBlock->pushBackInst(new BinaryInst(IRType::Div, mul.value, unary.value));
             } else if (op == SymbolEnum::MOD) {
-                inst = m_ctx.basicBlock->pushBackInst(new BinaryInst(IRType::Mod, mul->getIrValue(), unary->getIrValue()));
+                inst = m_builder.basicBlock->pushBackInst(new BinaryInst(IRType::Mod, mul.value, unary.value));
             } else {
                 DBG_ERROR("Mul expression only accept '*' & '/' & '%'!");
-                return nullptr;
+                return {};
             }
-            ret->setIrValue(inst);
             /*----------------------------------------------------------------------------*/
-            return ret;
+            return makeVarValue<Type>(inst);
         }
     }
 }
 
 template <typename Type>
-SymbolTableItem* Visitor::unaryExp(std::shared_ptr<VNodeBase> node) {
+ExpValue Visitor::unaryExp(VNodeBase* node) {
+    VNodeCursor cursor(node);
     auto res = calConstExp<Type>(node);
     if (res.second) {
-        auto item = m_table.makeItem<ConstVarItem<Type>>(res.first);
-        item->setIrValue(ConstValue::get(res.first));
-        return item;
+        return makeConstValue<Type>(res.first);
     } else {
-        node->resetIter();
-        if (expect(*node->getChildIter(), VNodeEnum::PRIMARYEXP)) {
-            return primaryExp<Type>(*node->getChildIter());
-        } else if (expect(*node->getChildIter(), SymbolEnum::IDENFR)) {
-            auto leafNode = std::dynamic_pointer_cast<VNodeLeaf>(*node->getChildIter());
-            std::string identName = leafNode->getToken().literal;
+        if (expect(cursor.get(), VNodeEnum::PRIMARYEXP)) {
+            return primaryExp<Type>(cursor.get());
+        } else if (expect(cursor.get(), SymbolEnum::IDENFR)) {
+            auto leafNode = dynamic_cast<VNodeLeaf*>(cursor.get());
+            const std::string& identName = leafNode->getToken().getLiteral();
             int lineNum = leafNode->getToken().lineNum;
-            node->nextChild(2); // jump IDENT & '('
-            std::vector<SymbolTableItem*> realParams;
-            FuncItem* func = m_table.findFunc(identName);
+            cursor.next(2); // jump IDENT & '('
+            std::vector<Value*> args;
+            FuncItem* func = m_table.findFunc(leafNode->getToken());
             if (!func) {
                 Logger::logError(ErrorType::UNDECL_IDENT, lineNum, identName);
-                return nullptr;
+                return {};
             } else {
-                if (expect(*node->getChildIter(), VNodeEnum::FUNCRPARAMS)) {
-                    realParams = funcRParams(*node->getChildIter(), func, lineNum); // 传入func
+                if (expect(cursor.get(), VNodeEnum::FUNCRPARAMS)) {
+                    args = funcRParams(cursor.get(), func, lineNum); // 传入func
                 } else {
                     auto expectParams = func->getParams().size();
                     if (expectParams != 0) {
@@ -217,59 +266,47 @@ SymbolTableItem* Visitor::unaryExp(std::shared_ptr<VNodeBase> node) {
                 }
             }
 
-            SymbolTableItem* ret = nullptr;
-            if (func->getReturnValueType() == ValueTypeEnum::INT_TYPE) {
-                ret = MAKE_INT_VAR();
-            } else if (func->getReturnValueType() == ValueTypeEnum::CHAR_TYPE) {
-                ret = MAKE_CHAR_VAR();
-            } else {
-                ret = MAKE_VOID_VAR();
-            }
             /*---------------------------------codegen------------------------------------*/
-            std::vector<Value*> args;
-            args.reserve(realParams.size());
-            for (auto param : realParams) {
-                args.push_back(param->getIrValue());
-            }
             auto function = m_ctx.module.getFunc(func);
-            auto inst = m_ctx.basicBlock->pushBackInst(new CallInst(function, args));
-            ret->setIrValue(inst);
+            auto inst = m_builder.basicBlock->pushBackInst(new CallInst(function, args));
             /*----------------------------------------------------------------------------*/
-            // 生成函数调用，复制参数的代码，ret为返回值
-            return ret;
-        } else if (expect(*node->getChildIter(), VNodeEnum::UNARYOP)) {
-            auto op = unaryOp(*node->getChildIter());
-            node->nextChild();
-            auto ret = unaryExp<Type>(*node->getChildIter());
+            // 生成函数调用，复制参数的代码，返回值的类型与函数的返回类型一致
+            return {inst, func->getReturnValueType()};
+        } else if (expect(cursor.get(), VNodeEnum::UNARYOP)) {
+            auto op = unaryOp(cursor.get());
+            cursor.next();
+            auto ret = unaryExp<Type>(cursor.get());
             // 生成处理'-'和'!'的代码
 
             /*---------------------------------codegen------------------------------------*/
             Value* inst = nullptr;
             if (op == SymbolEnum::MINU) {
-                inst = m_ctx.basicBlock->pushBackInst(new BinaryInst(IRType::Sub, ConstValue::get(0), ret->getIrValue()));
+                inst = m_builder.basicBlock->pushBackInst(new BinaryInst(IRType::Sub, m_ctx.module.getConst(0), ret.value));
             } else if (op == SymbolEnum::NOT) {
-                inst = m_ctx.basicBlock->pushBackInst(new BinaryInst(IRType::Eq, ret->getIrValue(), ConstValue::get(0)));
+                inst = m_builder.basicBlock->pushBackInst(new BinaryInst(IRType::Eq, ret.value, m_ctx.module.getConst(0)));
             } else {
-                inst = m_ctx.basicBlock->pushBackInst(new BinaryInst(IRType::Add, ret->getIrValue(), ConstValue::get(0)));
+                inst = m_builder.basicBlock->pushBackInst(new BinaryInst(IRType::Add, ret.value, m_ctx.module.getConst(0)));
             }
-            ret->setIrValue(inst);
+            ret.value = inst;
+            ret.isConst = false; // 结果来自新生成的指令, 不再是常量
+            ret.constVar = 0;
             /*----------------------------------------------------------------------------*/
 
             return ret;
         } else {
             DBG_ERROR("Unary exppression can not handle input!");
-            return nullptr;
+            return {};
         }
     }
 }
 
-SymbolEnum Visitor::unaryOp(std::shared_ptr<VNodeBase> node) {
-    return (*node->getChildIter())->getSymbol();
+SymbolEnum Visitor::unaryOp(VNodeBase* node) {
+    return node->getChild(0)->getSymbol();
 }
 
-std::vector<SymbolTableItem*> Visitor::funcRParams(std::shared_ptr<VNodeBase> node, FuncItem* func, int lineNum) {
-    std::vector<SymbolTableItem*> realParams;
-    std::vector<std::shared_ptr<VNodeBase>> exps;
+std::vector<Value*> Visitor::funcRParams(VNodeBase* node, FuncItem* func, int lineNum) {
+    std::vector<Value*> realParams;
+    std::vector<VNodeBase*> exps;
     for (auto& child : node->getChildren()) {
         if (expect(child, VNodeEnum::EXP)) {
             exps.push_back(child);
@@ -281,9 +318,8 @@ std::vector<SymbolTableItem*> Visitor::funcRParams(std::shared_ptr<VNodeBase> no
             bool match = true;
             for (size_t i = 0; i < formalParams.size(); i++) {
                 auto type = formalParams[i]->getType()->getValueTypeEnum();
-                auto isArray = formalParams[i]->getType()->isArray();
 
-                SymbolTableItem* ret = nullptr;
+                Value* ret = nullptr;
                 if (type == ValueTypeEnum::INT_TYPE) {
                     ret = funcRParam<IntType>(exps[i], formalParams[i]);
                 } else {
@@ -307,230 +343,244 @@ std::vector<SymbolTableItem*> Visitor::funcRParams(std::shared_ptr<VNodeBase> no
 }
 
 template <typename Type>
-SymbolTableItem* Visitor::funcRParam(std::shared_ptr<VNodeBase> node, SymbolTableItem* formalParam) {
+Value* Visitor::funcRParam(VNodeBase* node, SymbolTableItem* formalParam) {
     auto isArray = formalParam->getType()->isArray();
-    SymbolTableItem* ret = nullptr;
+    Value* ret = nullptr;
     if (isArray) {
         auto realArr = exp<Type>(node);
-        if (realArr && realArr->getType()->getValueTypeEnum() != ValueTypeEnum::VOID_TYPE) {
+        if (realArr && realArr.type != ValueTypeEnum::VOID_TYPE) {
             auto formalDims = getArrayItemDimensions<Type>(formalParam);
             if (checkConvertiable<ArrayType<Type>>(realArr)) {
-                auto realDims = getArrayItemDimensions<Type>(realArr);
-                ret = (realDims.size() == formalDims.size()) ? realArr : nullptr;
+                ret = (realArr.dims.size() == formalDims.size()) ? realArr.value : nullptr;
             }
         }
 
     } else {
         auto realVar = exp<Type>(node);
         if (checkConvertiable<Type>(realVar)) {
-            ret = realVar;
+            ret = realVar.value;
         }
     }
     return ret;
 }
 
 template <typename Type>
-SymbolTableItem* Visitor::primaryExp(std::shared_ptr<VNodeBase> node) {
+ExpValue Visitor::primaryExp(VNodeBase* node) {
+    VNodeCursor cursor(node);
     auto res = calConstExp<Type>(node);
     if (res.second) {
-        auto item = m_table.makeItem<ConstVarItem<Type>>(res.first);
-        item->setIrValue(ConstValue::get(res.first));
-        return item;
+        return makeConstValue<Type>(res.first);
     } else {
-        node->resetIter();
-        if (expect(*node->getChildIter(), SymbolEnum::LPARENT)) {
-            node->nextChild();
-            return exp<Type>(*node->getChildIter());
-        } else if (expect(*node->getChildIter(), VNodeEnum::LVAL)) {
+        if (expect(cursor.get(), SymbolEnum::LPARENT)) {
+            cursor.next();
+            return exp<Type>(cursor.get());
+        } else if (expect(cursor.get(), VNodeEnum::LVAL)) {
             // 检查rVal返回的值类型是否与指定Type相同，如果不同给出警告并转换，不可转换则报错;
-            return rVal<Type>(*node->getChildIter());
+            return rVal<Type>(cursor.get());
         } else {
-            return number<Type>(*node->getChildIter());
+            return number<Type>(cursor.get());
         }
     }
 }
 
 template <typename Type>
-bool Visitor::checkConvertiable(SymbolTableItem* item) {
-    SymbolTableItem* ret = nullptr;
-    auto varValue = dynamic_cast<VarItem<Type>*>(item); // 直接转换，只有类型完全相同才能转化
-    auto constVarValue = dynamic_cast<ConstVarItem<Type>*>(item);
-    return (varValue != nullptr) || (constVarValue != nullptr);
+bool Visitor::checkConvertiable(const ExpValue& val) {
+    Type type; // 直接转换，只有类型完全相同才能转化
+    return val && val.type == type.getValueTypeEnum() && val.isArray() == type.isArray();
 }
 
 template <typename Type>
-ConstVarItem<Type>* Visitor::number(std::shared_ptr<VNodeBase> node) {
-    return m_table.makeItem<ConstVarItem<Type>>({});
+ExpValue Visitor::makeConstValue(typename Type::InternalType val) {
+    ExpValue ret(m_ctx.module.getConst(val), Type().getValueTypeEnum());
+    ret.isConst = true;
+    ret.constVar = val;
+    return ret;
+}
+
+template <typename Type>
+ExpValue Visitor::makeVarValue(Value* value) {
+    return {value, Type().getValueTypeEnum()};
+}
+
+template <typename Type>
+ExpValue Visitor::number(VNodeBase* node) {
+    return makeConstValue<Type>({});
 }
 
 template <>
-ConstVarItem<IntType>* Visitor::number(std::shared_ptr<VNodeBase> node) {
-    auto leafNode = std::dynamic_pointer_cast<VNodeLeaf>(*node->getChildIter());
-    auto lineNum = leafNode->getToken().lineNum;
+ExpValue Visitor::number<IntType>(VNodeBase* node) {
+    auto leafNode = dynamic_cast<VNodeLeaf*>(node->getChild(0));
     auto value = static_cast<typename IntType::InternalType>(leafNode->getToken().value);
-    auto number = m_table.makeItem<ConstVarItem<IntType>>(value);
-    return number;
+    return makeConstValue<IntType>(value);
 }
 
 template <>
-ConstVarItem<CharType>* Visitor::number(std::shared_ptr<VNodeBase> node) {
-    auto leafNode = std::dynamic_pointer_cast<VNodeLeaf>(*node->getChildIter());
+ExpValue Visitor::number<CharType>(VNodeBase* node) {
+    auto leafNode = dynamic_cast<VNodeLeaf*>(node->getChild(0));
     auto value = static_cast<typename CharType::InternalType>(leafNode->getToken().value);
-    auto number = m_table.makeItem<ConstVarItem<CharType>>(value);
-    return number;
+    return makeConstValue<CharType>(value);
 }
 
 template <typename Type>
-std::pair<typename Type::InternalType, bool> Visitor::calConstExp(std::shared_ptr<VNodeBase> node) {
+std::pair<typename Type::InternalType, bool> Visitor::calConstExp(VNodeBase* node) {
     if (node->getType() == VType::VT) {
         if (expect(node, SymbolEnum::INTCON)) {
-            return {std::dynamic_pointer_cast<VNodeLeaf>(node)->getToken().value, true};
+            return {dynamic_cast<VNodeLeaf*>(node)->getToken().value, true};
         }
-        return {std::dynamic_pointer_cast<VNodeLeaf>(node)->getToken().value, true};
+        return {dynamic_cast<VNodeLeaf*>(node)->getToken().value, true};
     } else {
-        switch (node->getNodeEnum()) {
-        case VNodeEnum::ADDEXP:
-            if (node->getChildrenNum() == 1) {
-                return calConstExp<Type>(*node->getChildIter());
-            } else {
-                auto res1 = calConstExp<Type>(*node->getChildIter());
-                auto res2 = calConstExp<Type>(*node->getChildIter(2));
-                if (res1.second && res2.second) {
-                    if ((*node->getChildIter(1))->getSymbol() == SymbolEnum::PLUS) {
-                        return {res1.first + res2.first, true};
-                    } else {
-                        return {res1.first - res2.first, true};
-                    }
-                }
-            }
-            break;
-        case VNodeEnum::MULEXP:
-            if (node->getChildrenNum() == 1) {
-                return calConstExp<Type>(*node->getChildIter());
-            } else {
-                auto res1 = calConstExp<Type>(*node->getChildIter());
-                auto res2 = calConstExp<Type>(*node->getChildIter(2));
-                if (res1.second && res2.second) {
-                    if ((*node->getChildIter(1))->getSymbol() == SymbolEnum::MULT) {
-                        return {res1.first * res2.first, true};
-                    } else if ((*node->getChildIter(1))->getSymbol() == SymbolEnum::DIV) {
-                        return {res1.first / res2.first, true};
-                    } else {
-                        return {res1.first % res2.first, true};
-                    }
+        // 每个子树只折叠一次, 之后的查询直接取缓存的结果
+        auto& cache = m_constCache[std::is_same<Type, CharType>::value];
+        auto finded = cache.find(node);
+        if (finded != cache.end()) {
+            return {static_cast<typename Type::InternalType>(finded->second.first), finded->second.second};
+        }
+        auto res = foldConstExp<Type>(node);
+        cache.emplace(node, std::make_pair(static_cast<int>(res.first), res.second));
+        return res;
+    }
+}
+
+template <typename Type>
+std::pair<typename Type::InternalType, bool> Visitor::foldConstExp(VNodeBase* node) {
+    VNodeCursor cursor(node);
+    switch (node->getNodeEnum()) {
+    case VNodeEnum::ADDEXP:
+        if (node->getChildrenNum() == 1) {
+            return calConstExp<Type>(cursor.get());
+        } else {
+            auto res1 = calConstExp<Type>(cursor.get());
+            auto res2 = calConstExp<Type>(cursor.get(2));
+            if (res1.second && res2.second) {
+                if (cursor.get(1)->getSymbol() == SymbolEnum::PLUS) {
+                    return {res1.first + res2.first, true};
+                } else {
+                    return {res1.first - res2.first, true};
                 }
             }
-            break;
-        case VNodeEnum::UNARYEXP:
-            if (expect(*node->getChildIter(), SymbolEnum::IDENFR)) { // func
-                return {0, false};
-            } else if (expect(*node->getChildIter(), VNodeEnum::PRIMARYEXP)) {
-                return calConstExp<Type>(*node->getChildIter());
-            } else {
-                auto symbol = (*(*node->getChildIter())->getChildIter())->getSymbol();
-                auto res = calConstExp<Type>(*node->getChildIter(1));
-                if (symbol == SymbolEnum::PLUS) {
-                    return res;
-                } else if (symbol == SymbolEnum::MINU) {
-                    res.first = -res.first;
-                    return res;
+        }
+        break;
+    case VNodeEnum::MULEXP:
+        if (node->getChildrenNum() == 1) {
+            return calConstExp<Type>(cursor.get());
+        } else {
+            auto res1 = calConstExp<Type>(cursor.get());
+            auto res2 = calConstExp<Type>(cursor.get(2));
+            if (res1.second && res2.second) {
+                if (cursor.get(1)->getSymbol() == SymbolEnum::MULT) {
+                    return {res1.first * res2.first, true};
+                } else if (cursor.get(1)->getSymbol() == SymbolEnum::DIV) {
+                    return {res1.first / res2.first, true};
                 } else {
-                    return {!res.first, false};
+                    return {res1.first % res2.first, true};
                 }
             }
-            break;
-        case VNodeEnum::PRIMARYEXP:
-            if (expect(*node->getChildIter(), SymbolEnum::LPARENT)) {
-                return calConstExp<Type>(*node->getChildIter(1));
-            } else if (expect(*node->getChildIter(), VNodeEnum::LVAL)) {
-                return calConstExp<Type>(*node->getChildIter());
+        }
+        break;
+    case VNodeEnum::UNARYEXP:
+        if (expect(cursor.get(), SymbolEnum::IDENFR)) { // func
+            return {0, false};
+        } else if (expect(cursor.get(), VNodeEnum::PRIMARYEXP)) {
+            return calConstExp<Type>(cursor.get());
+        } else {
+            auto symbol = cursor.get()->getChild(0)->getSymbol();
+            auto res = calConstExp<Type>(cursor.get(1));
+            if (symbol == SymbolEnum::PLUS) {
+                return res;
+            } else if (symbol == SymbolEnum::MINU) {
+                res.first = -res.first;
+                return res;
             } else {
-                return calConstExp<Type>(*node->getChildIter());
+                return {!res.first, false};
             }
-            break;
-        case VNodeEnum::LVAL: {
-            node->resetIter();
-            auto leafNode = std::dynamic_pointer_cast<VNodeLeaf>(*node->getChildIter());
-            auto item = m_table.findItem(leafNode->getToken().literal);
-            if (item != nullptr) {
-                auto constVarItem = dynamic_cast<ConstVarItem<Type>*>(item);
-                auto constArrayItem = dynamic_cast<ConstVarItem<ArrayType<Type>>*>(item);
-                if (constVarItem || constArrayItem) {
-                    if (constVarItem) {
-                        return {constVarItem->getConstVar(), true};
-                    }
-                    if (constArrayItem) {
-                        std::vector<size_t> dims;
-                        node->nextChild();
-                        while (expect(*node->getChildIter(), SymbolEnum::LBRACK) && expect(*node->getChildIter(2), SymbolEnum::RBRACK)) {
-                            auto res = exp<Type>(*node->getChildIter(1));
-                            if (auto dim = dynamic_cast<ConstVarItem<Type>*>(res)) {
-                                if (dim->getConstVar() >= 0) {
-                                    dims.push_back(static_cast<size_t>(dim->getConstVar()));
-                                } else {
-                                    Logger::logError("Use dimension as negative size!");
-                                }
+        }
+        break;
+    case VNodeEnum::PRIMARYEXP:
+        if (expect(cursor.get(), SymbolEnum::LPARENT)) {
+            return calConstExp<Type>(cursor.get(1));
+        } else if (expect(cursor.get(), VNodeEnum::LVAL)) {
+            return calConstExp<Type>(cursor.get());
+        } else {
+            return calConstExp<Type>(cursor.get());
+        }
+        break;
+    case VNodeEnum::LVAL: {
+        auto leafNode = dynamic_cast<VNodeLeaf*>(cursor.get());
+        auto item = m_table.findItem(leafNode->getToken());
+        if (item != nullptr) {
+            auto constVarItem = dynamic_cast<ConstVarItem<Type>*>(item);
+            auto constArrayItem = dynamic_cast<ConstVarItem<ArrayType<Type>>*>(item);
+            if (constVarItem || constArrayItem) {
+                if (constVarItem) {
+                    return {constVarItem->getConstVar(), true};
+                }
+                if (constArrayItem) {
+                    std::vector<size_t> dims;
+                    cursor.next();
+                    while (expect(cursor.get(), SymbolEnum::LBRACK) && expect(cursor.get(2), SymbolEnum::RBRACK)) {
+                        auto dim = calConstExp<Type>(cursor.get(1)); // 只折叠下标, 不生成代码
+                        if (dim.second) {
+                            if (dim.first >= 0) {
+                                dims.push_back(static_cast<size_t>(dim.first));
                             } else {
-                                return {0, false};
+                                Logger::logError("Use dimension as negative size!");
                             }
-                            if (!node->nextChild(3, false)) break; // jump '[dim]'
+                        } else {
+                            return {0, false};
                         }
-                        auto val = constArrayItem->getConstVar()[std::move(dims)];
-                        return {val, true};
+                        if (!cursor.next(3, false)) break; // jump '[dim]'
                     }
-                } else {
-                    return {0, false};
+                    auto val = constArrayItem->getConstVar()[dims];
+                    return {val, true};
                 }
             } else {
-                Logger::logError(ErrorType::UNDECL_IDENT, leafNode->getToken().lineNum, leafNode->getToken().literal);
+                return {0, false};
             }
-
-        } break;
-        case VNodeEnum::EXP:
-        case VNodeEnum::NUM:
-            return calConstExp<Type>(*node->getChildIter());
-            break;
-        default: break;
+        } else {
+            return {0, false}; // 未定义的名字由rVal或constExp报告, 折叠本身不输出错误
         }
+    } break;
+    case VNodeEnum::EXP:
+    case VNodeEnum::NUM:
+        return calConstExp<Type>(cursor.get());
+        break;
+    default: break;
     }
     return {0, false};
 }
 
 template <typename Type>
-typename Type::InternalType Visitor::constInitVal(std::shared_ptr<VNodeBase> node, std::vector<size_t>& dims, int level) {
-    return constExp<Type>(*node->getChildIter());
+typename Type::InternalType Visitor::constInitVal(VNodeBase* node, std::vector<size_t>& dims, int level) {
+    return constExp<Type>(node->getChild(0));
 };
 
 template <typename Type>
-typename ArrayType<Type>::InternalType Visitor::constInitValArray(std::shared_ptr<VNodeBase> node, std::vector<size_t>& dims, int level) {
+typename ArrayType<Type>::InternalType Visitor::constInitValArray(VNodeBase* node, std::vector<size_t>& dims, int level) {
+    VNodeCursor cursor(node);
     typename ArrayType<Type>::InternalType values;
-    if (expect(*node->getChildIter(), SymbolEnum::LBRACE)) {
-        node->nextChild();
+    if (expect(cursor.get(), SymbolEnum::LBRACE)) {
+        cursor.next();
         size_t num = 0;
-        if (!expect(*node->getChildIter(), SymbolEnum::RBRACE)) {
-            auto value = constInitValArray<Type>(*node->getChildIter(), dims, level + 1);
+        if (!expect(cursor.get(), SymbolEnum::RBRACE)) {
+            auto value = constInitValArray<Type>(cursor.get(), dims, level + 1);
             values.append(std::move(value));
-            node->nextChild(); // jump '}'
+            cursor.next(); // jump '}'
             num++;
-            while (expect(*node->getChildIter(), SymbolEnum::COMMA)) {
-                node->nextChild(); // jump ','
-                auto value = constInitValArray<Type>(*node->getChildIter(), dims, level + 1);
+            while (expect(cursor.get(), SymbolEnum::COMMA)) {
+                cursor.next(); // jump ','
+                auto value = constInitValArray<Type>(cursor.get(), dims, level + 1);
                 values.append(std::move(value));
-                node->nextChild(); // jump '}'
+                cursor.next(); // jump '}'
                 num++;
             }
         }
         //std::cout << num << " " << level << std::endl;
         int diff = dims[level] - num; // 补零和报错
         if (diff >= 0) {
-            for (int i = 0; i < diff; i++) {
-                if (level + 1 >= dims.size()) {
-                    values.insert(0);
-                } else {
-                    for (int j = 0; j < dims[level + 1]; j++) {
-                        values.insert(0);
-                    }
-                }
+            if (level + 1 >= dims.size()) {
+                values.insertZeros(diff);
+            } else {
+                values.insertZeros(diff * dims[level + 1]);
             }
         } else {
             Logger::logError("Too much number defined!");
@@ -544,26 +594,27 @@ typename ArrayType<Type>::InternalType Visitor::constInitValArray(std::shared_pt
 };
 
 template <typename Type>
-typename Type::InternalItem Visitor::initVal(std::shared_ptr<VNodeBase> node, std::vector<size_t>& dims, int level) {
-    return exp<Type>(*node->getChildIter());
+typename Type::InternalItem Visitor::initVal(VNodeBase* node, std::vector<size_t>& dims, int level) {
+    return exp<Type>(node->getChild(0)).value;
 };
 
 template <typename Type>
-typename ArrayType<Type>::InternalItem Visitor::initValArray(std::shared_ptr<VNodeBase> node, std::vector<size_t>& dims, int level) {
+typename ArrayType<Type>::InternalItem Visitor::initValArray(VNodeBase* node, std::vector<size_t>& dims, int level) {
+    VNodeCursor cursor(node);
     typename ArrayType<Type>::InternalItem values;
-    if (expect(*node->getChildIter(), SymbolEnum::LBRACE)) {
-        node->nextChild();
+    if (expect(cursor.get(), SymbolEnum::LBRACE)) {
+        cursor.next();
         size_t num = 0;
-        if (!expect(*node->getChildIter(), SymbolEnum::RBRACE)) {
-            auto value = initValArray<Type>(*node->getChildIter(), dims, level + 1);
+        if (!expect(cursor.get(), SymbolEnum::RBRACE)) {
+            auto value = initValArray<Type>(cursor.get(), dims, level + 1);
             values.append(std::move(value));
-            node->nextChild(); // jump '}'
+            cursor.next(); // jump '}'
             num++;
-            while (expect(*node->getChildIter(), SymbolEnum::COMMA)) {
-                node->nextChild(); // jump ','
-                auto value = initValArray<Type>(*node->getChildIter(), dims, level + 1);
+            while (expect(cursor.get(), SymbolEnum::COMMA)) {
+                cursor.next(); // jump ','
+                auto value = initValArray<Type>(cursor.get(), dims, level + 1);
                 values.append(std::move(value));
-                node->nextChild(); // jump '}'
+                cursor.next(); // jump '}'
                 num++;
             }
         }
@@ -576,55 +627,56 @@ typename ArrayType<Type>::InternalItem Visitor::initValArray(std::shared_ptr<VNo
 };
 
 template <typename Type>
-typename Type::InternalType Visitor::initValGlobal(std::shared_ptr<VNodeBase> node, std::vector<size_t>& dims, int level) {
+typename Type::InternalType Visitor::initValGlobal(VNodeBase* node, std::vector<size_t>& dims, int level) {
     return constInitVal<Type>(node, dims, level);
 };
 
 template <typename Type>
-typename ArrayType<Type>::InternalType Visitor::initValGlobalArray(std::shared_ptr<VNodeBase> node, std::vector<size_t>& dims, int level) {
+typename ArrayType<Type>::InternalType Visitor::initValGlobalArray(VNodeBase* node, std::vector<size_t>& dims, int level) {
     return constInitValArray<Type>(node, dims, level);
 };
 
 template <typename Type>
-void Visitor::constDef(std::shared_ptr<VNodeBase> node) {
-    auto leafNode = std::dynamic_pointer_cast<VNodeLeaf>(*node->getChildIter());
-    std::string identName = leafNode->getToken().literal;
+void Visitor::constDef(VNodeBase* node) {
+    VNodeCursor cursor(node);
+    auto leafNode = dynamic_cast<VNodeLeaf*>(cursor.get());
+    const std::string& identName = leafNode->getToken().getLiteral();
     int lineNum = leafNode->getToken().lineNum;
-    node->nextChild(); // jump IDENT
+    cursor.next(); // jump IDENT
     std::vector<size_t> dims;
-    while (expect(*node->getChildIter(), SymbolEnum::LBRACK) && expect(*node->getChildIter(2), SymbolEnum::RBRACK)) {
-        int dim = constExp<Type>(*node->getChildIter(1));
+    while (expect(cursor.get(), SymbolEnum::LBRACK) && expect(cursor.get(2), SymbolEnum::RBRACK)) {
+        int dim = constExp<Type>(cursor.get(1));
         if (dim >= 0) {
             dims.push_back(static_cast<size_t>(dim));
         } else {
             Logger::logError("Use dimension as negative size!");
         }
-        if (!node->nextChild(3)) break; // jump '[dim]'
+        if (!cursor.next(3)) break; // jump '[dim]'
     }
-    node->nextChild(); // jump '='
+    cursor.next(); // jump '='
     std::pair<SymbolTableItem*, bool> res;
     typename Type::InternalType var;
     MultiFlatArray<typename Type::InternalType> varArray;
     bool notArray = dims.size() == 0;
     if (notArray) {
-        var = constInitVal<Type>(*node->getChildIter(), dims, 0);
-        res = m_table.insertItem<ConstVarItem<Type>>(identName, var);
+        var = constInitVal<Type>(cursor.get(), dims, 0);
+        res = m_table.insertItem<ConstVarItem<Type>>(leafNode->getToken(), var);
 
     } else {
-        varArray = constInitValArray<Type>(*node->getChildIter(), dims, 0);
-        res = m_table.insertItem<ConstVarItem<ArrayType<Type>>>(identName, varArray);
+        varArray = constInitValArray<Type>(cursor.get(), dims, 0);
+        res = m_table.insertItem<ConstVarItem<ArrayType<Type>>>(leafNode->getToken(), varArray);
     }
 
     /*---------------------------------codegen------------------------------------*/
     if (m_table.getCurrentScope().getType() != BlockScopeType::GLOBAL) {
-        auto inst = m_ctx.basicBlock->pushBackInst(new AllocaInst(res.first));
+        auto inst = m_builder.basicBlock->pushBackInst(new AllocaInst(res.first));
         if (notArray) {
-            m_ctx.basicBlock->pushBackInst(new StoreInst(res.first, inst, ConstValue::get(var), ConstValue::get(0)));
+            m_builder.basicBlock->pushBackInst(new StoreInst(res.first, inst, m_ctx.module.getConst(var), m_ctx.module.getConst(0)));
         } else {
             int k = 0;
             int dimsSize = calArrayDimsSize(dims);
-            for (auto& var : varArray.getValues()) {
-                m_ctx.basicBlock->pushBackInst(new StoreInst(res.first, inst, ConstValue::get(var), ConstValue::get(k++)));
+            for (auto var : varArray) {
+                m_builder.basicBlock->pushBackInst(new StoreInst(res.first, inst, m_ctx.module.getConst(var), m_ctx.module.getConst(k++)));
                 if (k >= dimsSize) break;
             }
         }
@@ -640,42 +692,43 @@ void Visitor::constDef(std::shared_ptr<VNodeBase> node) {
     }
 }
 template <typename Type>
-void Visitor::varDef(std::shared_ptr<VNodeBase> node) {
-    auto leafNode = std::dynamic_pointer_cast<VNodeLeaf>(*node->getChildIter());
-    std::string identName = leafNode->getToken().literal;
+void Visitor::varDef(VNodeBase* node) {
+    VNodeCursor cursor(node);
+    auto leafNode = dynamic_cast<VNodeLeaf*>(cursor.get());
+    const std::string& identName = leafNode->getToken().getLiteral();
     int lineNum = leafNode->getToken().lineNum;
-    node->nextChild(1, false); // jump IDENT
+    cursor.next(1, false); // jump IDENT
     std::vector<size_t> dims;
-    while (expect(*node->getChildIter(), SymbolEnum::LBRACK) && expect(*node->getChildIter(2), SymbolEnum::RBRACK)) {
-        int dim = constExp<Type>(*node->getChildIter(1));
+    while (expect(cursor.get(), SymbolEnum::LBRACK) && expect(cursor.get(2), SymbolEnum::RBRACK)) {
+        int dim = constExp<Type>(cursor.get(1));
         if (dim >= 0) {
             dims.push_back(static_cast<size_t>(dim));
         } else {
             Logger::logError("Use dimension as negative size!");
         }
-        if (!node->nextChild(3, false)) break; // jump '[dim]'
+        if (!cursor.next(3, false)) break; // jump '[dim]'
     }
     std::pair<SymbolTableItem*, bool> res(nullptr, true);
 
     if (m_table.getCurrentScope().getType() == BlockScopeType::GLOBAL) {
         MultiFlatArray<typename Type::InternalType> varArray;
-        typename Type::InternalType var;
+        typename Type::InternalType var{};
         bool hasInit = false;
-        if (expect(*node->getChildIter(), SymbolEnum::ASSIGN)) {
-            node->nextChild();
+        if (expect(cursor.get(), SymbolEnum::ASSIGN)) {
+            cursor.next();
             hasInit = true;
             if (dims.size() == 0) {
-                var = constInitVal<Type>(*node->getChildIter(), dims, 0);
+                var = constInitVal<Type>(cursor.get(), dims, 0);
             } else {
-                varArray = constInitValArray<Type>(*node->getChildIter(), dims, 0);
+                varArray = constInitValArray<Type>(cursor.get(), dims, 0);
             }
         } else {
             varArray.setDimensions(dims);
         }
         if (dims.size() == 0) {
-            res = m_table.insertItem<VarItem<Type>>(identName, {nullptr, var, hasInit});
+            res = m_table.insertItem<VarItem<Type>>(leafNode->getToken(), {nullptr, var, hasInit});
         } else {
-            res = m_table.insertItem<VarItem<ArrayType<Type>>>(identName, {{{.values = {}, .dimensions = varArray.getDimensions()}}, varArray, hasInit});
+            res = m_table.insertItem<VarItem<ArrayType<Type>>>(leafNode->getToken(), {{{.values = {}, .dimensions = varArray.getDimensions()}}, varArray, hasInit});
         }
         /*---------------------------------codegen------------------------------------*/
         auto glob = m_ctx.module.addGlobalVar(res.first);
@@ -685,36 +738,36 @@ void Visitor::varDef(std::shared_ptr<VNodeBase> node) {
             Logger::logError(ErrorType::REDEF_IDENT, lineNum, identName);
         }
     } else {
-        MultiFlatArray<SymbolTableItem*> itemArray;
-        SymbolTableItem* item;
+        MultiFlatArray<Value*> itemArray;
+        Value* item = nullptr;
         bool hasInit = false;
         bool notArray = dims.size() == 0;
-        if (expect(*node->getChildIter(), SymbolEnum::ASSIGN)) {
-            node->nextChild();
+        if (expect(cursor.get(), SymbolEnum::ASSIGN)) {
+            cursor.next();
             hasInit = true;
             if (notArray) {
-                item = initVal<Type>(*node->getChildIter(), dims, 0);
+                item = initVal<Type>(cursor.get(), dims, 0);
             } else {
-                itemArray = initValArray<Type>(*node->getChildIter(), dims, 0);
+                itemArray = initValArray<Type>(cursor.get(), dims, 0);
             }
         } else {
             itemArray.setDimensions(dims);
         }
         if (notArray) {
-            res = m_table.insertItem<VarItem<Type>>(identName, {item, 0, hasInit});
+            res = m_table.insertItem<VarItem<Type>>(leafNode->getToken(), {item, 0, hasInit});
         } else {
-            res = m_table.insertItem<VarItem<ArrayType<Type>>>(identName, {itemArray, {}, hasInit});
+            res = m_table.insertItem<VarItem<ArrayType<Type>>>(leafNode->getToken(), {itemArray, {}, hasInit});
         }
         /*---------------------------------codegen------------------------------------*/
-        auto inst = m_ctx.basicBlock->pushBackInst(new AllocaInst(res.first));
+        auto inst = m_builder.basicBlock->pushBackInst(new AllocaInst(res.first));
         if (hasInit) {
             if (notArray) {
-                m_ctx.basicBlock->pushBackInst(new StoreInst(res.first, inst, item->getIrValue(), ConstValue::get(0)));
+                m_builder.basicBlock->pushBackInst(new StoreInst(res.first, inst, item, m_ctx.module.getConst(0)));
             } else {
                 int k = 0;
                 int dimsSize = calArrayDimsSize(dims);
-                for (auto& item : itemArray.getValues()) {
-                    m_ctx.basicBlock->pushBackInst(new StoreInst(res.first, inst, item->getIrValue(), ConstValue::get(k++)));
+                for (auto item : itemArray) {
+                    m_builder.basicBlock->pushBackInst(new StoreInst(res.first, inst, item, m_ctx.module.getConst(k++)));
                     if (k >= dimsSize) break;
                 }
             }
@@ -727,133 +780,167 @@ void Visitor::varDef(std::shared_ptr<VNodeBase> node) {
     }
 }
 
-ValueTypeEnum Visitor::bType(std::shared_ptr<VNodeBase> node) { // 基本类型
-    if ((*node->getChildIter())->getSymbol() == SymbolEnum::INTTK) {
+ValueTypeEnum Visitor::bType(VNodeBase* node) { // 基本类型
+    if (node->getChild(0)->getSymbol() == SymbolEnum::INTTK) {
         return ValueTypeEnum::INT_TYPE;
     } else {
         return ValueTypeEnum::CHAR_TYPE;
     }
 }
 
-ValueTypeEnum Visitor::funcType(std::shared_ptr<VNodeBase> node) {
-    if ((*node->getChildIter())->getSymbol() == SymbolEnum::INTTK) {
+ValueTypeEnum Visitor::funcType(VNodeBase* node) {
+    if (node->getChild(0)->getSymbol() == SymbolEnum::INTTK) {
         return ValueTypeEnum::INT_TYPE;
-    } else if ((*node->getChildIter())->getSymbol() == SymbolEnum::CHARTK) {
+    } else if (node->getChild(0)->getSymbol() == SymbolEnum::CHARTK) {
         return ValueTypeEnum::CHAR_TYPE;
     } else {
         return ValueTypeEnum::VOID_TYPE;
     }
 }
-void Visitor::mainFuncDef(std::shared_ptr<VNodeBase> node) {
-    node->nextChild(); // jump 'int' | 'void'
-    auto leafNode = std::dynamic_pointer_cast<VNodeLeaf>(*node->getChildIter());
+bool Visitor::mainFuncDef(VNodeBase* node) {
+    VNodeCursor cursor(node);
+    cursor.next(); // jump 'int' | 'void'
+    auto leafNode = dynamic_cast<VNodeLeaf*>(cursor.get());
     std::string identName = "main";
     int lineNum = leafNode->getToken().lineNum;
-    auto res = m_table.insertFunc(identName, ValueTypeEnum::INT_TYPE);
+    auto res = m_table.insertFunc(leafNode->getToken(), ValueTypeEnum::INT_TYPE);
     if (!res.second) {
         Logger::logError(ErrorType::REDEF_IDENT, lineNum, identName);
     }
-    node->nextChild(2); // jump MAINTK & '('
-    m_table.pushScope(BlockScopeType::FUNC);
-    m_table.getCurrentScope().setFuncItem(res.first);
-    /*---------------------------------codegen------------------------------------*/
-    m_ctx.function = m_ctx.module.addFunc(new IrFunc(res.first));
-    m_ctx.basicBlock = m_ctx.function->pushBackBasicBlock(new BasicBlock());
-    for (auto& var : m_ctx.module.getGlobalVariables()) {
-        auto globItem = var->getGlobalItem();
-        //auto inst = m_ctx.basicBlock->pushBackInst(new GetElementPtrInst(globItem, var.get(), ConstValue::get(0), 0));
-        auto globVar = new GlobalVariable(globItem);
-        globItem->setIrValue(globVar);
-    }
-    /*----------------------------------------------------------------------------*/
+    cursor.next(2); // jump MAINTK & '('
+    auto visitor = beginFunc(res.first);
     std::vector<SymbolTableItem*> params;
-    if (expect(*node->getChildIter(), VNodeEnum::FUNCFPARAMS)) {
-        params = funcFParams(*node->getChildIter());
-        node->nextChild();
+    if (expect(cursor.get(), VNodeEnum::FUNCFPARAMS)) {
+        params = visitor->funcFParams(cursor.get());
+        cursor.next();
     }
     res.first->setParams(params);
-    node->nextChild(); // jump ')'
-    block(*node->getChildIter());
-    m_table.popScope();
+    cursor.next(); // jump ')'
+    return endFunc(visitor, cursor.get());
 }
 
-void Visitor::funcDef(std::shared_ptr<VNodeBase> node) {
-    auto retType = funcType(*node->getChildIter());
-    node->nextChild(); // jump 'int' | 'void'
-    auto leafNode = std::dynamic_pointer_cast<VNodeLeaf>(*node->getChildIter());
-    std::string identName = leafNode->getToken().literal;
+bool Visitor::funcDef(VNodeBase* node) {
+    VNodeCursor cursor(node);
+    auto retType = funcType(cursor.get());
+    cursor.next(); // jump 'int' | 'void'
+    auto leafNode = dynamic_cast<VNodeLeaf*>(cursor.get());
+    const std::string& identName = leafNode->getToken().getLiteral();
     int lineNum = leafNode->getToken().lineNum;
-    auto res = m_table.insertFunc(identName, retType);
+    auto res = m_table.insertFunc(leafNode->getToken(), retType);
     if (!res.second) {
         Logger::logError(ErrorType::REDEF_IDENT, lineNum, identName);
-        return;
+        return false;
     }
-    node->nextChild(2); // jump IDENT '('
-    m_table.pushScope(BlockScopeType::FUNC);
-    m_table.getCurrentScope().setFuncItem(res.first);
-
+    cursor.next(2); // jump IDENT '('
+    auto visitor = beginFunc(res.first);
     std::vector<SymbolTableItem*> params;
-    if (expect(*node->getChildIter(), VNodeEnum::FUNCFPARAMS)) {
-        params = funcFParams(*node->getChildIter());
-        node->nextChild();
+    if (expect(cursor.get(), VNodeEnum::FUNCFPARAMS)) {
+        params = visitor->funcFParams(cursor.get());
+        cursor.next();
+    }
+    res.first->setParams(params);
+    cursor.next(); // jump ')'
+    return endFunc(visitor, cursor.get());
+}
+
+// 函数签名已经登记在全局符号表中, 为函数建立自己的符号表和Visitor, IrFunc按函数定义的顺序加入模块
+Visitor* Visitor::beginFunc(FuncItem* funcItem) {
+    auto visitor = new Visitor(nullptr, *m_table.addFuncTable(), m_ctx);
+    m_funcVisitors.emplace_back(visitor);
+    visitor->m_table.pushScope(BlockScopeType::FUNC);
+    visitor->m_table.getCurrentScope().setFuncItem(funcItem);
+    visitor->m_builder.function = m_ctx.module.addFunc(new IrFunc(funcItem));
+    return visitor;
+}
+
+// 没有线程池时立即生成函数体; 否则推迟到endCompUnit中并行生成, 此时返回true
+bool Visitor::endFunc(Visitor* visitor, VNodeBase* body) {
+    visitor->m_astRoot = body;
+    if (m_pool) {
+        return true;
     }
+    visitor->funcBody();
+    finishFunc(*visitor);
+    m_funcVisitors.pop_back();
+    return false;
+}
+
+// 函数体生成完毕, 把它用到的字符串按顺序加入模块
+void Visitor::finishFunc(Visitor& visitor) {
+    for (auto& str : visitor.m_builder.strVars) {
+        m_ctx.module.addStrVar(std::move(str));
+    }
+}
+
+// 函数体的Visitor中m_astRoot是函数体的block
+void Visitor::funcBody() {
     /*---------------------------------codegen------------------------------------*/
-    m_ctx.function = m_ctx.module.addFunc(new IrFunc(res.first));
-    m_ctx.basicBlock = m_ctx.function->pushBackBasicBlock(new BasicBlock());
+    SlabArena::Scope arenaScope(m_builder.function->getArena());
+    m_builder.basicBlock = m_builder.function->pushBackBasicBlock(new BasicBlock());
     for (auto& var : m_ctx.module.getGlobalVariables()) {
         auto globItem = var->getGlobalItem();
-        //auto inst = m_ctx.basicBlock->pushBackInst(new GetElementPtrInst(globItem, var.get(), ConstValue::get(0), 0));
-        auto globVar = new GlobalVariable(globItem);
-        globItem->setIrValue(globVar);
+        //auto inst = m_builder.basicBlock->pushBackInst(new GetElementPtrInst(globItem, var.get(), m_ctx.module.getConst(0), 0));
+        m_builder.globalValues[globItem] = m_builder.function->addLocalValue(new GlobalVariable(globItem));
     }
-    for (auto& param : params) {
+    for (auto& param : m_builder.function->getFuncItem()->getParams()) {
         if (!param->getType()->isArray()) {
-            auto inst = m_ctx.basicBlock->pushBackInst(new AllocaInst(param));
+            auto inst = m_builder.basicBlock->pushBackInst(new AllocaInst(param));
             param->setIrValue(inst);
-            m_ctx.basicBlock->pushBackInst(new StoreInst(param, inst, new ParamVariable(param), ConstValue::get(0)));
+            m_builder.basicBlock->pushBackInst(new StoreInst(param, inst, m_builder.function->addLocalValue(new ParamVariable(param)), m_ctx.module.getConst(0)));
         } else {
-            param->setIrValue(new ParamVariable(param));
+            param->setIrValue(m_builder.function->addLocalValue(new ParamVariable(param)));
         }
     }
     /*----------------------------------------------------------------------------*/
-    res.first->setParams(params);
-    node->nextChild(); // jump ')'
-    block(*node->getChildIter());
+    block(m_astRoot);
     m_table.popScope(); // pop from func
 }
 
+// 全局变量在每个函数中有自己的引用, 记在m_builder中, 不写回各函数共享的符号表项
+Value* Visitor::irValue(SymbolTableItem* item) {
+    if (item->getLevel() == 0) {
+        auto it = m_builder.globalValues.find(item);
+        if (it != m_builder.globalValues.end()) {
+            return it->second;
+        }
+    }
+    return item->getIrValue();
+}
+
 // TODO: 完成形参列表
-std::vector<SymbolTableItem*> Visitor::funcFParams(std::shared_ptr<VNodeBase> node) {
+std::vector<SymbolTableItem*> Visitor::funcFParams(VNodeBase* node) {
+    VNodeCursor cursor(node);
     std::vector<SymbolTableItem*> params;
-    params.push_back(funcFParam(*node->getChildIter()));
-    node->nextChild(1, false);
-    while (expect(*node->getChildIter(), SymbolEnum::COMMA)) {
-        node->nextChild(); // jump ','
-        params.push_back(funcFParam(*node->getChildIter()));
-        if (!node->nextChild(1, false)) break;
+    params.push_back(funcFParam(cursor.get()));
+    cursor.next(1, false);
+    while (expect(cursor.get(), SymbolEnum::COMMA)) {
+        cursor.next(); // jump ','
+        params.push_back(funcFParam(cursor.get()));
+        if (!cursor.next(1, false)) break;
     }
     return params;
 }
 
-SymbolTableItem* Visitor::funcFParam(std::shared_ptr<VNodeBase> node) {
-    auto type = bType(*node->getChildIter());
-    node->nextChild(); // jump 'int'
-    auto leafNode = std::dynamic_pointer_cast<VNodeLeaf>(*node->getChildIter());
-    std::string identName = leafNode->getToken().literal;
+SymbolTableItem* Visitor::funcFParam(VNodeBase* node) {
+    VNodeCursor cursor(node);
+    auto type = bType(cursor.get());
+    cursor.next(); // jump 'int'
+    auto leafNode = dynamic_cast<VNodeLeaf*>(cursor.get());
+    const std::string& identName = leafNode->getToken().getLiteral();
     int lineNum = leafNode->getToken().lineNum;
     std::vector<size_t> dims;
-    if (node->nextChild(1, false)) {
-        if (expect(*node->getChildIter(), SymbolEnum::LBRACK) && expect(*node->getChildIter(1), SymbolEnum::RBRACK)) {
+    if (cursor.next(1, false)) {
+        if (expect(cursor.get(), SymbolEnum::LBRACK) && expect(cursor.get(1), SymbolEnum::RBRACK)) {
             dims.push_back(0);
-            if (node->nextChild(2, false)) {
-                while (expect(*node->getChildIter(), SymbolEnum::LBRACK) && expect(*node->getChildIter(2), SymbolEnum::RBRACK)) {
-                    int dim = constExp<IntType>(*node->getChildIter(1));
+            if (cursor.next(2, false)) {
+                while (expect(cursor.get(), SymbolEnum::LBRACK) && expect(cursor.get(2), SymbolEnum::RBRACK)) {
+                    int dim = constExp<IntType>(cursor.get(1));
                     if (dim >= 0) {
                         dims.push_back(static_cast<size_t>(dim));
                     } else {
                         Logger::logError("Use dimension as negative size!");
                     }
-                    if (!node->nextChild(3, false)) break; // jump '[dim]'
+                    if (!cursor.next(3, false)) break; // jump '[dim]'
                 }
             }
         }
@@ -862,21 +949,21 @@ SymbolTableItem* Visitor::funcFParam(std::shared_ptr<VNodeBase> node) {
     bool valid = true;
     if (type == ValueTypeEnum::INT_TYPE) {
         if (dims.size() == 0) {
-            auto res = m_table.insertItem<VarItem<IntType>>(identName, {nullptr, 0});
+            auto res = m_table.insertItem<VarItem<IntType>>(leafNode->getToken(), {nullptr, 0});
             ret = res.first;
             valid = res.second;
         } else {
-            auto res = m_table.insertItem<VarItem<ArrayType<IntType>>>(identName, {{{{}, dims}}, {{{}, dims}}, false});
+            auto res = m_table.insertItem<VarItem<ArrayType<IntType>>>(leafNode->getToken(), {{{{}, dims}}, {{{}, dims}}, false});
             ret = res.first;
             valid = res.second;
         }
     } else if (type == ValueTypeEnum::CHAR_TYPE) {
         if (dims.size() == 0) {
-            auto res = m_table.insertItem<VarItem<CharType>>(identName, {nullptr, 0});
+            auto res = m_table.insertItem<VarItem<CharType>>(leafNode->getToken(), {nullptr, 0});
             ret = res.first;
             valid = res.second;
         } else {
-            auto res = m_table.insertItem<VarItem<ArrayType<CharType>>>(identName, {{{{}, dims}}, {{{}, dims}}, false});
+            auto res = m_table.insertItem<VarItem<ArrayType<CharType>>>(leafNode->getToken(), {{{{}, dims}}, {{{}, dims}}, false});
             ret = res.first;
             valid = res.second;
         }
@@ -888,171 +975,173 @@ SymbolTableItem* Visitor::funcFParam(std::shared_ptr<VNodeBase> node) {
     return ret;
 }
 
-void Visitor::block(std::shared_ptr<VNodeBase> node) {
-    node->nextChild(); // jump '{'
-    while (expect(*node->getChildIter(), VNodeEnum::BLOCKITEM)) {
-        blockItem(*node->getChildIter());
-        node->nextChild();
+void Visitor::block(VNodeBase* node) {
+    VNodeCursor cursor(node);
+    cursor.next(); // jump '{'
+    while (expect(cursor.get(), VNodeEnum::BLOCKITEM)) {
+        blockItem(cursor.get());
+        cursor.next();
     }
-    int lineNum = std::dynamic_pointer_cast<VNodeLeaf>(*node->getChildIter())->getToken().lineNum;
+    int lineNum = dynamic_cast<VNodeLeaf*>(cursor.get())->getToken().lineNum;
     if (m_table.getCurrentScope().getType() == BlockScopeType::FUNC) {
         if (m_table.getCurrentScope().getFuncItem()->getReturnValueType() != ValueTypeEnum::VOID_TYPE) {
             m_table.getCurrentScope().checkFuncScopeReturn(lineNum);
         }
     }
-    // node->nextChild(); // jump '}'
+    // cursor.next(); // jump '}'
 }
 
-void Visitor::blockItem(std::shared_ptr<VNodeBase> node) {
-    if (expect(*node->getChildIter(), VNodeEnum::DECL)) {
-        decl(*node->getChildIter());
+void Visitor::blockItem(VNodeBase* node) {
+    if (expect(node->getChild(0), VNodeEnum::DECL)) {
+        decl(node->getChild(0));
     } else {
-        stmt(*node->getChildIter());
+        stmt(node->getChild(0));
     }
 }
 
-void Visitor::stmt(std::shared_ptr<VNodeBase> node) {
-    if (expect(*node->getChildIter(), SymbolEnum::IFTK)) { // if
-        node->nextChild(2);                                // jump  IFTK & '('
+void Visitor::stmt(VNodeBase* node) {
+    VNodeCursor cursor(node);
+    if (expect(cursor.get(), SymbolEnum::IFTK)) { // if
+        cursor.next(2);                           // jump  IFTK & '('
 
         /*---------------------------------codegen------------------------------------*/
         auto then = new BasicBlock();
         auto els = new BasicBlock();
         auto end = new BasicBlock();
-        auto cnd = cond(*node->getChildIter());
-        m_ctx.basicBlock->pushBackInst(new BranchInst(cnd, then, els));
-        m_ctx.basicBlock = m_ctx.function->pushBackBasicBlock(then);
-        node->nextChild(2); // jump COND ')'
+        auto cnd = cond(cursor.get());
+        m_builder.basicBlock->pushBackInst(new BranchInst(cnd, then, els));
+        m_builder.basicBlock = m_builder.function->pushBackBasicBlock(then);
+        cursor.next(2); // jump COND ')'
         m_table.pushScope(BlockScopeType::BRANCH);
-        stmt(*node->getChildIter());
+        stmt(cursor.get());
         m_table.popScope();
-        node->nextChild(1, false); // jump STMT
-        if (!m_ctx.basicBlock->valid()) {
-            m_ctx.basicBlock->pushBackInst(new JumpInst(end));
+        cursor.next(1, false); // jump STMT
+        if (!m_builder.basicBlock->valid()) {
+            m_builder.basicBlock->pushBackInst(new JumpInst(end));
         }
-        m_ctx.basicBlock = m_ctx.function->pushBackBasicBlock(els);
-        if (expect(*node->getChildIter(), SymbolEnum::ELSETK)) {
-            node->nextChild(); // jump ELSETK
+        m_builder.basicBlock = m_builder.function->pushBackBasicBlock(els);
+        if (expect(cursor.get(), SymbolEnum::ELSETK)) {
+            cursor.next(); // jump ELSETK
             m_table.pushScope(BlockScopeType::BRANCH);
-            stmt(*node->getChildIter());
+            stmt(cursor.get());
             m_table.popScope();
-            node->nextChild(1, false); // jump STMT
+            cursor.next(1, false); // jump STMT
 
             /*----------------------------------------------------------------------------*/
         }
-        if (!m_ctx.basicBlock->valid()) {
-            m_ctx.basicBlock->pushBackInst(new JumpInst(end));
+        if (!m_builder.basicBlock->valid()) {
+            m_builder.basicBlock->pushBackInst(new JumpInst(end));
         }
-        m_ctx.basicBlock = m_ctx.function->pushBackBasicBlock(end);
-    } else if (expect(*node->getChildIter(), SymbolEnum::WHILETK)) {
-        node->nextChild(2); // jump WHILE & '('
+        m_builder.basicBlock = m_builder.function->pushBackBasicBlock(end);
+    } else if (expect(cursor.get(), SymbolEnum::WHILETK)) {
+        cursor.next(2); // jump WHILE & '('
 
         /*---------------------------------codegen------------------------------------*/
         auto cndBB = new BasicBlock();
         auto loop = new BasicBlock();
         auto end = new BasicBlock();
-        m_ctx.basicBlock->pushBackInst(new JumpInst(cndBB)); // 跳转控制块
+        m_builder.basicBlock->pushBackInst(new JumpInst(cndBB)); // 跳转控制块
         // cndBB
-        m_ctx.basicBlock = m_ctx.function->pushBackBasicBlock(cndBB);
-        auto cnd = cond(*node->getChildIter());
-        m_ctx.basicBlock->pushBackInst(new BranchInst(cnd, loop, end)); // 跳转循环块
+        m_builder.basicBlock = m_builder.function->pushBackBasicBlock(cndBB);
+        auto cnd = cond(cursor.get());
+        m_builder.basicBlock->pushBackInst(new BranchInst(cnd, loop, end)); // 跳转循环块
         // loop
-        m_ctx.basicBlock = m_ctx.function->pushBackBasicBlock(loop);
-        m_ctx.loopStk.emplace_back(cndBB, end); // continue, break
-        node->nextChild(2);
+        m_builder.basicBlock = m_builder.function->pushBackBasicBlock(loop);
+        m_builder.loopStk.emplace_back(cndBB, end); // continue, break
+        cursor.next(2);
         m_table.pushScope(BlockScopeType::LOOP);
-        stmt(*node->getChildIter());
-        m_ctx.loopStk.pop_back();
+        stmt(cursor.get());
+        m_builder.loopStk.pop_back();
         m_table.popScope();
-        node->nextChild(1, false); // jump STMT
-        m_ctx.basicBlock->pushBackInst(new JumpInst(cndBB));
+        cursor.next(1, false); // jump STMT
+        m_builder.basicBlock->pushBackInst(new JumpInst(cndBB));
         // end
-        m_ctx.basicBlock = m_ctx.function->pushBackBasicBlock(end);
+        m_builder.basicBlock = m_builder.function->pushBackBasicBlock(end);
         /*----------------------------------------------------------------------------*/
-    } else if (expect(*node->getChildIter(), SymbolEnum::FORTK)) { // 'for' '(' blockItem ';' cond ';' stmt')' stmt
-        node->nextChild(2);                                        // jump FOR & '('
-        blockItem(*node->getChildIter());
-        node->nextChild(2); // jump blockItem & ';'
+    } else if (expect(cursor.get(), SymbolEnum::FORTK)) { // 'for' '(' blockItem ';' cond ';' stmt')' stmt
+        cursor.next(2);                                   // jump FOR & '('
+        blockItem(cursor.get());
+        cursor.next(2); // jump blockItem & ';'
         /*---------------------------------codegen------------------------------------*/
         auto cndBB = new BasicBlock();
         auto loop = new BasicBlock();
         auto increment = new BasicBlock();
         auto end = new BasicBlock();
-        m_ctx.basicBlock->pushBackInst(new JumpInst(cndBB)); // 跳转控制块
+        m_builder.basicBlock->pushBackInst(new JumpInst(cndBB)); // 跳转控制块
         // cndBB
-        m_ctx.basicBlock = m_ctx.function->pushBackBasicBlock(cndBB);
-        auto cnd = cond(*node->getChildIter());
-        m_ctx.basicBlock->pushBackInst(new BranchInst(cnd, loop, end)); // 跳转循环块
+        m_builder.basicBlock = m_builder.function->pushBackBasicBlock(cndBB);
+        auto cnd = cond(cursor.get());
+        m_builder.basicBlock->pushBackInst(new BranchInst(cnd, loop, end)); // 跳转循环块
         // loop
-        m_ctx.basicBlock = m_ctx.function->pushBackBasicBlock(loop);
-        m_ctx.loopStk.emplace_back(increment, end); // continue, break
-        node->nextChild(2);                         // jump COND & ';'
-        auto incrementStmtNode = *node->getChildIter();
+        m_builder.basicBlock = m_builder.function->pushBackBasicBlock(loop);
+        m_builder.loopStk.emplace_back(increment, end); // continue, break
+        cursor.next(2);                             // jump COND & ';'
+        auto incrementStmtNode = cursor.get();
         m_table.pushScope(BlockScopeType::LOOP);
-        stmt(*node->getChildIter(2)); // stmt outside
-        m_ctx.loopStk.pop_back();
+        stmt(cursor.get(2)); // stmt outside
+        m_builder.loopStk.pop_back();
         m_table.popScope();
-        node->nextChild(2, false);                               // jump STMT
-        m_ctx.basicBlock->pushBackInst(new JumpInst(increment)); // 跳转自增块
-        m_ctx.basicBlock = m_ctx.function->pushBackBasicBlock(increment);
+        cursor.next(2, false);                                   // jump STMT
+        m_builder.basicBlock->pushBackInst(new JumpInst(increment)); // 跳转自增块
+        m_builder.basicBlock = m_builder.function->pushBackBasicBlock(increment);
         stmt(incrementStmtNode);
-        m_ctx.basicBlock->pushBackInst(new JumpInst(cndBB)); // 跳转控制块
+        m_builder.basicBlock->pushBackInst(new JumpInst(cndBB)); // 跳转控制块
         // end
-        m_ctx.basicBlock = m_ctx.function->pushBackBasicBlock(end);
+        m_builder.basicBlock = m_builder.function->pushBackBasicBlock(end);
         /*----------------------------------------------------------------------------*/
-    } else if (expect(*node->getChildIter(), SymbolEnum::BREAKTK)) {
-        auto leafNode = std::dynamic_pointer_cast<VNodeLeaf>(*node->getChildIter());
+    } else if (expect(cursor.get(), SymbolEnum::BREAKTK)) {
+        auto leafNode = dynamic_cast<VNodeLeaf*>(cursor.get());
         if (!m_table.getCurrentScope().isSubLoopScope()) {
             Logger::logError(ErrorType::BRK_CONT_NOT_IN_LOOP, leafNode->getToken().lineNum);
         } else {
             /*---------------------------------codegen------------------------------------*/
-            m_ctx.basicBlock->pushBackInst(new JumpInst(m_ctx.loopStk.back().second));
+            m_builder.basicBlock->pushBackInst(new JumpInst(m_builder.loopStk.back().second));
             /*----------------------------------------------------------------------------*/
         }
-        node->nextChild(); // jump BREAKTK
-    } else if (expect(*node->getChildIter(), SymbolEnum::CONTINUETK)) {
-        auto leafNode = std::dynamic_pointer_cast<VNodeLeaf>(*node->getChildIter());
+        cursor.next(); // jump BREAKTK
+    } else if (expect(cursor.get(), SymbolEnum::CONTINUETK)) {
+        auto leafNode = dynamic_cast<VNodeLeaf*>(cursor.get());
         if (!m_table.getCurrentScope().isSubLoopScope()) {
             Logger::logError(ErrorType::BRK_CONT_NOT_IN_LOOP, leafNode->getToken().lineNum);
         } else {
             /*---------------------------------codegen------------------------------------*/
-            m_ctx.basicBlock->pushBackInst(new JumpInst(m_ctx.loopStk.back().first));
+            m_builder.basicBlock->pushBackInst(new JumpInst(m_builder.loopStk.back().first));
             /*----------------------------------------------------------------------------*/
         }
-        node->nextChild(); // jump CONTINUETK
-    } else if (expect(*node->getChildIter(), SymbolEnum::RETURNTK)) {
+        cursor.next(); // jump CONTINUETK
+    } else if (expect(cursor.get(), SymbolEnum::RETURNTK)) {
         m_table.getCurrentScope().markHasReturn();
-        auto leafNode = std::dynamic_pointer_cast<VNodeLeaf>(*node->getChildIter());
-        node->nextChild(); // jump RETURNTK
+        auto leafNode = dynamic_cast<VNodeLeaf*>(cursor.get());
+        cursor.next(); // jump RETURNTK
         FuncItem* funcItem = m_table.getCurrentScope().getFuncItem();
         if (funcItem) {
             ValueTypeEnum type = funcItem->getReturnValueType();
             auto& funcName = funcItem->getName();
             int lineNum = leafNode->getToken().lineNum;
             Value* ret = nullptr;
-            if (expect(*node->getChildIter(), VNodeEnum::EXP)) {
+            if (expect(cursor.get(), VNodeEnum::EXP)) {
                 if (type == ValueTypeEnum::VOID_TYPE) {
                     Logger::logError(ErrorType::VOID_FUNC_HAVE_RETURNED, lineNum, funcName);
                 } else if (type == ValueTypeEnum::INT_TYPE) {
-                    ret = exp<IntType>(*node->getChildIter())->getIrValue();
+                    ret = exp<IntType>(cursor.get()).value;
                 } else {
-                    ret = exp<CharType>(*node->getChildIter())->getIrValue();
+                    ret = exp<CharType>(cursor.get()).value;
                 }
-                node->nextChild(); // jump EXP
+                cursor.next(); // jump EXP
             }
             /*---------------------------------codegen------------------------------------*/
-            m_ctx.basicBlock->pushBackInst(new ReturnInst(ret));
+            m_builder.basicBlock->pushBackInst(new ReturnInst(ret));
             /*----------------------------------------------------------------------------*/
         }
 
-    } else if (expect(*node->getChildIter(), SymbolEnum::PRINTFTK)) {
-        node->nextChild(2); // jump PRINTTK & '('
-        auto leafNode = std::dynamic_pointer_cast<VNodeLeaf>(*node->getChildIter());
-        node->nextChild(); // jump STRCON
-        std::string formatStr = leafNode->getToken().literal;
+    } else if (expect(cursor.get(), SymbolEnum::PRINTFTK)) {
+        cursor.next(2); // jump PRINTTK & '('
+        auto leafNode = dynamic_cast<VNodeLeaf*>(cursor.get());
+        cursor.next(); // jump STRCON
+        std::string formatStr = leafNode->getToken().getLiteral();
         if (formatStr == "\"\"\"\"") return;
         int lineNum = leafNode->getToken().lineNum;
-        int count = 0;
+        std::vector<Value*>::size_type count = 0;
         std::string sub = "%d";
         for (size_t offset = formatStr.find(sub); offset != std::string::npos;
              offset = formatStr.find(sub, offset + 2)) {
@@ -1062,11 +1151,11 @@ void Visitor::stmt(std::shared_ptr<VNodeBase> node) {
         std::vector<bool> place;
         replaceAll(formatStr, "\"", "");
         splitFormatString(formatStr, parts, place);
-        std::vector<SymbolTableItem*> items;
-        while (expect(*node->getChildIter(), SymbolEnum::COMMA)) {
-            node->nextChild();                                    // jump ','
-            items.push_back(exp<IntType>(*node->getChildIter())); // Char 是不能被%d打印的, 如果需要%c则按照顺序进行模板实例化即可
-            node->nextChild();                                    // jump EXP
+        std::vector<Value*> items;
+        while (expect(cursor.get(), SymbolEnum::COMMA)) {
+            cursor.next();                               // jump ','
+            items.push_back(exp<IntType>(cursor.get()).value); // Char 是不能被%d打印的, 如果需要%c则按照顺序进行模板实例化即可
+            cursor.next();                               // jump EXP
         }
         if (items.size() != count) {
             Logger::logError(ErrorType::PRINTF_UMATCHED, lineNum, std::to_string(items.size()), std::to_string(count));
@@ -1079,168 +1168,153 @@ void Visitor::stmt(std::shared_ptr<VNodeBase> node) {
             int strCnt = 0;
             for (auto isStr : place) {
                 if (isStr) {
-                    strParts.push_back(m_ctx.module.addStrVar(parts[strCnt++]));
+                    m_builder.strVars.emplace_back(new StringVariable("", parts[strCnt++]));
+                    strParts.push_back(m_builder.strVars.back().get());
                 } else {
                     strParts.push_back(nullptr);
                 }
             }
-            for (auto& item : items) {
-                args.push_back(item->getIrValue());
-            }
-            m_ctx.basicBlock->pushBackInst(new PrintInst(strParts, args));
+            m_builder.basicBlock->pushBackInst(new PrintInst(strParts, items));
             /*----------------------------------------------------------------------------*/
         }
-    } else if (expect(*node->getChildIter(), VNodeEnum::LVAL)) {
-        auto lValItem = lVal(*node->getChildIter());
+    } else if (expect(cursor.get(), VNodeEnum::LVAL)) {
+        auto lValRes = lVal(cursor.get());
+        auto lValItem = lValRes.first;
         if (lValItem) {
-            node->nextChild(2); // jump lVal & =
+            cursor.next(2); // jump lVal & =
             auto type = lValItem->getType()->getValueTypeEnum();
-            SymbolTableItem* ret = nullptr;
-            if (expect(*node->getChildIter(), SymbolEnum::GETINTTK)) {
-                ret = MAKE_INT_VAR();
+            Value* ret = nullptr;
+            if (expect(cursor.get(), SymbolEnum::GETINTTK)) {
                 // TODO: 生成将此通过getint获取值的代码
                 /*---------------------------------codegen------------------------------------*/
-                auto inst = m_ctx.basicBlock->pushBackInst(new CallInst(IrModule::getBuiltinFunc("getint"), {}));
-                ret->setIrValue(inst);
+                ret = m_builder.basicBlock->pushBackInst(new CallInst(m_ctx.module.getBuiltinFunc("getint"), {}));
                 /*----------------------------------------------------------------------------*/
             } else {
                 if (type == ValueTypeEnum::INT_TYPE) {
-                    ret = exp<IntType>(*node->getChildIter());
+                    ret = exp<IntType>(cursor.get()).value;
                 } else {
-                    ret = exp<CharType>(*node->getChildIter());
+                    ret = exp<CharType>(cursor.get()).value;
                 }
             }
             // TODO: 生成将暂存值存入左值的代码
             /*---------------------------------codegen------------------------------------*/
-            m_ctx.basicBlock->pushBackInst(new StoreInst(lValItem, lValItem->getIrValue(), ret->getIrValue(), ConstValue::get(0)));
+            m_builder.basicBlock->pushBackInst(new StoreInst(lValItem, lValRes.second, ret, m_ctx.module.getConst(0)));
             /*----------------------------------------------------------------------------*/
         }
-    } else if (expect(*node->getChildIter(), VNodeEnum::BLOCK)) {
+    } else if (expect(cursor.get(), VNodeEnum::BLOCK)) {
         m_table.pushScope(BlockScopeType::NORMAL);
-        block(*node->getChildIter());
+        block(cursor.get());
         m_table.popScope();
-    } else if (expect(*node->getChildIter(), VNodeEnum::EXP)) {
-        exp<IntType>(*node->getChildIter());
+    } else if (expect(cursor.get(), VNodeEnum::EXP)) {
+        exp<IntType>(cursor.get());
     } else {
         Logger::logWarning("Empty statement or double semicolon.");
     }
 }
 
-SymbolTableItem* Visitor::lVal(std::shared_ptr<VNodeBase> node) {
-    auto identNode = std::dynamic_pointer_cast<VNodeLeaf>(*node->getChildIter()); // lVal 的第一个子节点ident
-    std::string identName = identNode->getToken().literal;
+std::pair<SymbolTableItem*, Value*> Visitor::lVal(VNodeBase* node) {
+    VNodeCursor cursor(node);
+    auto identNode = dynamic_cast<VNodeLeaf*>(cursor.get()); // lVal 的第一个子节点ident
+    const std::string& identName = identNode->getToken().getLiteral();
     int lineNum = identNode->getToken().lineNum;
-    auto finded = m_table.findItem(identName);
+    auto finded = m_table.findItem(identNode->getToken());
     if (finded) {
         if (!finded->isChangble()) {
             Logger::logError(ErrorType::ASSIGN_TO_CONST, lineNum, identName);
         }
         if (!finded->getType()->isArray()) {
-            return finded;
+            return {finded, irValue(finded)};
         } else {
-            auto type = finded->getType()->getValueTypeEnum();
             std::vector<size_t> targetDims = getArrayItemDimensions(finded);
-            SymbolTableItem* lVal = makeTempItem(type);
 
-            std::vector<SymbolTableItem*> pos;
-            node->nextChild(1, false); // jump IDENT
-            while (expect(*node->getChildIter(), SymbolEnum::LBRACK) && expect(*node->getChildIter(2), SymbolEnum::RBRACK)) {
-                pos.push_back(exp<IntType>(*node->getChildIter(1)));
-                if (!node->nextChild(3, false)) break; // jump '[pos]'
+            std::vector<Value*> pos;
+            cursor.next(1, false); // jump IDENT
+            while (expect(cursor.get(), SymbolEnum::LBRACK) && expect(cursor.get(2), SymbolEnum::RBRACK)) {
+                pos.push_back(exp<IntType>(cursor.get(1)).value);
+                if (!cursor.next(3, false)) break; // jump '[pos]'
             }
 
             if (pos.size() != targetDims.size()) { // 如果维数不匹配则不是单个的数组元素，不能成为lVal
                 Logger::logError("Can not convert a array to variable!");
-                return nullptr;
+                return {nullptr, nullptr};
             } else {
                 std::vector<size_t> accDims = calAccDimensions(targetDims);
                 /*---------------------------------codegen------------------------------------*/
-                Inst* inst = nullptr;
-                Value* arr = finded->getIrValue();
+                Value* arr = irValue(finded);
                 for (int i = 0; i < targetDims.size(); i++) {
-                    inst = m_ctx.basicBlock->pushBackInst(new GetElementPtrInst(lVal, arr, pos[i]->getIrValue(), accDims[i]));
-                    arr = inst;
+                    arr = m_builder.basicBlock->pushBackInst(new GetElementPtrInst(finded, arr, pos[i], accDims[i]));
                 }
-                lVal->setIrValue(inst);
                 /*----------------------------------------------------------------------------*/
+                return {finded, arr};
             }
-            return lVal;
         }
     } else {
         Logger::logError(ErrorType::UNDECL_IDENT, lineNum, identName);
-        return nullptr;
+        return {nullptr, nullptr};
     }
 }
 
 template <typename Type>
-SymbolTableItem* Visitor::rVal(std::shared_ptr<VNodeBase> node) {
+ExpValue Visitor::rVal(VNodeBase* node) {
+    VNodeCursor cursor(node);
     auto res = calConstExp<Type>(node);
     if (res.second) {
-        auto item = m_table.makeItem<ConstVarItem<Type>>(res.first);
-        item->setIrValue(ConstValue::get(res.first));
-        return item;
+        return makeConstValue<Type>(res.first);
     } else {
-        node->resetIter();
-        auto identNode = std::dynamic_pointer_cast<VNodeLeaf>(*node->getChildIter()); // lVal 的第一个子节点ident
-        std::string identName = identNode->getToken().literal;
+        auto identNode = dynamic_cast<VNodeLeaf*>(cursor.get()); // lVal 的第一个子节点ident
+        const std::string& identName = identNode->getToken().getLiteral();
         int lineNum = identNode->getToken().lineNum;
-        auto finded = m_table.findItem(identName);
+        auto finded = m_table.findItem(identNode->getToken());
         if (finded) {
             auto type = finded->getType()->getValueTypeEnum();
             bool findedIsArray = finded->getType()->isArray();
             if (!findedIsArray) {
                 /*---------------------------------codegen------------------------------------*/
-                auto inst = m_ctx.basicBlock->pushBackInst(new LoadInst(finded, finded->getIrValue(), ConstValue::get(0)));
-                auto temp = makeTempItem(type);
-                temp->setIrValue(inst);
+                auto inst = m_builder.basicBlock->pushBackInst(new LoadInst(finded, irValue(finded), m_ctx.module.getConst(0)));
                 /*----------------------------------------------------------------------------*/
-                return temp;
+                return {inst, type};
             } else {
                 // 符号表中存储的数组的维数
 
                 std::vector<size_t> targetDims = getArrayItemDimensions(finded);
-                SymbolTableItem* ret = nullptr;
+                ExpValue ret;
                 // 实际读取到的右值
-                std::vector<SymbolTableItem*> pos;
-                node->nextChild(1, false); // jump IDENT
-                while (expect(*node->getChildIter(), SymbolEnum::LBRACK) && expect(*node->getChildIter(2), SymbolEnum::RBRACK)) {
-                    pos.push_back(exp<IntType>(*node->getChildIter(1)));
-                    if (!node->nextChild(3, false)) break; // jump '[pos]'
+                std::vector<Value*> pos;
+                cursor.next(1, false); // jump IDENT
+                while (expect(cursor.get(), SymbolEnum::LBRACK) && expect(cursor.get(2), SymbolEnum::RBRACK)) {
+                    pos.push_back(exp<IntType>(cursor.get(1)).value);
+                    if (!cursor.next(3, false)) break; // jump '[pos]'
                 }
                 // 没有指定ele直接返回数组本身
                 if (pos.empty()) {
                     /*---------------------------------codegen------------------------------------*/
-                    auto inst = m_ctx.basicBlock->pushBackInst(new GetElementPtrInst(finded, finded->getIrValue(), ConstValue::get(0), 0));
-                    auto temp = makeTempItem(type, true, std::move(targetDims));
-                    temp->setIrValue(inst);
-                    return temp;
+                    auto inst = m_builder.basicBlock->pushBackInst(new GetElementPtrInst(finded, irValue(finded), m_ctx.module.getConst(0), 0));
+                    return {inst, type, std::move(targetDims)};
                     /*----------------------------------------------------------------------------*/
                 } else {
                     int diff = targetDims.size() - pos.size();
                     std::vector<size_t> accDims = calAccDimensions(targetDims);
                     Inst* inst = nullptr;
-                    Value* arr = finded->getIrValue();
+                    Value* arr = irValue(finded);
                     if (diff > 0) { // 维数不匹配，需要剪裁成部分数组
                         std::vector<size_t> sliceDims(targetDims.begin(), targetDims.begin() + diff);
-                        ret = makeTempItem(type, true, std::move(sliceDims));
                         // TODO: 生成sliceArray的代码
                         /*---------------------------------codegen------------------------------------*/
                         for (int i = 0; i < sliceDims.size(); i++) {
-                            inst = m_ctx.basicBlock->pushBackInst(new GetElementPtrInst(finded, arr, pos[i]->getIrValue(), accDims[i]));
+                            inst = m_builder.basicBlock->pushBackInst(new GetElementPtrInst(finded, arr, pos[i], accDims[i]));
                             arr = inst;
                         }
-                        ret->setIrValue(inst);
+                        ret = ExpValue(inst, type, std::move(sliceDims));
                         /*----------------------------------------------------------------------------*/
                     } else if (diff == 0) { // 维数匹配，返回原数组的对应的元素
-                        ret = makeTempItem(type);
                         // TODO: 生成返回一个元素的代码
                         /*---------------------------------codegen------------------------------------*/
                         for (int i = 0; i < targetDims.size(); i++) {
-                            inst = m_ctx.basicBlock->pushBackInst(new GetElementPtrInst(finded, arr, pos[i]->getIrValue(), accDims[i]));
+                            inst = m_builder.basicBlock->pushBackInst(new GetElementPtrInst(finded, arr, pos[i], accDims[i]));
                             arr = inst;
                         }
-                        inst = m_ctx.basicBlock->pushBackInst(new LoadInst(ret, arr, ConstValue::get(0)));
-                        ret->setIrValue(inst);
+                        inst = m_builder.basicBlock->pushBackInst(new LoadInst(finded, arr, m_ctx.module.getConst(0)));
+                        ret = ExpValue(inst, type);
                         /*----------------------------------------------------------------------------*/
                     } else {
                         Logger::logError("Variable dimension do not match!");
@@ -1250,42 +1324,43 @@ SymbolTableItem* Visitor::rVal(std::shared_ptr<VNodeBase> node) {
             }
         } else {
             Logger::logError(ErrorType::UNDECL_IDENT, lineNum, identName);
-            return nullptr;
+            return {};
         }
     }
 }
 
-Value* Visitor::cond(std::shared_ptr<VNodeBase> node) {
-    return lOrExp<IntType>(*node->getChildIter());
+Value* Visitor::cond(VNodeBase* node) {
+    return lOrExp<IntType>(node->getChild(0));
 }
 
 template <typename Type>
-Value* Visitor::lOrExp(std::shared_ptr<VNodeBase> node) {
-    if (expect(*node->getChildIter(), VNodeEnum::LANDEXP)) {
-        return lAndExp<Type>(*node->getChildIter());
+Value* Visitor::lOrExp(VNodeBase* node) {
+    VNodeCursor cursor(node);
+    if (expect(cursor.get(), VNodeEnum::LANDEXP)) {
+        return lAndExp<Type>(cursor.get());
     } else {
-        auto lhs = lOrExp<Type>(*node->getChildIter());
+        auto lhs = lOrExp<Type>(cursor.get());
         Value* rhs = nullptr;
-        node->nextChild();
-        SymbolEnum op = (*node->getChildIter())->getSymbol(); // get symbol of or
-        node->nextChild();
+        cursor.next();
+        SymbolEnum op = cursor.get()->getSymbol(); // get symbol of or
+        cursor.next();
 
         if (op == SymbolEnum::OR) {
             /*---------------------------------codegen------------------------------------*/
             auto rhsBB = new BasicBlock();
             auto afterBB = new BasicBlock();
-            auto inv = new BinaryInst(IRType::Eq, lhs, ConstValue::get(0));
-            m_ctx.basicBlock->pushBackInst(inv);
-            m_ctx.basicBlock->pushBackInst(new BranchInst(inv, rhsBB, afterBB));
-            m_ctx.basicBlock = m_ctx.function->pushBackBasicBlock(rhsBB);
-            rhs = lAndExp<Type>(*node->getChildIter());
+            auto inv = new BinaryInst(IRType::Eq, lhs, m_ctx.module.getConst(0));
+            m_builder.basicBlock->pushBackInst(inv);
+            m_builder.basicBlock->pushBackInst(new BranchInst(inv, rhsBB, afterBB));
+            m_builder.basicBlock = m_builder.function->pushBackBasicBlock(rhsBB);
+            rhs = lAndExp<Type>(cursor.get());
             afterBB->getPreds().resize(2);
-            m_ctx.basicBlock->pushBackInst(new JumpInst(afterBB));
-            m_ctx.basicBlock = m_ctx.function->pushBackBasicBlock(afterBB);
+            m_builder.basicBlock->pushBackInst(new JumpInst(afterBB));
+            m_builder.basicBlock = m_builder.function->pushBackBasicBlock(afterBB);
             auto phi = new PhiInst(afterBB);
             phi->getIncomingValues()[0].set(lhs);
             phi->getIncomingValues()[1].set(rhs);
-            auto inst = m_ctx.basicBlock->pushBackInst(phi);
+            auto inst = m_builder.basicBlock->pushBackInst(phi);
             return inst;
             /*----------------------------------------------------------------------------*/
         } else {
@@ -1296,34 +1371,35 @@ Value* Visitor::lOrExp(std::shared_ptr<VNodeBase> node) {
 }
 
 template <typename Type>
-Value* Visitor::lAndExp(std::shared_ptr<VNodeBase> node) {
-    if (expect(*node->getChildIter(), VNodeEnum::EQEXP)) {
-        auto eq = eqExp<Type>(*node->getChildIter());
-        return eq->getIrValue();
+Value* Visitor::lAndExp(VNodeBase* node) {
+    VNodeCursor cursor(node);
+    if (expect(cursor.get(), VNodeEnum::EQEXP)) {
+        auto eq = eqExp<Type>(cursor.get());
+        return eq.value;
         // TODO: 生成condition的代码
     } else {
-        auto lhs = lAndExp<Type>(*node->getChildIter());
+        auto lhs = lAndExp<Type>(cursor.get());
         Value* rhs = nullptr;
-        node->nextChild();
-        SymbolEnum op = (*node->getChildIter())->getSymbol(); // get symbol and
-        node->nextChild();
+        cursor.next();
+        SymbolEnum op = cursor.get()->getSymbol(); // get symbol and
+        cursor.next();
 
         // TODO: 生成condition的代码
         if (op == SymbolEnum::AND) {
             /*---------------------------------codegen------------------------------------*/
             auto rhsBB = new BasicBlock();
             auto afterBB = new BasicBlock();
-            m_ctx.basicBlock->pushBackInst(new BranchInst(lhs, rhsBB, afterBB));
-            m_ctx.basicBlock = m_ctx.function->pushBackBasicBlock(rhsBB);
-            auto eq = eqExp<Type>(*node->getChildIter());
-            rhs = eq->getIrValue();
+            m_builder.basicBlock->pushBackInst(new BranchInst(lhs, rhsBB, afterBB));
+            m_builder.basicBlock = m_builder.function->pushBackBasicBlock(rhsBB);
+            auto eq = eqExp<Type>(cursor.get());
+            rhs = eq.value;
             afterBB->getPreds().resize(2);
-            m_ctx.basicBlock->pushBackInst(new JumpInst(afterBB));
-            m_ctx.basicBlock = m_ctx.function->pushBackBasicBlock(afterBB);
+            m_builder.basicBlock->pushBackInst(new JumpInst(afterBB));
+            m_builder.basicBlock = m_builder.function->pushBackBasicBlock(afterBB);
             auto phi = new PhiInst(afterBB);
             phi->getIncomingValues()[0].set(lhs);
             phi->getIncomingValues()[1].set(rhs);
-            auto inst = m_ctx.basicBlock->pushBackInst(phi);
+            auto inst = m_builder.basicBlock->pushBackInst(phi);
             return inst;
             /*----------------------------------------------------------------------------*/
         } else {
@@ -1334,93 +1410,67 @@ Value* Visitor::lAndExp(std::shared_ptr<VNodeBase> node) {
 }
 
 template <typename Type>
-SymbolTableItem* Visitor::eqExp(std::shared_ptr<VNodeBase> node) {
+ExpValue Visitor::eqExp(VNodeBase* node) {
+    VNodeCursor cursor(node);
     auto res = calConstExp<Type>(node);
     if (res.second) {
-        auto item = m_table.makeItem<ConstVarItem<Type>>(res.first);
-        item->setIrValue(ConstValue::get(res.first));
-        return item;
+        return makeConstValue<Type>(res.first);
     } else {
-        node->resetIter();
-        if (expect(*node->getChildIter(), VNodeEnum::RELEXP)) {
-            return relExp<Type>(*node->getChildIter());
+        if (expect(cursor.get(), VNodeEnum::RELEXP)) {
+            return relExp<Type>(cursor.get());
         } else {
-            auto eq = eqExp<Type>(*node->getChildIter());
-            node->nextChild();
-            SymbolEnum op = (*node->getChildIter())->getSymbol(); // get symbol of eql or neq
-            node->nextChild();
-            auto rel = relExp<Type>(*node->getChildIter());
-            auto ret = MAKE_VAR();
+            auto eq = eqExp<Type>(cursor.get());
+            cursor.next();
+            SymbolEnum op = cursor.get()->getSymbol(); // get symbol of eql or neq
+            cursor.next();
+            auto rel = relExp<Type>(cursor.get());
             /*---------------------------------codegen------------------------------------*/
             Value* inst = nullptr;
             if (op == SymbolEnum::EQL) {
-                inst = m_ctx.basicBlock->pushBackInst(new BinaryInst(IRType::Eq, eq->getIrValue(), rel->getIrValue()));
+                inst = m_builder.basicBlock->pushBackInst(new BinaryInst(IRType::Eq, eq.value, rel.value));
             } else if (op == SymbolEnum::NEQ) {
-                inst = m_ctx.basicBlock->pushBackInst(new BinaryInst(IRType::Ne, eq->getIrValue(), rel->getIrValue()));
+                inst = m_builder.basicBlock->pushBackInst(new BinaryInst(IRType::Ne, eq.value, rel.value));
             } else {
                 DBG_ERROR("Equal expression only accept '==' & '!='!");
-                return nullptr;
+                return {};
             }
-            ret->setIrValue(inst);
             /*----------------------------------------------------------------------------*/
-            return ret;
+            return makeVarValue<Type>(inst);
         }
     }
 }
 
 template <typename Type>
-SymbolTableItem* Visitor::relExp(std::shared_ptr<VNodeBase> node) {
+ExpValue Visitor::relExp(VNodeBase* node) {
+    VNodeCursor cursor(node);
     auto res = calConstExp<Type>(node);
     if (res.second) {
-        auto item = m_table.makeItem<ConstVarItem<Type>>(res.first);
-        item->setIrValue(ConstValue::get(res.first));
-        return item;
+        return makeConstValue<Type>(res.first);
     } else {
-        node->resetIter();
-        if (expect(*node->getChildIter(), VNodeEnum::ADDEXP)) {
-            return addExp<Type>(*node->getChildIter());
+        if (expect(cursor.get(), VNodeEnum::ADDEXP)) {
+            return addExp<Type>(cursor.get());
         } else {
-            auto rel = relExp<Type>(*node->getChildIter());
-            node->nextChild();
-            SymbolEnum op = (*node->getChildIter())->getSymbol(); // get symbol of less and great
-            node->nextChild();
-            auto add = addExp<Type>(*node->getChildIter());
-            auto ret = MAKE_VAR();
+            auto rel = relExp<Type>(cursor.get());
+            cursor.next();
+            SymbolEnum op = cursor.get()->getSymbol(); // get symbol of less and great
+            cursor.next();
+            auto add = addExp<Type>(cursor.get());
             /*---------------------------------codegen------------------------------------*/
             Value* inst = nullptr;
             if (op == SymbolEnum::LSS) {
-                inst = m_ctx.basicBlock->pushBackInst(new BinaryInst(IRType::Lt, rel->getIrValue(), add->getIrValue()));
+                inst = m_builder.basicBlock->pushBackInst(new BinaryInst(IRType::Lt, rel.value, add.value));
             } else if (op == SymbolEnum::GRE) {
-                inst = m_ctx.basicBlock->pushBackInst(new BinaryInst(IRType::Gt, rel->getIrValue(), add->getIrValue()));
+                inst = m_builder.basicBlock->pushBackInst(new BinaryInst(IRType::Gt, rel.value, add.value));
             } else if (op == SymbolEnum::LEQ) {
-                inst = m_ctx.basicBlock->pushBackInst(new BinaryInst(IRType::Le, rel->getIrValue(), add->getIrValue()));
+                inst = m_builder.basicBlock->pushBackInst(new BinaryInst(IRType::Le, rel.value, add.value));
             } else if (op == SymbolEnum::GEQ) {
-                inst = m_ctx.basicBlock->pushBackInst(new BinaryInst(IRType::Ge, rel->getIrValue(), add->getIrValue()));
+                inst = m_builder.basicBlock->pushBackInst(new BinaryInst(IRType::Ge, rel.value, add.value));
             } else {
                 DBG_ERROR("Relation expression only accept '<' & '>' & '<=' & '>='!");
-                return nullptr;
+                return {};
             }
-            ret->setIrValue(inst);
             /*----------------------------------------------------------------------------*/
-            return ret;
+            return makeVarValue<Type>(inst);
         }
     }
 }
-
-SymbolTableItem* Visitor::makeTempItem(ValueTypeEnum type, bool isArray, std::vector<size_t>&& dims) {
-    SymbolTableItem* ret = nullptr;
-    if (isArray) {
-        switch (type) {
-        case ValueTypeEnum::INT_TYPE: ret = MAKE_INT_ARRAY(dims); break;
-        case ValueTypeEnum::CHAR_TYPE: ret = MAKE_CHAR_ARRAY(dims); break;
-        case ValueTypeEnum::VOID_TYPE: break;
-        }
-    } else {
-        switch (type) {
-        case ValueTypeEnum::INT_TYPE: ret = MAKE_INT_VAR(); break;
-        case ValueTypeEnum::CHAR_TYPE: ret = MAKE_CHAR_VAR(); break;
-        case ValueTypeEnum::VOID_TYPE: break;
-        }
-    }
-    return ret;
-}
\ No newline at end of file
@@ -1,35 +1,38 @@
 #include <grammar/Parser.h>
 #include <Log.h>
 
-Parser::Parser(std::vector<Token>& tokenList) {
-    m_tokenList.emplace_back();
-    m_tokenList.insert(m_tokenList.end(), tokenList.begin(), tokenList.end());
-    m_currToken = m_tokenList.begin();
+Parser::Parser(TokenStream& tokenStream, VNodeArena& arena) :
+    m_tokens(tokenStream), m_astRoot(nullptr), m_stringPool(tokenStream.getStringPool()), m_arena(arena) {
+}
+
+void Parser::parseItems(const ItemHandler& handler) {
+    m_itemHandler = handler;
+    parse();
+    m_itemHandler = nullptr;
 }
 
 void Parser::parse() {
     m_astRoot = compUnit(0);
-    m_currToken++;
-    if (m_currToken != m_tokenList.end()) {
+    if (m_tokens.hasNext()) {
         Logger::logInfo("Token解析未完成");
     }
 }
 
-std::shared_ptr<VNodeBase> Parser::getASTRoot() const {
+VNodeBase* Parser::getASTRoot() const {
     return m_astRoot;
 }
 
 void Parser::traversalAST(std::filebuf& file) {
-    std::ostream os(&file);
+    DumpWriter os(&file);
     //postTraversal(m_astRoot, os);
     preTraversal(m_astRoot, os);
 }
 
-void Parser::postTraversal(std::shared_ptr<VNodeBase> node, std::ostream& os) {
+void Parser::postTraversal(VNodeBase* node, DumpWriter& os) {
     if (node->getType() == VType::VN) {
-        auto branch = std::static_pointer_cast<VNodeBranch>(node);
+        auto branch = static_cast<VNodeBranch*>(node);
         auto children = branch->getChildren();
-        for (auto& child : children) {
+        for (auto child : children) {
             postTraversal(child, os);
         }
         if (!(branch->getNodeEnum() == VNodeEnum::DECL
@@ -38,170 +41,220 @@ void Parser::postTraversal(std::shared_ptr<VNodeBase> node, std::ostream& os) {
             branch->dumpToFile(os);
         }
     } else {
-        auto leaf = std::static_pointer_cast<VNodeLeaf>(node);
+        auto leaf = static_cast<VNodeLeaf*>(node);
         leaf->dumpToFile(os);
     }
 }
 
-void Parser::preTraversal(std::shared_ptr<VNodeBase> node, std::ostream& os) {
+void Parser::preTraversal(VNodeBase* node, DumpWriter& os) {
     if (node->getType() == VType::VN) {
-        auto branch = std::static_pointer_cast<VNodeBranch>(node);
+        auto branch = static_cast<VNodeBranch*>(node);
         branch->dumpToFile(os);
         auto children = branch->getChildren();
-        for (auto& child : children) {
+        for (auto child : children) {
             postTraversal(child, os);
         }
     } else {
-        auto leaf = std::static_pointer_cast<VNodeLeaf>(node);
+        auto leaf = static_cast<VNodeLeaf*>(node);
         leaf->dumpToFile(os);
     }
 }
 
 // 期望获取symbol对应的内容，并返回生成的叶节点
-std::shared_ptr<VNodeBase> Parser::expect(SymbolEnum symbol, int level) {
-    if ((m_currToken + 1)->symbol == symbol) {
-        m_currToken++;
-        auto leaf = std::make_shared<VNodeLeaf>(symbol, *m_currToken);
+VNodeBase* Parser::expect(SymbolEnum symbol, int level) {
+    if (m_tokens.peek(1).symbol == symbol) {
+        m_tokens.advance();
+        auto leaf = m_arena.make<VNodeLeaf>(symbol, m_tokens.peek(0));
         leaf->setLevel(level);
         return leaf;
     } else {
-        std::string literal;
-        if (!m_probingMode) {
-            literal = handleGrammarError(symbol);
-        }
-        return std::make_shared<VNodeLeaf>(symbol, Token(m_currToken->lineNum, symbol, literal, 0), m_probingMode ? true : false); // 如果全是false会导致死循环，这么写会导致expect生成式的函数出错
+        std::string literal = handleGrammarError(symbol);
+        return m_arena.make<VNodeLeaf>(symbol, Token(m_tokens.peek(0).lineNum, symbol, m_stringPool, literal, 0), false);
     }
 }
 
 // 期望获取symbolList包含的内容，并返回生成的叶节点
-std::shared_ptr<VNodeBase> Parser::expect(std::initializer_list<SymbolEnum> symbolList, int level) {
+VNodeBase* Parser::expect(std::initializer_list<SymbolEnum> symbolList, int level) {
     std::set<SymbolEnum> symset(symbolList);
-    if (symset.count((m_currToken + 1)->symbol)) {
-        m_currToken++;
-        auto leaf = std::make_shared<VNodeLeaf>(m_currToken->symbol, *m_currToken);
+    if (symset.count(m_tokens.peek(1).symbol)) {
+        m_tokens.advance();
+        auto leaf = m_arena.make<VNodeLeaf>(m_tokens.peek(0).symbol, m_tokens.peek(0));
         leaf->setLevel(level);
         return leaf;
     } else {
-        std::string literal;
-        if (!m_probingMode) {
-            literal = handleGrammarError(m_currToken->symbol);
-        }
-        return std::make_shared<VNodeLeaf>(*symbolList.begin(),
-                                           Token(m_currToken->lineNum, *symbolList.begin(), literal, 0), m_probingMode ? true : false);
+        std::string literal = handleGrammarError(m_tokens.peek(0).symbol);
+        return m_arena.make<VNodeLeaf>(*symbolList.begin(),
+                                           Token(m_tokens.peek(0).lineNum, *symbolList.begin(), m_stringPool, literal, 0), false);
     }
 }
 
 std::string Parser::handleGrammarError(SymbolEnum symbol) {
     switch (symbol) {
     case SymbolEnum::SEMICN:
-        Logger::logError(ErrorType::MISSING_SEMICN, m_currToken->lineNum);
+        Logger::logError(ErrorType::MISSING_SEMICN, m_tokens.peek(0).lineNum);
         return ";";
     case SymbolEnum::RPARENT:
-        Logger::logError(ErrorType::MISSING_RPARENT, m_currToken->lineNum);
+        Logger::logError(ErrorType::MISSING_RPARENT, m_tokens.peek(0).lineNum);
         return ")";
     case SymbolEnum::RBRACK:
-        Logger::logError(ErrorType::MISSING_RBRACK, m_currToken->lineNum);
+        Logger::logError(ErrorType::MISSING_RBRACK, m_tokens.peek(0).lineNum);
         return "]";
     default: break;
     }
     return "";
 }
 
+// 语句是否为 lVal '=' ... 的形式: 向前扫描出lVal的范围, 再看其后是否是'='
 bool Parser::expectAssignment() {
-    auto iterBefore = m_currToken;
-    m_probingMode = true;
-    auto temp = lVal(-1);
-    if (temp->isCorrect()) {
-        bool correct = (m_currToken + 1)->symbol == SymbolEnum::ASSIGN;
-        m_currToken = iterBefore;
-        m_probingMode = false;
-        return correct;
-    } else {
-        m_currToken = iterBefore;
-        m_probingMode = false;
-        return false;
-    }
+    return m_tokens.peek(scanLVal(0) + 1).symbol == SymbolEnum::ASSIGN;
 }
+
+// 语句是否以表达式开头, 即exp能够读入至少一个token
+// 除了exp的FIRST集合外, 出错时'['(lVal)和'*' '/' '%'(mulExp)也会被exp读入
 bool Parser::expectPureExp() {
-    auto iterBefore = m_currToken;
-    m_probingMode = true;
-    auto temp = exp(-1);
-    m_probingMode = false;
-    if (temp->isCorrect() && m_currToken != iterBefore) {
-        m_currToken = iterBefore;
+    switch (m_tokens.peek(1).symbol) {
+    case SymbolEnum::IDENFR:
+    case SymbolEnum::INTCON:
+    case SymbolEnum::LPARENT:
+    case SymbolEnum::PLUS:
+    case SymbolEnum::MINU:
+    case SymbolEnum::NOT:
+    case SymbolEnum::LBRACK:
+    case SymbolEnum::MULT:
+    case SymbolEnum::DIV:
+    case SymbolEnum::MOD:
         return true;
-    } else {
-        m_currToken = iterBefore;
+    default:
         return false;
     }
 }
 
 bool Parser::expectUnaryOp() {
-    auto nextIter = m_currToken + 1;
-    return nextIter->symbol == SymbolEnum::PLUS
-           || nextIter->symbol == SymbolEnum::MINU
-           || nextIter->symbol == SymbolEnum::NOT;
-}
-
-bool Parser::expectFuncRParams() {
-    auto iterBefore = m_currToken;
-    m_probingMode = true;
-    funcRParams(-1);
-    m_probingMode = false;
-    if (m_currToken == iterBefore) {
-        return false;
+    auto symbol = m_tokens.peek(1).symbol;
+    return symbol == SymbolEnum::PLUS
+           || symbol == SymbolEnum::MINU
+           || symbol == SymbolEnum::NOT;
+}
+
+// scan系列函数不构造节点也不移动token流, 只计算对应的语法成分从offset之后会读到哪个位置
+// 与语法分析函数一致, 期望的token缺失时不前进
+int Parser::scanLVal(int offset) {
+    if (m_tokens.peek(offset + 1).symbol == SymbolEnum::IDENFR) {
+        offset++;
+    }
+    while (m_tokens.peek(offset + 1).symbol == SymbolEnum::LBRACK) {
+        offset = scanExp(offset + 1);
+        if (m_tokens.peek(offset + 1).symbol == SymbolEnum::RBRACK) {
+            offset++;
+        }
+    }
+    return offset;
+}
+
+int Parser::scanExp(int offset) {
+    offset = scanMulExp(offset);
+    for (auto symbol = m_tokens.peek(offset + 1).symbol;
+         symbol == SymbolEnum::PLUS || symbol == SymbolEnum::MINU;
+         symbol = m_tokens.peek(offset + 1).symbol) {
+        offset = scanMulExp(offset + 1);
+    }
+    return offset;
+}
+
+int Parser::scanMulExp(int offset) {
+    offset = scanUnaryExp(offset);
+    for (auto symbol = m_tokens.peek(offset + 1).symbol;
+         symbol == SymbolEnum::MULT || symbol == SymbolEnum::DIV || symbol == SymbolEnum::MOD;
+         symbol = m_tokens.peek(offset + 1).symbol) {
+        offset = scanUnaryExp(offset + 1);
+    }
+    return offset;
+}
+
+int Parser::scanUnaryExp(int offset) {
+    auto symbol = m_tokens.peek(offset + 1).symbol;
+    if (symbol == SymbolEnum::IDENFR && m_tokens.peek(offset + 2).symbol == SymbolEnum::LPARENT) {
+        offset += 2;
+        symbol = m_tokens.peek(offset + 1).symbol;
+        if (symbol != SymbolEnum::RPARENT && symbol != SymbolEnum::SEMICN) {
+            offset = scanExp(offset);
+            while (m_tokens.peek(offset + 1).symbol == SymbolEnum::COMMA) {
+                offset = scanExp(offset + 1);
+            }
+        }
+        if (m_tokens.peek(offset + 1).symbol == SymbolEnum::RPARENT) {
+            offset++;
+        }
+    } else if (symbol == SymbolEnum::PLUS || symbol == SymbolEnum::MINU || symbol == SymbolEnum::NOT) {
+        offset = scanUnaryExp(offset + 1);
+    } else if (symbol == SymbolEnum::LPARENT) {
+        offset = scanExp(offset + 1);
+        if (m_tokens.peek(offset + 1).symbol == SymbolEnum::RPARENT) {
+            offset++;
+        }
+    } else if (symbol == SymbolEnum::INTCON) {
+        offset++;
     } else {
-        m_currToken = iterBefore;
-        return true;
+        offset = scanLVal(offset);
     }
+    return offset;
 }
 
 // 编译单元compUnit -> {decl} {funcDef} mainFuncDef
-std::shared_ptr<VNodeBase> Parser::compUnit(int level) {
-    std::vector<std::shared_ptr<VNodeBase>> children;
-    auto compUnitNode = std::make_shared<VNodeBranch>(VNodeEnum::COMPUNIT);
-    compUnitNode->setLevel(level);
+VNodeBase* Parser::compUnit(int level) {
+    std::vector<VNodeBase*> children;
+    auto addItem = [&](VNodeBase* child) {
+        if (m_itemHandler) {
+            // 流式解析时条目处理完就不再需要, 其占用的内存留给下一个条目
+            m_itemHandler(child);
+            m_arena.reset();
+        } else {
+            children.push_back(child);
+        }
+    };
     // 获取 decl, 只要不是 void|int func()的形式就可以按照decl去读取
-    while ((m_currToken + 3)->symbol != SymbolEnum::LPARENT) {
-        auto child = decl(level + 1);
-        children.push_back(std::move(child));
+    while (m_tokens.peek(3).symbol != SymbolEnum::LPARENT) {
+        addItem(decl(level + 1));
     }
     // 获取 funcDef, 只要不是 void|int main () 的形式就可以按照funcDef去读取
-    while ((m_currToken + 2)->symbol != SymbolEnum::MAINTK) {
-        auto child = funcDef(level + 1);
-        children.push_back(std::move(child));
+    while (m_tokens.peek(2).symbol != SymbolEnum::MAINTK) {
+        addItem(funcDef(level + 1));
     }
     // 获取 mainFuncDef
-    auto child = mainFuncDef(level + 1);
-    children.push_back(std::move(child));
+    addItem(mainFuncDef(level + 1));
+    if (m_itemHandler) {
+        return nullptr;
+    }
+    auto compUnitNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::COMPUNIT);
+    compUnitNode->setLevel(level);
     for (auto& child : children) {
-        compUnitNode->addChild(std::move(child));
+        compUnitNode->addChild(child);
     }
     return compUnitNode;
 }
 // 声明decl -> constDef | varDef
-std::shared_ptr<VNodeBase> Parser::decl(int level, bool needSemicn) {
-    auto declNode = std::make_shared<VNodeBranch>(VNodeEnum::DECL);
+VNodeBase* Parser::decl(int level, bool needSemicn) {
+    auto declNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::DECL);
     declNode->setLevel(level);
-    std::shared_ptr<VNodeBase> child;
-    if ((m_currToken + 1)->symbol == SymbolEnum::CONSTTK) {
+    VNodeBase* child;
+    if (m_tokens.peek(1).symbol == SymbolEnum::CONSTTK) {
         child = constDecl(level, needSemicn);
     } else {
         child = varDecl(level, needSemicn);
     }
-    declNode->addChild(std::move(child));
+    declNode->addChild(child);
     return declNode;
 }
 // TODO: 完成所有的编译项
 // 常量声明constDecl -> 'const' bType constDef {',' constDef}';'
-std::shared_ptr<VNodeBase> Parser::constDecl(int level, bool needSemicn) {
-    std::vector<std::shared_ptr<VNodeBase>> children;
-    auto constDeclNode = std::make_shared<VNodeBranch>(VNodeEnum::CONSTDECL);
+VNodeBase* Parser::constDecl(int level, bool needSemicn) {
+    std::vector<VNodeBase*> children;
+    auto constDeclNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::CONSTDECL);
     constDeclNode->setLevel(level);
     children.push_back(expect(SymbolEnum::CONSTTK, level));
     children.push_back(bType(level));
     children.push_back(constDef(level));
-    while ((m_currToken + 1)->symbol == SymbolEnum::COMMA) {
+    while (m_tokens.peek(1).symbol == SymbolEnum::COMMA) {
         children.push_back(expect(SymbolEnum::COMMA, level));
         children.push_back(constDef(level));
     }
@@ -209,16 +262,16 @@ std::shared_ptr<VNodeBase> Parser::constDecl(int level, bool needSemicn) {
         children.push_back(expect(SymbolEnum::SEMICN, level));
     }
     for (auto& child : children) {
-        constDeclNode->addChild(std::move(child));
+        constDeclNode->addChild(child);
     }
     return constDeclNode;
 }
 
 // 基本类型bType -> 'int'
-std::shared_ptr<VNodeBase> Parser::bType(int level) {
-    auto btypeNode = std::make_shared<VNodeBranch>(VNodeEnum::BTYPE);
+VNodeBase* Parser::bType(int level) {
+    auto btypeNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::BTYPE);
     btypeNode->setLevel(level);
-    if ((m_currToken + 1)->symbol == SymbolEnum::INTTK) {
+    if (m_tokens.peek(1).symbol == SymbolEnum::INTTK) {
         btypeNode->addChild(expect(SymbolEnum::INTTK, level));
     } else {
         btypeNode->addChild(expect(SymbolEnum::CHARTK, level));
@@ -228,12 +281,12 @@ std::shared_ptr<VNodeBase> Parser::bType(int level) {
 }
 
 // 常量定义constDef -> IDENFR {'[' constExp ']'} '=' constInitVal;
-std::shared_ptr<VNodeBase> Parser::constDef(int level) {
-    std::vector<std::shared_ptr<VNodeBase>> children;
-    auto constDefNode = std::make_shared<VNodeBranch>(VNodeEnum::CONSTDEF);
+VNodeBase* Parser::constDef(int level) {
+    std::vector<VNodeBase*> children;
+    auto constDefNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::CONSTDEF);
     constDefNode->setLevel(level);
     children.push_back(expect(SymbolEnum::IDENFR, level));
-    while ((m_currToken + 1)->symbol == SymbolEnum::LBRACK) {
+    while (m_tokens.peek(1).symbol == SymbolEnum::LBRACK) {
         children.push_back(expect(SymbolEnum::LBRACK, level));
         children.push_back(constExp(level));
         children.push_back(expect(SymbolEnum::RBRACK, level));
@@ -241,27 +294,27 @@ std::shared_ptr<VNodeBase> Parser::constDef(int level) {
     children.push_back(expect(SymbolEnum::ASSIGN, level));
     children.push_back(constInitVal(level));
     for (auto& child : children) {
-        constDefNode->addChild(std::move(child));
+        constDefNode->addChild(child);
     }
     return constDefNode;
 }
 // 常量初值 constInitVal -> constExp | '{' [ constInitVal { ',' constInitVal } ] '}'
-std::shared_ptr<VNodeBase> Parser::constInitVal(int level) {
-    auto constInitValNode = std::make_shared<VNodeBranch>(VNodeEnum::CONSTINITVAL);
+VNodeBase* Parser::constInitVal(int level) {
+    auto constInitValNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::CONSTINITVAL);
     constInitValNode->setLevel(level);
-    if ((m_currToken + 1)->symbol == SymbolEnum::LBRACE) {
-        std::vector<std::shared_ptr<VNodeBase>> children;
+    if (m_tokens.peek(1).symbol == SymbolEnum::LBRACE) {
+        std::vector<VNodeBase*> children;
         children.push_back(expect(SymbolEnum::LBRACE, level));
-        if ((m_currToken + 1)->symbol != SymbolEnum::RBRACE) {
+        if (m_tokens.peek(1).symbol != SymbolEnum::RBRACE) {
             children.push_back(constInitVal(level));
-            while ((m_currToken + 1)->symbol == SymbolEnum::COMMA) {
+            while (m_tokens.peek(1).symbol == SymbolEnum::COMMA) {
                 children.push_back(expect(SymbolEnum::COMMA, level));
                 children.push_back(constInitVal(level));
             }
         }
         children.push_back(expect(SymbolEnum::RBRACE, level));
         for (auto& child : children) {
-            constInitValNode->addChild(std::move(child));
+            constInitValNode->addChild(child);
         }
     } else {
         constInitValNode->addChild(constExp(level));
@@ -269,21 +322,21 @@ std::shared_ptr<VNodeBase> Parser::constInitVal(int level) {
     return constInitValNode;
 }
 // 常量表达式 constExp -> addExp
-std::shared_ptr<VNodeBase> Parser::constExp(int level) {
-    auto constExpNode = std::make_shared<VNodeBranch>(VNodeEnum::CONSTEXP);
+VNodeBase* Parser::constExp(int level) {
+    auto constExpNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::CONSTEXP);
     constExpNode->setLevel(level);
     constExpNode->addChild(addExp(level));
     return constExpNode;
 }
 
 // 变量声明 varDecl -> bType varDef { ',' varDef } ';'
-std::shared_ptr<VNodeBase> Parser::varDecl(int level, bool needSemicn) {
-    std::vector<std::shared_ptr<VNodeBase>> children;
-    auto varDeclNode = std::make_shared<VNodeBranch>(VNodeEnum::VARDECL);
+VNodeBase* Parser::varDecl(int level, bool needSemicn) {
+    std::vector<VNodeBase*> children;
+    auto varDeclNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::VARDECL);
     varDeclNode->setLevel(level);
     children.push_back(bType(level));
     children.push_back(varDef(level));
-    while ((m_currToken + 1)->symbol == SymbolEnum::COMMA) {
+    while (m_tokens.peek(1).symbol == SymbolEnum::COMMA) {
         children.push_back(expect(SymbolEnum::COMMA, level));
         children.push_back(varDef(level));
     }
@@ -291,48 +344,48 @@ std::shared_ptr<VNodeBase> Parser::varDecl(int level, bool needSemicn) {
         children.push_back(expect(SymbolEnum::SEMICN, level));
     }
     for (auto& child : children) {
-        varDeclNode->addChild(std::move(child));
+        varDeclNode->addChild(child);
     }
     return varDeclNode;
 }
 // 变量定义 varDef -> IDENFR { '[' constExp ']' } [ '=' initVal ]
-std::shared_ptr<VNodeBase> Parser::varDef(int level) {
-    std::vector<std::shared_ptr<VNodeBase>> children;
-    auto varDefNode = std::make_shared<VNodeBranch>(VNodeEnum::VARDEF);
+VNodeBase* Parser::varDef(int level) {
+    std::vector<VNodeBase*> children;
+    auto varDefNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::VARDEF);
     varDefNode->setLevel(level);
     children.push_back(expect(SymbolEnum::IDENFR, level));
-    while ((m_currToken + 1)->symbol == SymbolEnum::LBRACK) {
+    while (m_tokens.peek(1).symbol == SymbolEnum::LBRACK) {
         children.push_back(expect(SymbolEnum::LBRACK, level));
         children.push_back(constExp(level));
         children.push_back(expect(SymbolEnum::RBRACK, level));
     }
-    if ((m_currToken + 1)->symbol == SymbolEnum::ASSIGN) {
+    if (m_tokens.peek(1).symbol == SymbolEnum::ASSIGN) {
         children.push_back(expect(SymbolEnum::ASSIGN, level));
         children.push_back(initVal(level));
     }
 
     for (auto& child : children) {
-        varDefNode->addChild(std::move(child));
+        varDefNode->addChild(child);
     }
     return varDefNode;
 }
 // 变量初值 initVal -> exp | '{' [ initVal { ',' initVal } ] '}'
-std::shared_ptr<VNodeBase> Parser::initVal(int level) {
-    auto initValNode = std::make_shared<VNodeBranch>(VNodeEnum::INITVAL);
+VNodeBase* Parser::initVal(int level) {
+    auto initValNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::INITVAL);
     initValNode->setLevel(level);
-    if ((m_currToken + 1)->symbol == SymbolEnum::LBRACE) {
-        std::vector<std::shared_ptr<VNodeBase>> children;
+    if (m_tokens.peek(1).symbol == SymbolEnum::LBRACE) {
+        std::vector<VNodeBase*> children;
         children.push_back(expect(SymbolEnum::LBRACE, level));
-        if ((m_currToken + 1)->symbol != SymbolEnum::RBRACE) {
+        if (m_tokens.peek(1).symbol != SymbolEnum::RBRACE) {
             children.push_back(initVal(level));
-            while ((m_currToken + 1)->symbol == SymbolEnum::COMMA) {
+            while (m_tokens.peek(1).symbol == SymbolEnum::COMMA) {
                 children.push_back(expect(SymbolEnum::COMMA, level));
                 children.push_back(initVal(level));
             }
         }
         children.push_back(expect(SymbolEnum::RBRACE, level));
         for (auto& child : children) {
-            initValNode->addChild(std::move(child));
+            initValNode->addChild(child);
         }
     } else {
         initValNode->addChild(exp(level));
@@ -341,28 +394,28 @@ std::shared_ptr<VNodeBase> Parser::initVal(int level) {
 }
 
 // 语句块 block -> '{' { blockItem } '}'
-std::shared_ptr<VNodeBase> Parser::block(int level) {
-    std::vector<std::shared_ptr<VNodeBase>> children;
-    auto blockNode = std::make_shared<VNodeBranch>(VNodeEnum::BLOCK);
+VNodeBase* Parser::block(int level) {
+    std::vector<VNodeBase*> children;
+    auto blockNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::BLOCK);
     blockNode->setLevel(level);
     children.push_back(expect(SymbolEnum::LBRACE, level));
-    while ((m_currToken + 1)->symbol != SymbolEnum::RBRACE) {
+    while (m_tokens.peek(1).symbol != SymbolEnum::RBRACE) {
         children.push_back(blockItem(level + 1));
     }
     children.push_back(expect(SymbolEnum::RBRACE, level));
     for (auto& child : children) {
-        blockNode->addChild(std::move(child));
+        blockNode->addChild(child);
     }
     return blockNode;
 }
 
 // 语句块项 blockItem -> decl | stmt
-std::shared_ptr<VNodeBase> Parser::blockItem(int level, bool needSemicn) {
-    auto blockItemNode = std::make_shared<VNodeBranch>(VNodeEnum::BLOCKITEM);
+VNodeBase* Parser::blockItem(int level, bool needSemicn) {
+    auto blockItemNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::BLOCKITEM);
     blockItemNode->setLevel(level);
-    if ((m_currToken + 1)->symbol == SymbolEnum::CONSTTK
-        || (m_currToken + 1)->symbol == SymbolEnum::INTTK
-        || (m_currToken + 1)->symbol == SymbolEnum::CHARTK) {
+    if (m_tokens.peek(1).symbol == SymbolEnum::CONSTTK
+        || m_tokens.peek(1).symbol == SymbolEnum::INTTK
+        || m_tokens.peek(1).symbol == SymbolEnum::CHARTK) {
         blockItemNode->addChild(decl(level, needSemicn));
     } else {
         blockItemNode->addChild(stmt(level, needSemicn));
@@ -383,28 +436,28 @@ std::shared_ptr<VNodeBase> Parser::blockItem(int level, bool needSemicn) {
                 | 'return' [exp] ';'
                 | 'printf''('formatString{','exp}')'';'
  */
-std::shared_ptr<VNodeBase> Parser::stmt(int level, bool needSemicn) {
-    std::vector<std::shared_ptr<VNodeBase>> children;
-    auto stmtNode = std::make_shared<VNodeBranch>(VNodeEnum::STMT);
+VNodeBase* Parser::stmt(int level, bool needSemicn) {
+    std::vector<VNodeBase*> children;
+    auto stmtNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::STMT);
     stmtNode->setLevel(level);
     // 首先是开头具有标识符的情况，包括 if/while/break/continue/return/printf
-    if ((m_currToken + 1)->symbol == SymbolEnum::IFTK) {
+    if (m_tokens.peek(1).symbol == SymbolEnum::IFTK) {
         children.push_back(expect(SymbolEnum::IFTK, level));
         children.push_back(expect(SymbolEnum::LPARENT, level));
         children.push_back(cond(level));
         children.push_back(expect(SymbolEnum::RPARENT, level));
         children.push_back(stmt(level));
-        if ((m_currToken + 1)->symbol == SymbolEnum::ELSETK) {
+        if (m_tokens.peek(1).symbol == SymbolEnum::ELSETK) {
             children.push_back(expect(SymbolEnum::ELSETK, level));
             children.push_back(stmt(level));
         }
-    } else if ((m_currToken + 1)->symbol == SymbolEnum::WHILETK) {
+    } else if (m_tokens.peek(1).symbol == SymbolEnum::WHILETK) {
         children.push_back(expect(SymbolEnum::WHILETK, level));
         children.push_back(expect(SymbolEnum::LPARENT, level));
         children.push_back(cond(level));
         children.push_back(expect(SymbolEnum::RPARENT, level));
         children.push_back(stmt(level));
-    } else if ((m_currToken + 1)->symbol == SymbolEnum::FORTK) { // 'for' '(' blockItem ';' cond ';' stmt')' stmt
+    } else if (m_tokens.peek(1).symbol == SymbolEnum::FORTK) { // 'for' '(' blockItem ';' cond ';' stmt')' stmt
         children.push_back(expect(SymbolEnum::FORTK, level));
         children.push_back(expect(SymbolEnum::LPARENT, level));
         children.push_back(blockItem(level, false));
@@ -414,25 +467,25 @@ std::shared_ptr<VNodeBase> Parser::stmt(int level, bool needSemicn) {
         children.push_back(stmt(level, false));
         children.push_back(expect(SymbolEnum::RPARENT, level));
         children.push_back(stmt(level));
-    } else if ((m_currToken + 1)->symbol == SymbolEnum::BREAKTK || (m_currToken + 1)->symbol == SymbolEnum::CONTINUETK) {
+    } else if (m_tokens.peek(1).symbol == SymbolEnum::BREAKTK || m_tokens.peek(1).symbol == SymbolEnum::CONTINUETK) {
         children.push_back(expect({SymbolEnum::BREAKTK, SymbolEnum::CONTINUETK}, level));
         if (needSemicn) {
             children.push_back(expect(SymbolEnum::SEMICN, level));
         }
-    } else if ((m_currToken + 1)->symbol == SymbolEnum::RETURNTK) {
+    } else if (m_tokens.peek(1).symbol == SymbolEnum::RETURNTK) {
         children.push_back(expect(SymbolEnum::RETURNTK, level));
-        if ((m_currToken + 1)->symbol != SymbolEnum::SEMICN
-            && (m_currToken + 1)->symbol != SymbolEnum::RBRACE) {
+        if (m_tokens.peek(1).symbol != SymbolEnum::SEMICN
+            && m_tokens.peek(1).symbol != SymbolEnum::RBRACE) {
             children.push_back(exp(level));
         }
         if (needSemicn) {
             children.push_back(expect(SymbolEnum::SEMICN, level));
         }
-    } else if ((m_currToken + 1)->symbol == SymbolEnum::PRINTFTK) {
+    } else if (m_tokens.peek(1).symbol == SymbolEnum::PRINTFTK) {
         children.push_back(expect(SymbolEnum::PRINTFTK, level));
         children.push_back(expect(SymbolEnum::LPARENT, level));
         children.push_back(expect(SymbolEnum::STRCON, level));
-        while ((m_currToken + 1)->symbol == SymbolEnum::COMMA) {
+        while (m_tokens.peek(1).symbol == SymbolEnum::COMMA) {
             children.push_back(expect(SymbolEnum::COMMA, level));
             children.push_back(exp(level));
         }
@@ -442,14 +495,14 @@ std::shared_ptr<VNodeBase> Parser::stmt(int level, bool needSemicn) {
         }
     }
     // block 的首符 '{'
-    else if ((m_currToken + 1)->symbol == SymbolEnum::LBRACE) {
+    else if (m_tokens.peek(1).symbol == SymbolEnum::LBRACE) {
         children.push_back(block(level + 1));
     }
     // 处理赋值给左值的情况，包括 lVal '=' exp ';'| lVal '=' 'getint''('')'';'
     else if (expectAssignment()) {
         children.push_back(lVal(level));
         children.push_back(expect(SymbolEnum::ASSIGN, level));
-        if ((m_currToken + 1)->symbol == SymbolEnum::GETINTTK) {
+        if (m_tokens.peek(1).symbol == SymbolEnum::GETINTTK) {
             children.push_back(expect(SymbolEnum::GETINTTK, level));
             children.push_back(expect(SymbolEnum::LPARENT, level));
             children.push_back(expect(SymbolEnum::RPARENT, level));
@@ -468,91 +521,91 @@ std::shared_ptr<VNodeBase> Parser::stmt(int level, bool needSemicn) {
         }
     }
     // 只有分号
-    else if ((m_currToken + 1)->symbol == SymbolEnum::SEMICN) {
+    else if (m_tokens.peek(1).symbol == SymbolEnum::SEMICN) {
         if (needSemicn) {
             children.push_back(expect(SymbolEnum::SEMICN, level));
         }
     }
 
     for (auto& child : children) {
-        stmtNode->addChild(std::move(child));
+        stmtNode->addChild(child);
     }
     return stmtNode;
 }
 
 // 左值 lVal -> IDENFR {'[' exp ']'}
-std::shared_ptr<VNodeBase> Parser::lVal(int level) {
-    std::vector<std::shared_ptr<VNodeBase>> children;
-    auto lValNode = std::make_shared<VNodeBranch>(VNodeEnum::LVAL);
+VNodeBase* Parser::lVal(int level) {
+    std::vector<VNodeBase*> children;
+    auto lValNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::LVAL);
     lValNode->setLevel(level);
     children.push_back(expect(SymbolEnum::IDENFR, level));
     int cnt = 0;
-    while ((m_currToken + 1)->symbol == SymbolEnum::LBRACK) {
+    while (m_tokens.peek(1).symbol == SymbolEnum::LBRACK) {
         children.push_back(expect(SymbolEnum::LBRACK, level));
         children.push_back(exp(level));
         children.push_back(expect(SymbolEnum::RBRACK, level));
         cnt++;
     }
     for (auto& child : children) {
-        lValNode->addChild(std::move(child));
+        lValNode->addChild(child);
     }
     return lValNode;
 }
 // 表达式 exp -> addExp
-std::shared_ptr<VNodeBase> Parser::exp(int level) {
-    auto expNode = std::make_shared<VNodeBranch>(VNodeEnum::EXP);
+VNodeBase* Parser::exp(int level) {
+    auto expNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::EXP);
     expNode->setLevel(level);
     expNode->addChild(addExp(level));
     return expNode;
 }
 
 // 条件表达式 cond -> lOrExp
-std::shared_ptr<VNodeBase> Parser::cond(int level) {
-    auto condNode = std::make_shared<VNodeBranch>(VNodeEnum::COND);
+VNodeBase* Parser::cond(int level) {
+    auto condNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::COND);
     condNode->setLevel(level);
     condNode->addChild(lOrExp(level));
     return condNode;
 }
 
-std::shared_ptr<VNodeBase> Parser::number(int level) {
-    auto numberNode = std::make_shared<VNodeBranch>(VNodeEnum::NUM);
+VNodeBase* Parser::number(int level) {
+    auto numberNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::NUM);
     numberNode->setLevel(level);
     numberNode->addChild(expect(SymbolEnum::INTCON, level));
     return numberNode;
 }
 
 // 基本表达式 primaryExp -> '(' exp ')' | lVal | number
-std::shared_ptr<VNodeBase> Parser::primaryExp(int level) {
-    std::vector<std::shared_ptr<VNodeBase>> children;
-    auto primaryExpNode = std::make_shared<VNodeBranch>(VNodeEnum::PRIMARYEXP);
+VNodeBase* Parser::primaryExp(int level) {
+    std::vector<VNodeBase*> children;
+    auto primaryExpNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::PRIMARYEXP);
     primaryExpNode->setLevel(level);
-    if ((m_currToken + 1)->symbol == SymbolEnum::LPARENT) {
+    if (m_tokens.peek(1).symbol == SymbolEnum::LPARENT) {
         children.push_back(expect(SymbolEnum::LPARENT, level));
         children.push_back(exp(level));
         children.push_back(expect(SymbolEnum::RPARENT, level));
-    } else if ((m_currToken + 1)->symbol == SymbolEnum::INTCON) {
+    } else if (m_tokens.peek(1).symbol == SymbolEnum::INTCON) {
         children.push_back(number(level));
     } else {
         children.push_back(lVal(level));
     }
     for (auto& child : children) {
-        primaryExpNode->addChild(std::move(child));
+        primaryExpNode->addChild(child);
     }
     return primaryExpNode;
 }
 
 // 一元表达式 unaryExp -> primaryExp | IDENFR '(' [funcRParams] ')' | | unaryOp unaryExp
-std::shared_ptr<VNodeBase> Parser::unaryExp(int level) {
-    std::vector<std::shared_ptr<VNodeBase>> children;
-    auto unaryExpNode = std::make_shared<VNodeBranch>(VNodeEnum::UNARYEXP);
+VNodeBase* Parser::unaryExp(int level) {
+    std::vector<VNodeBase*> children;
+    auto unaryExpNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::UNARYEXP);
     unaryExpNode->setLevel(level);
-    if ((m_currToken + 1)->symbol == SymbolEnum::IDENFR
-        && (m_currToken + 2)->symbol == SymbolEnum::LPARENT) {
+    if (m_tokens.peek(1).symbol == SymbolEnum::IDENFR
+        && m_tokens.peek(2).symbol == SymbolEnum::LPARENT) {
         children.push_back(expect(SymbolEnum::IDENFR, level));
         children.push_back(expect(SymbolEnum::LPARENT, level));
         // TODO: 修复'('错误
-        if ((m_currToken + 1)->symbol != SymbolEnum::RPARENT
-            && (m_currToken + 1)->symbol != SymbolEnum::SEMICN) {
+        if (m_tokens.peek(1).symbol != SymbolEnum::RPARENT
+            && m_tokens.peek(1).symbol != SymbolEnum::SEMICN) {
             children.push_back(funcRParams(level));
         }
         children.push_back(expect(SymbolEnum::RPARENT, level));
@@ -565,27 +618,27 @@ std::shared_ptr<VNodeBase> Parser::unaryExp(int level) {
     }
 
     for (auto& child : children) {
-        unaryExpNode->addChild(std::move(child));
+        unaryExpNode->addChild(child);
     }
     return unaryExpNode;
 }
 
 // 单目运算符 unaryOp -> '+' | '−' | '!'
-std::shared_ptr<VNodeBase> Parser::unaryOp(int level) {
-    auto unaryOpNode = std::make_shared<VNodeBranch>(VNodeEnum::UNARYOP);
+VNodeBase* Parser::unaryOp(int level) {
+    auto unaryOpNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::UNARYOP);
     unaryOpNode->setLevel(level);
     auto op = expect({SymbolEnum::PLUS, SymbolEnum::MINU, SymbolEnum::NOT}, level);
-    unaryOpNode->addChild(std::move(op));
+    unaryOpNode->addChild(op);
     return unaryOpNode;
 }
 
 // 加减模运算 addExp -> mulExp {('+' | '−') mulExp}
-std::shared_ptr<VNodeBase> Parser::addExp(int level) {
-    auto addExpNode = std::make_shared<VNodeBranch>(VNodeEnum::ADDEXP);
+VNodeBase* Parser::addExp(int level) {
+    auto addExpNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::ADDEXP);
     addExpNode->setLevel(level);
     addExpNode->addChild(mulExp(level));
-    while ((m_currToken + 1)->symbol == SymbolEnum::PLUS || (m_currToken + 1)->symbol == SymbolEnum::MINU) {
-        auto newAddExpNode = std::make_shared<VNodeBranch>(VNodeEnum::ADDEXP);
+    while (m_tokens.peek(1).symbol == SymbolEnum::PLUS || m_tokens.peek(1).symbol == SymbolEnum::MINU) {
+        auto newAddExpNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::ADDEXP);
         newAddExpNode->setLevel(level);
         newAddExpNode->addChild(addExpNode);
         addExpNode = newAddExpNode;
@@ -596,14 +649,14 @@ std::shared_ptr<VNodeBase> Parser::addExp(int level) {
 }
 
 // 乘除模运算 mulExp -> unaryExp { ('*' | '/' | '%') unaryExp}
-std::shared_ptr<VNodeBase> Parser::mulExp(int level) {
-    auto mulExpNode = std::make_shared<VNodeBranch>(VNodeEnum::MULEXP);
+VNodeBase* Parser::mulExp(int level) {
+    auto mulExpNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::MULEXP);
     mulExpNode->setLevel(level);
     mulExpNode->addChild(unaryExp(level));
-    while ((m_currToken + 1)->symbol == SymbolEnum::MULT
-           || (m_currToken + 1)->symbol == SymbolEnum::DIV
-           || (m_currToken + 1)->symbol == SymbolEnum::MOD) {
-        auto newMulExpNode = std::make_shared<VNodeBranch>(VNodeEnum::MULEXP);
+    while (m_tokens.peek(1).symbol == SymbolEnum::MULT
+           || m_tokens.peek(1).symbol == SymbolEnum::DIV
+           || m_tokens.peek(1).symbol == SymbolEnum::MOD) {
+        auto newMulExpNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::MULEXP);
         newMulExpNode->setLevel(level);
         newMulExpNode->addChild(mulExpNode);
         mulExpNode = newMulExpNode;
@@ -614,15 +667,15 @@ std::shared_ptr<VNodeBase> Parser::mulExp(int level) {
 }
 
 // 关系表达式 relExp -> addExp {('<' | '>' | '<=' | '>=') addExp}
-std::shared_ptr<VNodeBase> Parser::relExp(int level) {
-    auto relExpNode = std::make_shared<VNodeBranch>(VNodeEnum::RELEXP);
+VNodeBase* Parser::relExp(int level) {
+    auto relExpNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::RELEXP);
     relExpNode->setLevel(level);
     relExpNode->addChild(addExp(level));
-    while ((m_currToken + 1)->symbol == SymbolEnum::LSS
-           || (m_currToken + 1)->symbol == SymbolEnum::LEQ
-           || (m_currToken + 1)->symbol == SymbolEnum::GRE
-           || (m_currToken + 1)->symbol == SymbolEnum::GEQ) {
-        auto newRelExpNode = std::make_shared<VNodeBranch>(VNodeEnum::RELEXP);
+    while (m_tokens.peek(1).symbol == SymbolEnum::LSS
+           || m_tokens.peek(1).symbol == SymbolEnum::LEQ
+           || m_tokens.peek(1).symbol == SymbolEnum::GRE
+           || m_tokens.peek(1).symbol == SymbolEnum::GEQ) {
+        auto newRelExpNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::RELEXP);
         newRelExpNode->setLevel(level);
         newRelExpNode->addChild(relExpNode);
         relExpNode = newRelExpNode;
@@ -633,12 +686,12 @@ std::shared_ptr<VNodeBase> Parser::relExp(int level) {
 }
 
 // 相等性表达式 eqExp -> relExp { ('==' | '!=') relExp}
-std::shared_ptr<VNodeBase> Parser::eqExp(int level) {
-    auto eqExpNode = std::make_shared<VNodeBranch>(VNodeEnum::EQEXP);
+VNodeBase* Parser::eqExp(int level) {
+    auto eqExpNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::EQEXP);
     eqExpNode->setLevel(level);
     eqExpNode->addChild(relExp(level));
-    while ((m_currToken + 1)->symbol == SymbolEnum::EQL || (m_currToken + 1)->symbol == SymbolEnum::NEQ) {
-        auto newEqExpNode = std::make_shared<VNodeBranch>(VNodeEnum::EQEXP);
+    while (m_tokens.peek(1).symbol == SymbolEnum::EQL || m_tokens.peek(1).symbol == SymbolEnum::NEQ) {
+        auto newEqExpNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::EQEXP);
         newEqExpNode->addChild(eqExpNode);
         newEqExpNode->setLevel(level);
         eqExpNode = newEqExpNode;
@@ -649,12 +702,12 @@ std::shared_ptr<VNodeBase> Parser::eqExp(int level) {
 }
 
 // 逻辑与表达式 lAndExp -> eqExp { '&&' eqExp }
-std::shared_ptr<VNodeBase> Parser::lAndExp(int level) {
-    auto lAndExpNode = std::make_shared<VNodeBranch>(VNodeEnum::LANDEXP);
+VNodeBase* Parser::lAndExp(int level) {
+    auto lAndExpNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::LANDEXP);
     lAndExpNode->setLevel(level);
     lAndExpNode->addChild(eqExp(level));
-    while ((m_currToken + 1)->symbol == SymbolEnum::AND) {
-        auto newLAndExpNode = std::make_shared<VNodeBranch>(VNodeEnum::LANDEXP);
+    while (m_tokens.peek(1).symbol == SymbolEnum::AND) {
+        auto newLAndExpNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::LANDEXP);
         newLAndExpNode->setLevel(level);
         newLAndExpNode->addChild(lAndExpNode);
         lAndExpNode = newLAndExpNode;
@@ -665,12 +718,12 @@ std::shared_ptr<VNodeBase> Parser::lAndExp(int level) {
 }
 
 // 逻辑或表达式 lOrExp ->  lAndExp { '||' lAndExp }
-std::shared_ptr<VNodeBase> Parser::lOrExp(int level) {
-    auto lOrExpNode = std::make_shared<VNodeBranch>(VNodeEnum::LOREXP);
+VNodeBase* Parser::lOrExp(int level) {
+    auto lOrExpNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::LOREXP);
     lOrExpNode->setLevel(level);
     lOrExpNode->addChild(lAndExp(level));
-    while ((m_currToken + 1)->symbol == SymbolEnum::OR) {
-        auto newLOrExpNode = std::make_shared<VNodeBranch>(VNodeEnum::LOREXP);
+    while (m_tokens.peek(1).symbol == SymbolEnum::OR) {
+        auto newLOrExpNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::LOREXP);
         newLOrExpNode->setLevel(level);
         newLOrExpNode->addChild(lOrExpNode);
         lOrExpNode = newLOrExpNode;
@@ -681,30 +734,30 @@ std::shared_ptr<VNodeBase> Parser::lOrExp(int level) {
 }
 
 // 函数定义 funcDef -> funcType IDENFR '(' [funcFParams] ')' block
-std::shared_ptr<VNodeBase> Parser::funcDef(int level) {
-    std::vector<std::shared_ptr<VNodeBase>> children;
-    auto funcDefNode = std::make_shared<VNodeBranch>(VNodeEnum::FUNCDEF);
+VNodeBase* Parser::funcDef(int level) {
+    std::vector<VNodeBase*> children;
+    auto funcDefNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::FUNCDEF);
     funcDefNode->setLevel(level);
     children.push_back(funcType(level));
     children.push_back(expect(SymbolEnum::IDENFR, level));
     children.push_back(expect(SymbolEnum::LPARENT, level));
-    if ((m_currToken + 1)->symbol != SymbolEnum::RPARENT
-        && (m_currToken + 1)->symbol != SymbolEnum::LBRACE) {
+    if (m_tokens.peek(1).symbol != SymbolEnum::RPARENT
+        && m_tokens.peek(1).symbol != SymbolEnum::LBRACE) {
         children.push_back(funcFParams(level));
     }
     children.push_back(expect(SymbolEnum::RPARENT, level));
     children.push_back(block(level + 1));
 
     for (auto& child : children) {
-        funcDefNode->addChild(std::move(child));
+        funcDefNode->addChild(child);
     }
     return funcDefNode;
 }
 
 // 主函数定义 mainFuncDef -> 'int' 'main' '(' ')' block
-std::shared_ptr<VNodeBase> Parser::mainFuncDef(int level) {
-    std::vector<std::shared_ptr<VNodeBase>> children;
-    auto mainFuncDefNode = std::make_shared<VNodeBranch>(VNodeEnum::MAINFUNCDEF);
+VNodeBase* Parser::mainFuncDef(int level) {
+    std::vector<VNodeBase*> children;
+    auto mainFuncDefNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::MAINFUNCDEF);
     mainFuncDefNode->setLevel(level);
     children.push_back(expect(SymbolEnum::INTTK, level));
     children.push_back(expect(SymbolEnum::MAINTK, level));
@@ -712,47 +765,47 @@ std::shared_ptr<VNodeBase> Parser::mainFuncDef(int level) {
     children.push_back(expect(SymbolEnum::RPARENT, level));
     children.push_back(block(level + 1));
     for (auto& child : children) {
-        mainFuncDefNode->addChild(std::move(child));
+        mainFuncDefNode->addChild(child);
     }
     return mainFuncDefNode;
 }
 
 // 函数类型 funcType -> 'void' | 'int'
-std::shared_ptr<VNodeBase> Parser::funcType(int level) {
-    auto funcTypeNode = std::make_shared<VNodeBranch>(VNodeEnum::FUNCTYPE);
+VNodeBase* Parser::funcType(int level) {
+    auto funcTypeNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::FUNCTYPE);
     funcTypeNode->setLevel(level);
     funcTypeNode->addChild(expect({SymbolEnum::VOIDTK, SymbolEnum::INTTK, SymbolEnum::CHARTK}, level));
     return funcTypeNode;
 }
 
 // 函数形参表 funcFParams -> funcFParam {',' funcFParam}
-std::shared_ptr<VNodeBase> Parser::funcFParams(int level) {
-    std::vector<std::shared_ptr<VNodeBase>> children;
-    auto funcFParamsNode = std::make_shared<VNodeBranch>(VNodeEnum::FUNCFPARAMS);
+VNodeBase* Parser::funcFParams(int level) {
+    std::vector<VNodeBase*> children;
+    auto funcFParamsNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::FUNCFPARAMS);
     funcFParamsNode->setLevel(level);
     children.push_back(funcFParam(level));
-    while ((m_currToken + 1)->symbol == SymbolEnum::COMMA) {
+    while (m_tokens.peek(1).symbol == SymbolEnum::COMMA) {
         children.push_back(expect(SymbolEnum::COMMA, level));
         children.push_back(funcFParam(level));
     }
 
     for (auto& child : children) {
-        funcFParamsNode->addChild(std::move(child));
+        funcFParamsNode->addChild(child);
     }
     return funcFParamsNode;
 }
 
 // 函数形参 funcFParam -> bType IDENFR ['[' ']' { '[' constExp ']' }]
-std::shared_ptr<VNodeBase> Parser::funcFParam(int level) {
-    std::vector<std::shared_ptr<VNodeBase>> children;
-    auto funcFParamNode = std::make_shared<VNodeBranch>(VNodeEnum::FUNCFPARAM);
+VNodeBase* Parser::funcFParam(int level) {
+    std::vector<VNodeBase*> children;
+    auto funcFParamNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::FUNCFPARAM);
     funcFParamNode->setLevel(level);
     children.push_back(bType(level));
     children.push_back(expect(SymbolEnum::IDENFR, level));
-    if ((m_currToken + 1)->symbol == SymbolEnum::LBRACK) {
+    if (m_tokens.peek(1).symbol == SymbolEnum::LBRACK) {
         children.push_back(expect(SymbolEnum::LBRACK, level));
         children.push_back(expect(SymbolEnum::RBRACK, level));
-        while ((m_currToken + 1)->symbol == SymbolEnum::LBRACK) {
+        while (m_tokens.peek(1).symbol == SymbolEnum::LBRACK) {
             children.push_back(expect(SymbolEnum::LBRACK, level));
             children.push_back(constExp(level));
             children.push_back(expect(SymbolEnum::RBRACK, level));
@@ -760,24 +813,24 @@ std::shared_ptr<VNodeBase> Parser::funcFParam(int level) {
     }
 
     for (auto& child : children) {
-        funcFParamNode->addChild(std::move(child));
+        funcFParamNode->addChild(child);
     }
     return funcFParamNode;
 }
 
 // 函数实参表 funcRParams -> exp { ',' exp }
-std::shared_ptr<VNodeBase> Parser::funcRParams(int level) {
-    std::vector<std::shared_ptr<VNodeBase>> children;
-    auto funcRParamsNode = std::make_shared<VNodeBranch>(VNodeEnum::FUNCRPARAMS);
+VNodeBase* Parser::funcRParams(int level) {
+    std::vector<VNodeBase*> children;
+    auto funcRParamsNode = m_arena.make<VNodeBranch>(m_arena, VNodeEnum::FUNCRPARAMS);
 
     funcRParamsNode->setLevel(level);
     children.push_back(exp(level));
-    while ((m_currToken + 1)->symbol == SymbolEnum::COMMA) {
+    while (m_tokens.peek(1).symbol == SymbolEnum::COMMA) {
         children.push_back(expect(SymbolEnum::COMMA, level));
         children.push_back(exp(level));
     }
     for (auto& child : children) {
-        funcRParamsNode->addChild(std::move(child));
+        funcRParamsNode->addChild(child);
     }
     return funcRParamsNode;
 }
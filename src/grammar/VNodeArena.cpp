@@ -0,0 +1,55 @@
+#include <grammar/VNodeArena.h>
+
+constexpr std::size_t VNodeArena::BLOCK_SIZE;
+
+void* VNodeArena::allocateSlow(std::size_t size, std::size_t align) {
+    if (size + align > BLOCK_SIZE) {
+        // 超大的分配单独占用一块, 不影响当前块的剩余空间
+        char* block = static_cast<char*>(::operator new(size + align));
+        m_largeBlocks.push_back(block);
+        m_largeBytes += size + align;
+        auto ret = (reinterpret_cast<std::uintptr_t>(block) + align - 1) & ~(align - 1);
+        return reinterpret_cast<void*>(ret);
+    }
+    std::size_t next = m_curr == nullptr ? 0 : m_blockIndex + 1;
+    if (next == m_blocks.size()) {
+        m_blocks.push_back(static_cast<char*>(::operator new(BLOCK_SIZE)));
+        m_allocatedBytes += BLOCK_SIZE;
+    }
+    useBlock(next);
+    return allocate(size, align);
+}
+
+void VNodeArena::useBlock(std::size_t index) {
+    m_blockIndex = index;
+    m_curr = m_blocks[index];
+    m_end = m_curr + BLOCK_SIZE;
+}
+
+void VNodeArena::reset() {
+    for (auto block : m_largeBlocks) {
+        ::operator delete(block);
+    }
+    m_largeBlocks.clear();
+    m_largeBytes = 0;
+    if (m_blocks.empty()) {
+        m_curr = m_end = nullptr;
+    } else {
+        useBlock(0);
+    }
+}
+
+void VNodeArena::release() {
+    for (auto block : m_blocks) {
+        ::operator delete(block);
+    }
+    for (auto block : m_largeBlocks) {
+        ::operator delete(block);
+    }
+    m_blocks.clear();
+    m_largeBlocks.clear();
+    m_blockIndex = 0;
+    m_curr = m_end = nullptr;
+    m_allocatedBytes = 0;
+    m_largeBytes = 0;
+}
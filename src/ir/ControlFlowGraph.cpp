@@ -15,8 +15,8 @@ void computeDomInfo(IrFunc* f) {
     entry->domBy = {entry};
     std::unordered_set<BasicBlock*> all; // 全部基本块，除entry外的dom的初值
     auto& basicBlocks = f->getBasicBlocks();
-    for (auto& bb : basicBlocks) {
-        all.insert(bb.get());
+    for (auto bb : basicBlocks) {
+        all.insert(bb);
         bb->doms.clear(); // 顺便清空doms，与计算domBy无关
     }
     for (auto bb = std::next(basicBlocks.begin()); bb != basicBlocks.end(); bb++) {
@@ -25,11 +25,11 @@ void computeDomInfo(IrFunc* f) {
     while (true) {
         bool changed = false;
         for (auto it = std::next(basicBlocks.begin()); it != basicBlocks.end(); it++) {
-            auto& bb = *it;
+            auto bb = *it;
             for (auto it = bb->domBy.begin(); it != bb->domBy.end();) {
                 BasicBlock* x = *it;
                 // 如果bb的任何一个pred的dom不包含x，那么bb的dom也不应该包含x
-                if (x != bb.get() && std::any_of(bb->getPreds().begin(), bb->getPreds().end(), [x](BasicBlock* p) { return p->domBy.find(x) == p->domBy.end(); })) {
+                if (x != bb && std::any_of(bb->getPreds().begin(), bb->getPreds().end(), [x](BasicBlock* p) { return p->domBy.find(x) == p->domBy.end(); })) {
                     changed = true;
                     it = bb->domBy.erase(it);
                 } else {
@@ -42,15 +42,15 @@ void computeDomInfo(IrFunc* f) {
     // 计算idom，顺便填充doms
     entry->idom = nullptr;
     for (auto it = std::next(basicBlocks.begin()); it != basicBlocks.end(); it++) {
-        auto& bb = *it;
+        auto bb = *it;
         for (BasicBlock* d : bb->domBy) {
             // 已知d dom bb，若d != bb，则d strictly dom bb
             // 若还有：d不strictly dom任何strictly dom bb的节点，则d idom bb
-            if (d != bb.get() && std::all_of(bb->domBy.begin(), bb->domBy.end(), [d, &bb](BasicBlock* x) {
-                    return x == bb.get() || x == d || x->domBy.find(d) == x->domBy.end();
+            if (d != bb && std::all_of(bb->domBy.begin(), bb->domBy.end(), [d, &bb](BasicBlock* x) {
+                    return x == bb || x == d || x->domBy.find(d) == x->domBy.end();
                 })) {
                 bb->idom = d; // 若实现正确，这里恰好会执行一次(即使没有break)
-                d->doms.push_back(bb.get());
+                d->doms.push_back(bb);
                 break;
             }
         }
@@ -72,6 +72,7 @@ static void collectLoops(LoopInfo& info, std::vector<BasicBlock*>& worklist, Bas
     }
     if (!worklist.empty()) {
         Loop* l = new Loop(header);
+        info.loops.emplace_back(l);
         while (!worklist.empty()) {
             BasicBlock* pred = worklist.back();
             worklist.pop_back();
@@ -155,10 +156,10 @@ std::vector<BasicBlock*> computeRpo(IrFunc* f) {
 std::unordered_map<BasicBlock*, std::unordered_set<BasicBlock*>> computeDf(IrFunc* f) {
     std::unordered_map<BasicBlock*, std::unordered_set<BasicBlock*>> df;
     auto& basicBlocks = f->getBasicBlocks();
-    for (auto& from : basicBlocks) {
+    for (auto from : basicBlocks) {
         for (BasicBlock* to : from->getSuccs()) {
             if (to) { // 枚举所有边(from, to)
-                BasicBlock* x = from.get();
+                BasicBlock* x = from;
                 while (x == to || to->domBy.find(x) == to->domBy.end()) { // while x不strictly dom to
                     df[x].insert(to);
                     x = x->idom;
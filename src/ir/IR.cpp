@@ -1,23 +1,21 @@
 #include <ir/IR.h>
 #include <ir/Printf.h>
 #include <optimize/IrOptPass.h>
+#include <ThreadPool.h>
+#include <cstdint>
+#include <new>
 
-std::vector<std::function<void(IrModule&)>> IrContext::s_irPasses{memToReg};
-IndexMapper<Value> Value::s_valueMapper;
-IndexMapper<BasicBlock> BasicBlock::s_bbMapper;
-std::map<int, ConstValue*> ConstValue::POOL;
-std::map<std::string, IrFunc*> IrModule::s_builtinFuncs;
-std::set<IrFunc*> IrModule::s_usedBuiltinFuncs;
-std::map<std::string, FuncItem*> IrFunc::s_builtinFuncItemsMap;
+constexpr int ConstPool::SMALL_MIN;
+constexpr int ConstPool::SMALL_MAX;
 
 std::array<BasicBlock*, 2> BasicBlock::getSuccs() {
     if (!m_insts.empty()) {
-        auto& lastInst = m_insts.back();
-        if (auto branchInst = dynamic_cast<BranchInst*>(lastInst.get())) {
+        auto lastInst = m_insts.back();
+        if (auto branchInst = dyn_cast<BranchInst>(lastInst)) {
             return {branchInst->m_left, branchInst->m_right};
-        } else if (auto jumpInst = dynamic_cast<JumpInst*>(lastInst.get())) {
+        } else if (auto jumpInst = dyn_cast<JumpInst>(lastInst)) {
             return {jumpInst->m_next, nullptr};
-        } else if (auto returnInst = dynamic_cast<ReturnInst*>(lastInst.get())) {
+        } else if (auto returnInst = dyn_cast<ReturnInst>(lastInst)) {
             return {nullptr, nullptr};
         }
     }
@@ -26,12 +24,12 @@ std::array<BasicBlock*, 2> BasicBlock::getSuccs() {
 
 std::array<BasicBlock**, 2> BasicBlock::getSuccsRef() {
     if (!m_insts.empty()) {
-        auto& lastInst = m_insts.back();
-        if (auto branchInst = dynamic_cast<BranchInst*>(lastInst.get())) {
+        auto lastInst = m_insts.back();
+        if (auto branchInst = dyn_cast<BranchInst>(lastInst)) {
             return {&branchInst->m_left, &branchInst->m_right};
-        } else if (auto jumpInst = dynamic_cast<JumpInst*>(lastInst.get())) {
+        } else if (auto jumpInst = dyn_cast<JumpInst>(lastInst)) {
             return {&jumpInst->m_next, nullptr};
-        } else if (auto returnInst = dynamic_cast<ReturnInst*>(lastInst.get())) {
+        } else if (auto returnInst = dyn_cast<ReturnInst>(lastInst)) {
             return {nullptr, nullptr};
         }
     }
@@ -39,17 +37,19 @@ std::array<BasicBlock**, 2> BasicBlock::getSuccsRef() {
 }
 
 void Value::replaceAllUse(Value* value) {
-    for (auto use : m_uses) {
-        use->set(value);
+    if (value == this) return;
+    // set会把use从当前链表摘下, 所以总是取表头
+    while (m_useHead) {
+        m_useHead->set(value);
     }
 }
 
 bool BasicBlock::valid() {
-    auto& tail = m_insts.back();
-    return (!m_insts.empty()) && (dynamic_cast<ReturnInst*>(tail.get()) || dynamic_cast<JumpInst*>(tail.get()) || dynamic_cast<BranchInst*>(tail.get()));
+    auto tail = m_insts.back();
+    return (!m_insts.empty()) && (isa<ReturnInst>(tail) || isa<JumpInst>(tail) || isa<BranchInst>(tail));
 }
 
-void printDimensions(std::ostream& os, std::vector<size_t>& dims) {
+static void printDimensions(DumpWriter& os, std::vector<size_t>& dims) {
     if (dims.empty()) {
         os << "i32";
     } else {
@@ -61,15 +61,15 @@ void printDimensions(std::ostream& os, std::vector<size_t>& dims) {
     }
 }
 
-void IrModule::toCode(std::ostream& os, bool isTest) {
+void IrModule::toCode(DumpWriter& os, bool isTest) {
     if (isTest) {
         os << s_rawPrintfCode << std::endl;
     } else {
-        for (auto& builtinFunc : s_builtinFuncs) {
+        for (auto& builtinFunc : m_builtinFuncs) {
             builtinFunc.second->toCode(os);
         }
     }
-    if (!s_usedBuiltinFuncs.empty()) {
+    if (!m_usedBuiltinFuncs.empty()) {
         os << std::endl;
     }
     for (auto& var : m_globalVariables) {
@@ -84,7 +84,7 @@ void IrModule::toCode(std::ostream& os, bool isTest) {
         printDimensions(os, dims);
         if (var.get()->m_globalItem->hasInit()) {
             os << " ";
-            var.get()->m_globalItem->dumpSymbolItem(os, false);
+            var.get()->m_globalItem->dumpSymbolItem(os.stream(), false);
         } else {
             os << " zeroinitializer";
         }
@@ -118,16 +118,93 @@ IrFunc* IrModule::getFunc(FuncItem* funcItem) {
     return nullptr;
 }
 
+ConstPool::ConstPool() {
+    int count = SMALL_MAX - SMALL_MIN + 1;
+    m_small = static_cast<ConstValue*>(::operator new(sizeof(ConstValue) * count));
+    for (int i = 0; i < count; i++) {
+        new (&m_small[i]) ConstValue(SMALL_MIN + i);
+    }
+}
+
+ConstPool::~ConstPool() {
+    for (auto value : m_table) {
+        delete value;
+    }
+    for (int i = 0; i < SMALL_MAX - SMALL_MIN + 1; i++) {
+        m_small[i].~ConstValue();
+    }
+    ::operator delete(m_small);
+}
+
+ConstValue* ConstPool::getLarge(int imm) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_table.empty()) {
+        rehash(64);
+    }
+    auto slot = findSlot(imm);
+    if (m_table[slot]) {
+        return m_table[slot];
+    }
+    // 装载因子保持在1/2以下
+    if ((m_size + 1) * 2 > m_table.size()) {
+        rehash(m_table.size() * 2);
+        slot = findSlot(imm);
+    }
+    m_size++;
+    return m_table[slot] = new ConstValue(imm);
+}
+
+// 返回imm所在的槽, 不存在时返回探测到的第一个空槽
+std::size_t ConstPool::findSlot(int imm) {
+    std::size_t mask = m_table.size() - 1;
+    std::uint32_t hash = static_cast<std::uint32_t>(imm) * 2654435769u;
+    for (std::size_t i = (hash ^ (hash >> 16)) & mask;; i = (i + 1) & mask) {
+        if (!m_table[i] || m_table[i]->getImm() == imm) {
+            return i;
+        }
+    }
+}
+
+void ConstPool::rehash(std::size_t capacity) {
+    std::vector<ConstValue*> old(capacity, nullptr);
+    old.swap(m_table);
+    for (auto value : old) {
+        if (value) {
+            m_table[findSlot(value->getImm())] = value;
+        }
+    }
+}
+
+IrContext::IrContext() :
+    irPasses{memToReg} {}
+
+IrModule::~IrModule() {
+    // 先断开所有操作数, 之后按任意顺序释放value时Use都不会再访问已释放的value
+    for (auto& func : m_funcs) {
+        func->dropAllReferences();
+    }
+}
+
+void IrFunc::dropAllReferences() {
+    for (auto bb : m_basicBlocks) {
+        for (auto inst : bb->m_insts) {
+            for (auto use : inst->getOperands()) {
+                use->set(nullptr);
+            }
+        }
+    }
+}
+
 void IrModule::calPredSucc() {
     for (auto& func : m_funcs) {
-        for (auto& bb : func->m_basicBlocks) {
+        for (auto bb : func->m_basicBlocks) {
             bb->getPreds().clear();
         }
-        for (auto& bb : func->m_basicBlocks) {
+        for (auto bb : func->m_basicBlocks) {
             // bb->getPreds().clear();
             for (auto* x : bb->getSuccs()) {
                 if (x) {
-                    x->getPreds().push_back(bb.get());
+                    x->getPreds().push_back(bb);
                 }
             }
         }
@@ -136,32 +213,60 @@ void IrModule::calPredSucc() {
 
 void IrModule::addImplicitReturn() {
     for (auto& func : m_funcs) {
-        auto& lastBlock = func->m_basicBlocks.back();
+        SlabArena::Scope arenaScope(func->m_arena);
+        auto lastBlock = func->m_basicBlocks.back();
         if (!lastBlock->valid()) {
             if (func->m_funcItem->getReturnValueType() == ValueTypeEnum::VOID_TYPE) {
                 lastBlock->pushBackInst(new ReturnInst(nullptr));
             } else {
-                lastBlock->pushBackInst(new ReturnInst(ConstValue::get(0)));
+                lastBlock->pushBackInst(new ReturnInst(getConst(0)));
             }
         }
     }
 }
 
-void IrModule::optimizeIrCode(int level) {
-    for (auto& pass : IrContext::s_irPasses) {
-        pass(*this);
-    }
+void IrModule::optimizeIrCode(int level, const std::vector<std::function<void(IrFunc*)>>& passes, ThreadPool* pool) {
+    parallelFor(pool, m_funcs.size(), [this, &passes](std::size_t i) {
+        auto func = m_funcs[i].get();
+        SlabArena::Scope arenaScope(func->getArena());
+        for (auto& pass : passes) {
+            pass(func);
+        }
+    });
 }
 
 IrFunc* IrModule::getBuiltinFunc(const std::string& funcName) {
-    IrFunc* func = s_builtinFuncs.at(funcName);
-    s_usedBuiltinFuncs.insert(func);
+    IrFunc* func = m_builtinFuncs.at(funcName).get();
+    std::lock_guard<std::mutex> lock(m_builtinMutex);
+    m_usedBuiltinFuncs.insert(func);
     return func;
 }
 
-void IrFunc::toCode(std::ostream& os) {
-    Value::s_valueMapper.reset();
-    BasicBlock::s_bbMapper.reset();
+int Inst::getId() {
+    if (m_id < 0) {
+        m_id = m_atBlock->getFunc()->allocId();
+    }
+    return m_id;
+}
+
+int Inst::allocTempId() {
+    return m_atBlock->getFunc()->allocId();
+}
+
+// 基本块按顺序编号; 指令的编号清空, 打印时按首次出现的顺序重新分配
+void IrFunc::renumber() {
+    m_idCount = 0;
+    int index = 0;
+    for (auto bb : m_basicBlocks) {
+        bb->m_id = index++;
+        for (auto inst : bb->m_insts) {
+            inst->m_id = -1;
+        }
+    }
+}
+
+void IrFunc::toCode(DumpWriter& os) {
+    renumber();
     std::string decl = m_isBuiltin ? "declare" : "define";
     std::string ret = m_funcItem->getReturnValueType() == ValueTypeEnum::INT_TYPE ? "i32" : "void";
     os << decl << " " << ret << " @";
@@ -208,18 +313,14 @@ void IrFunc::toCode(std::ostream& os) {
             }
         }
         os << "\tbr label %_b0" << std::endl;
-        for (auto& bb : m_basicBlocks) { // 按顺序标号
-            BasicBlock::s_bbMapper.get(bb.get());
-        }
-        for (auto& bb : m_basicBlocks) {
-            int index = BasicBlock::s_bbMapper.get(bb.get());
-            os << "_b" << index << ": ; preds = ";
+        for (auto bb : m_basicBlocks) {
+            os << "_b" << bb->m_id << ": ; preds = ";
             for (int i = 0; i < bb->m_pred.size(); ++i) {
                 if (i != 0) os << ", ";
-                os << "%_b" << BasicBlock::s_bbMapper.get(bb->m_pred[i]);
+                os << "%_b" << bb->m_pred[i]->getId();
             }
             os << std::endl;
-            for (auto& inst : bb->m_insts) {
+            for (auto inst : bb->m_insts) {
                 os << "\t";
                 inst->toCode(os);
             }
@@ -231,8 +332,8 @@ void IrFunc::toCode(std::ostream& os) {
     }
 }
 
-void AllocaInst::toCode(std::ostream& os) {
-    auto temp = Value::s_valueMapper.alloc();
+void AllocaInst::toCode(DumpWriter& os) {
+    auto temp = allocTempId();
     os << "%_t" << temp << " = alloca ";
     auto dims = getArrayItemDimensions(m_sym);
     printDimensions(os, dims);
@@ -251,10 +352,10 @@ void AllocaInst::toCode(std::ostream& os) {
     }
 };
 
-void GetElementPtrInst::toCode(std::ostream& os) {
-    os << "; getelementptr " << Value::s_valueMapper.get(this) << std::endl
+void GetElementPtrInst::toCode(DumpWriter& os) {
+    os << "; getelementptr " << getId() << std::endl
        << "\t";
-    if (auto index = dynamic_cast<ConstValue*>(m_index.value)) {
+    if (auto index = dyn_cast<ConstValue>(m_index.value)) {
         int res = index->getImm() * m_multiplier;
         printValue(os);
         os << " = getelementptr inbounds ";
@@ -264,7 +365,7 @@ void GetElementPtrInst::toCode(std::ostream& os) {
         }
         os << ", i32 " << res << std::endl;
     } else {
-        int temp = Value::s_valueMapper.alloc();
+        int temp = allocTempId();
         if (m_multiplier == 1) {
             os << "\t";
             printValue(os);
@@ -286,12 +387,12 @@ void GetElementPtrInst::toCode(std::ostream& os) {
     }
 }
 
-void StoreInst::toCode(std::ostream& os) {
-    os << "; store " << Value::s_valueMapper.get(this) << std::endl
+void StoreInst::toCode(DumpWriter& os) {
+    os << "; store " << getId() << std::endl
        << "\t";
     // temp ptr
-    if (dynamic_cast<ConstValue*>(m_index.value)->getImm() != 0) {
-        int temp = Value::s_valueMapper.alloc();
+    if (cast<ConstValue>(m_index.value)->getImm() != 0) {
+        int temp = allocTempId();
         os << "%_t" << temp << " = getelementptr inbounds i32, i32* ";
         m_arr.value->printValue(os);
         os << ", i32 ";
@@ -313,10 +414,10 @@ void StoreInst::toCode(std::ostream& os) {
     }
 }
 
-void LoadInst::toCode(std::ostream& os) {
+void LoadInst::toCode(DumpWriter& os) {
     // temp ptr
-    if (dynamic_cast<ConstValue*>(m_index.value)->getImm() != 0) {
-        int temp = Value::s_valueMapper.alloc();
+    if (cast<ConstValue>(m_index.value)->getImm() != 0) {
+        int temp = allocTempId();
         os << "%_t" << temp << " = getelementptr inbounds i32, i32* ";
         if (m_arr.value) {
             m_arr.value->printValue(os);
@@ -337,11 +438,11 @@ void LoadInst::toCode(std::ostream& os) {
     }
 }
 
-void BinaryInst::toCode(std::ostream& os) {
+void BinaryInst::toCode(DumpWriter& os) {
     auto op_name = LLVM_OPS[(int)m_type];
     bool conversion = IRType::Lt <= m_type && m_type <= IRType::Ne;
     if (conversion) {
-        int temp = Value::s_valueMapper.alloc();
+        int temp = allocTempId();
         os << "%_t" << temp << " = " << op_name << " i32 ";
         m_lhs.value->printValue(os);
         os << ", ";
@@ -367,25 +468,25 @@ void BinaryInst::toCode(std::ostream& os) {
     }
 }
 
-void JumpInst::toCode(std::ostream& os) {
-    os << "br label %_b" << BasicBlock::s_bbMapper.get(m_next) << std::endl;
+void JumpInst::toCode(DumpWriter& os) {
+    os << "br label %_b" << m_next->getId() << std::endl;
 }
 
-void BranchInst::toCode(std::ostream& os) {
+void BranchInst::toCode(DumpWriter& os) {
     // add comment
     os << "; if ";
     m_cond.value->printValue(os);
-    os << " then _b" << BasicBlock::s_bbMapper.get(m_left) << " else _b"
-       << BasicBlock::s_bbMapper.get(m_right) << std::endl;
-    int temp = Value::s_valueMapper.alloc();
+    os << " then _b" << m_left->getId() << " else _b"
+       << m_right->getId() << std::endl;
+    int temp = allocTempId();
     os << "\t%_t" << temp << " = icmp ne i32 ";
     m_cond.value->printValue(os);
     os << ", 0" << std::endl;
-    os << "\tbr i1 %_t" << temp << ", label %_b" << BasicBlock::s_bbMapper.get(m_left) << ", label %_b"
-       << BasicBlock::s_bbMapper.get(m_right) << std::endl;
+    os << "\tbr i1 %_t" << temp << ", label %_b" << m_left->getId() << ", label %_b"
+       << m_right->getId() << std::endl;
 }
 
-void ReturnInst::toCode(std::ostream& os) {
+void ReturnInst::toCode(DumpWriter& os) {
     if (m_ret.value) {
         os << "ret i32 ";
         m_ret.value->printValue(os);
@@ -395,7 +496,7 @@ void ReturnInst::toCode(std::ostream& os) {
     }
 }
 
-void CallInst::toCode(std::ostream& os) {
+void CallInst::toCode(DumpWriter& os) {
     FuncItem* callee = m_func->getFuncItem();
     if (callee->getReturnValueType() == ValueTypeEnum::INT_TYPE) {
         printValue(os);
@@ -432,7 +533,7 @@ void CallInst::toCode(std::ostream& os) {
     os << ")" << std::endl;
 }
 
-void PhiInst::toCode(std::ostream& os) {
+void PhiInst::toCode(DumpWriter& os) {
     printValue(os);
     os << " = phi i32 ";
     for (int i = 0; i < m_incomingValues.size(); ++i) {
@@ -443,19 +544,19 @@ void PhiInst::toCode(std::ostream& os) {
         } else {
             os << "undef";
         }
-        os << ", %_b" << BasicBlock::s_bbMapper.get(m_atBlock->getPreds()[i]) << "]";
+        os << ", %_b" << m_atBlock->getPreds()[i]->getId() << "]";
     }
     os << std::endl;
 }
 
-void PrintInst::printPutInt(const Use& arg, std::ostream& os) {
+void PrintInst::printPutInt(const Use& arg, DumpWriter& os) {
     os << "call void @putint(i32 ";
     arg.value->printValue(os);
     os << ")" << std::endl;
 }
 
-void PrintInst::printPutStr(StringVariable* strPart, std::ostream& os) {
-    auto temp = Value::s_valueMapper.alloc();
+void PrintInst::printPutStr(StringVariable* strPart, DumpWriter& os) {
+    auto temp = allocTempId();
     os << "%_t" << temp << " = getelementptr inbounds ";
     strPart->printStrType(os);
     os << ", ";
@@ -467,7 +568,7 @@ void PrintInst::printPutStr(StringVariable* strPart, std::ostream& os) {
        << "%_t" << temp << ")" << std::endl;
 }
 
-void PrintInst::toCode(std::ostream& os) {
+void PrintInst::toCode(DumpWriter& os) {
     int partsNum = m_strParts.size();
     if (partsNum == 0) { // 只有 %d
         bool flag = true;
@@ -498,10 +599,10 @@ void PrintInst::toCode(std::ostream& os) {
     }
 }
 
-void StringVariable::printStrType(std::ostream& os) {
+void StringVariable::printStrType(DumpWriter& os) {
     os << "[" << m_len << " x i8]";
 }
 
-void StringVariable::printString(std::ostream& os) {
+void StringVariable::printString(DumpWriter& os) {
     os << "c\"" << m_str << "\"";
 }
\ No newline at end of file
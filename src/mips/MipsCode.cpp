@@ -1,12 +1,11 @@
 #include <mips/MipsCode.h>
 #include <ir/Printf.h>
-IndexMapper<MipsBasicBlock> MipsBasicBlock::s_bbMapper;
 
-static void moveStack(bool enter, int offset, std::ostream& os, bool hasTab = false) {
+static void moveStack(bool enter, int offset, DumpWriter& os, bool hasTab = false) {
     os << (hasTab ? "\t" : "") << (enter ? "subu " : "addu ") << "$sp, $sp, " << offset << std::endl;
 }
 
-void MipsModule::toCode(std::ostream& os) {
+void MipsModule::toCode(DumpWriter& os) {
     int size = 0;
     os << ".data" << std::endl;
     for (auto& glob : m_globs) {
@@ -38,15 +37,25 @@ void MipsModule::toCode(std::ostream& os) {
             break;
         }
     }
+    // 标号在整个模块内唯一, 按输出顺序连续编号
+    int nextId = mainFunc->renumber(0);
     mainFunc->toCode(os);
     for (auto& func : m_funcs) {
         if (func.get() != mainFunc) {
+            nextId = func->renumber(nextId);
             func->toCode(os);
         }
     }
 }
 
-void MipsFunc::toCode(std::ostream& os) {
+int MipsFunc::renumber(int firstId) {
+    for (auto& mbb : m_basicBlocks) {
+        mbb->m_id = firstId++;
+    }
+    return firstId;
+}
+
+void MipsFunc::toCode(DumpWriter& os) {
     os << m_irFunc->getFuncItem()->getName() << ":" << std::endl;
     if (!m_isMainFunc) {
         auto savedRegSize = usedCalleeSavedRegs.size();
@@ -62,18 +71,15 @@ void MipsFunc::toCode(std::ostream& os) {
             moveStack(true, m_stackSize, os, true);
         }
     }
-    for (auto& mbb : m_basicBlocks) {
-        MipsBasicBlock::s_bbMapper.get(mbb.get());
-    }
     for (auto& mbb : m_basicBlocks) {
         mbb->toCode(os);
     }
     os << std::endl;
 }
 
-void MipsBasicBlock::toCode(std::ostream& os) {
-    os << ".b" << MipsBasicBlock::s_bbMapper.get(this) << ":" << std::endl;
-    for (auto& inst : m_insts) {
+void MipsBasicBlock::toCode(DumpWriter& os) {
+    os << ".b" << m_id << ":" << std::endl;
+    for (auto inst : m_insts) {
         if (!inst->isUseless()) {
             os << "\t";
             inst->toCode(os);
@@ -82,34 +88,34 @@ void MipsBasicBlock::toCode(std::ostream& os) {
     os << std::endl;
 }
 
-void MipsGlobal::toCode(std::ostream& os) {
+void MipsGlobal::toCode(DumpWriter& os) {
     os << "la " << m_dst << ", " << m_sym->getName() << std::endl;
 }
 
-void MipsString::toCode(std::ostream& os) {
+void MipsString::toCode(DumpWriter& os) {
     os << "la " << m_dst << ", " << m_strVar->getName() << std::endl;
 }
 
-void MipsMove::toCode(std::ostream& os) {
+void MipsMove::toCode(DumpWriter& os) {
     if (m_rhs.isImm()) {
         os << "li " << m_dst << ", " << m_rhs << std::endl;
     } else {
         os << "move " << m_dst << ", " << m_rhs << std::endl;
     }
 }
-void MipsShift::toCode(std::ostream& os) {
+void MipsShift::toCode(DumpWriter& os) {
     os << m_shiftKind << " " << m_dst << ", " << m_lhs << ", " << m_shift << std::endl;
 }
 
-void MipsBranch::toCode(std::ostream& os) {
+void MipsBranch::toCode(DumpWriter& os) {
     os << "beq " << m_lhs << ", " << m_rhs << ", "
-       << ".b" << MipsBasicBlock::s_bbMapper.get(m_target) << std::endl;
+       << ".b" << m_target->getId() << std::endl;
 }
-void MipsJump::toCode(std::ostream& os) {
+void MipsJump::toCode(DumpWriter& os) {
     os << "j "
-       << ".b" << MipsBasicBlock::s_bbMapper.get(m_target) << std::endl;
+       << ".b" << m_target->getId() << std::endl;
 }
-void MipsReturn::toCode(std::ostream& os) {
+void MipsReturn::toCode(DumpWriter& os) {
     if (m_retFunc->getIrFunc()->getFuncItem()->getName() == "main") {
         os << "li $v0, 10\n"
            << "\tsyscall\n";
@@ -130,53 +136,54 @@ void MipsReturn::toCode(std::ostream& os) {
         os << "jr $ra" << std::endl;
     }
 }
-void MipsLoad::toCode(std::ostream& os) {
+void MipsLoad::toCode(DumpWriter& os) {
     os << "lw " << m_dst << ", " << m_offset << "(" << m_addr << ")" << std::endl;
 }
-void MipsStore::toCode(std::ostream& os) {
+void MipsStore::toCode(DumpWriter& os) {
     os << "sw " << m_data << ", " << m_offset << "(" << m_addr << ")" << std::endl;
 }
-void MipsCompare::toCode(std::ostream& os) {
+void MipsCompare::toCode(DumpWriter& os) {
     std::string imm = " ";
     if (m_rhs.isImm() && m_cond == MipsCond::Lt) { // slti
         imm = "i ";
     }
     os << m_cond << imm << m_dst << ", " << m_lhs << ", " << m_rhs << std::endl;
 }
-void MipsCall::toCode(std::ostream& os) {
+void MipsCall::toCode(DumpWriter& os) {
     os << "jal " << m_func->getName() << std::endl;
 }
-void MipsSysCall::toCode(std::ostream& os) {
+void MipsSysCall::toCode(DumpWriter& os) {
     os << "syscall" << std::endl;
 }
-void MipsBinary::toCode(std::ostream& os) {
+void MipsBinary::toCode(DumpWriter& os) {
     os << instString() << " " << m_dst << ", " << m_lhs << ", " << m_rhs << std::endl;
 }
 
-std::pair<std::vector<MipsOperand>, std::vector<MipsOperand>> getDefUse(MipsInst* inst) {
-    std::vector<MipsOperand> def;
-    std::vector<MipsOperand> use;
+MipsDefUse getDefUse(MipsInst* inst) {
+    MipsDefUse ret;
+    auto& def = ret.first;
+    auto& use = ret.second;
 
-    if (auto x = dynamic_cast<MipsBinary*>(inst)) {
+    if (auto x = dyn_cast<MipsBinary>(inst)) {
         def = {x->m_dst};
         use = {x->m_lhs, x->m_rhs};
-    } else if (auto x = dynamic_cast<MipsMove*>(inst)) {
+    } else if (auto x = dyn_cast<MipsMove>(inst)) {
         def = {x->m_dst};
         use = {x->m_rhs};
-    } else if (auto x = dynamic_cast<MipsLoad*>(inst)) {
+    } else if (auto x = dyn_cast<MipsLoad>(inst)) {
         def = {x->m_dst};
         use = {x->m_addr};
-    } else if (auto x = dynamic_cast<MipsStore*>(inst)) {
+    } else if (auto x = dyn_cast<MipsStore>(inst)) {
         use = {x->m_data, x->m_addr};
-    } else if (auto x = dynamic_cast<MipsCompare*>(inst)) {
+    } else if (auto x = dyn_cast<MipsCompare>(inst)) {
         def = {x->m_dst};
         use = {x->m_lhs, x->m_rhs};
-    } else if (auto x = dynamic_cast<MipsShift*>(inst)) {
+    } else if (auto x = dyn_cast<MipsShift>(inst)) {
         def = {x->m_dst};
         use = {x->m_lhs};
-    } else if (auto x = dynamic_cast<MipsBranch*>(inst)) {
+    } else if (auto x = dyn_cast<MipsBranch>(inst)) {
         use = {x->m_lhs, x->m_rhs};
-    } else if (auto x = dynamic_cast<MipsCall*>(inst)) {
+    } else if (auto x = dyn_cast<MipsCall>(inst)) {
         // args (also caller save)
         for (int i = (int)MipsReg::a0; i < (int)MipsReg::a0 + std::min(x->m_func->getParams().size(), (size_t)4); ++i) {
             use.push_back(MipsOperand::R((MipsReg)i));
@@ -186,46 +193,47 @@ std::pair<std::vector<MipsOperand>, std::vector<MipsOperand>> getDefUse(MipsInst
         }
         def.push_back(MipsOperand::R(MipsReg::sp));
         //def.push_back(MipsOperand::R(MipsReg::ip));
-    } else if (auto x = dynamic_cast<MipsGlobal*>(inst)) {
+    } else if (auto x = dyn_cast<MipsGlobal>(inst)) {
         def = {x->m_dst};
-    } else if (auto x = dynamic_cast<MipsString*>(inst)) {
+    } else if (auto x = dyn_cast<MipsString>(inst)) {
         def = {x->m_dst};
-    } else if (dynamic_cast<MipsReturn*>(inst)) {
+    } else if (isa<MipsReturn>(inst)) {
         // ret
         use.push_back(MipsOperand::R(MipsReg::v0));
     }
-    return {def, use};
+    return ret;
 }
 
-std::pair<MipsOperand*, std::vector<MipsOperand*>> getDefUsePtr(MipsInst* inst) {
-    MipsOperand* def = nullptr;
-    std::vector<MipsOperand*> use;
+MipsDefUsePtr getDefUsePtr(MipsInst* inst) {
+    MipsDefUsePtr ret{nullptr, {}};
+    auto& def = ret.first;
+    auto& use = ret.second;
 
-    if (auto x = dynamic_cast<MipsBinary*>(inst)) {
+    if (auto x = dyn_cast<MipsBinary>(inst)) {
         def = &x->m_dst;
         use = {&x->m_lhs, &x->m_rhs};
-    } else if (auto x = dynamic_cast<MipsMove*>(inst)) {
+    } else if (auto x = dyn_cast<MipsMove>(inst)) {
         def = &x->m_dst;
         use = {&x->m_rhs};
-    } else if (auto x = dynamic_cast<MipsLoad*>(inst)) {
+    } else if (auto x = dyn_cast<MipsLoad>(inst)) {
         def = &x->m_dst;
         use = {&x->m_addr};
-    } else if (auto x = dynamic_cast<MipsStore*>(inst)) {
+    } else if (auto x = dyn_cast<MipsStore>(inst)) {
         use = {&x->m_data, &x->m_addr};
-    } else if (auto x = dynamic_cast<MipsCompare*>(inst)) {
+    } else if (auto x = dyn_cast<MipsCompare>(inst)) {
         def = {&x->m_dst};
         use = {&x->m_lhs, &x->m_rhs};
-    } else if (auto x = dynamic_cast<MipsShift*>(inst)) {
+    } else if (auto x = dyn_cast<MipsShift>(inst)) {
         def = {&x->m_dst};
         use = {&x->m_lhs};
-    } else if (auto x = dynamic_cast<MipsBranch*>(inst)) {
+    } else if (auto x = dyn_cast<MipsBranch>(inst)) {
         use = {&x->m_lhs, &x->m_rhs};
-    } else if (dynamic_cast<MipsCall*>(inst)) {
+    } else if (isa<MipsCall>(inst)) {
         // intentionally blank
-    } else if (auto x = dynamic_cast<MipsGlobal*>(inst)) {
+    } else if (auto x = dyn_cast<MipsGlobal>(inst)) {
         def = {&x->m_dst};
-    } else if (auto x = dynamic_cast<MipsString*>(inst)) {
+    } else if (auto x = dyn_cast<MipsString>(inst)) {
         def = {&x->m_dst};
     }
-    return {def, use};
+    return ret;
 }
\ No newline at end of file
@@ -1,7 +1,7 @@
 #include <mips/MipsContext.h>
 #include <Log.h>
 #include <optimize/MipsOptPass.h>
-std::vector<std::function<void(MipsModule&)>> MipsContext::s_mipsPasses{allocateRegister, computeStackInfo, peepholeOpt};
+#include <ThreadPool.h>
 
 static inline void insertParallelMv(std::vector<std::pair<MipsOperand, MipsOperand>>& movs, MipsInst* insertBefore) {
     // serialization in any order is okay
@@ -11,68 +11,76 @@ static inline void insertParallelMv(std::vector<std::pair<MipsOperand, MipsOpera
     }
 }
 
-void MipsContext::convertMipsCode(IrModule& irModule) {
+MipsContext::MipsContext() :
+    m_mipsPasses{allocateRegister, computeStackInfo, peepholeOpt} {}
+
+void MipsContext::convertMipsCode(IrModule& irModule, ThreadPool* pool) {
     for (auto& glob : irModule.m_globalVariables) {
         m_module.addGlob(glob.get());
     }
     for (auto& str : irModule.m_strVariables) {
         m_module.addStr(str.get());
     }
+    // 先按顺序创建全部MipsFunc, 并行翻译时不再修改模块
     for (auto& irFunc : irModule.m_funcs) {
-        m_bbMap.clear();
-        m_valMap.clear();
-        m_globMap.clear();
-        m_paramMap.clear();
-        m_condMap.clear();
-        m_virtualMax = 0;
-        m_irFunc = irFunc.get();
-        m_mipsFunc = m_module.addFunc(new MipsFunc(irFunc.get()));
-        mapBasicBlocks();
-        for (auto& basicBlock : m_irFunc->m_basicBlocks) {
-            m_basicBlock = basicBlock.get();
-            m_mipsBasicBlock = m_bbMap.at(m_basicBlock);
-            for (auto& inst : m_basicBlock->m_insts) {
-                convertInst(inst.get());
-            }
-        }
-        for (auto& basicBlock : m_irFunc->m_basicBlocks) {
-            m_basicBlock = basicBlock.get();
-            m_mipsBasicBlock = m_bbMap.at(m_basicBlock);
-            m_lhs.clear();
-            m_mv.clear();
-            for (auto& inst : m_basicBlock->m_insts) {
-                // phi insts must appear at the beginning of bb
-                if (auto phiInst = dynamic_cast<PhiInst*>(inst.get())) {
-                    convertPhiInst(phiInst);
-                } else {
-                    break;
-                }
-            }
-            // insert parallel mv at the beginning of current mbb
-            insertParallelMv(m_lhs, m_mipsBasicBlock->getFrontInst());
-            for (auto& pair : m_mv) {
-                auto mbb = m_bbMap[pair.first];
-                insertParallelMv(pair.second, mbb->getControlTransferInst());
-            }
-        }
-        m_mipsFunc->setVirtualMax(m_virtualMax);
+        m_module.addFunc(new MipsFunc(irFunc.get()));
     }
+    parallelFor(pool, irModule.m_funcs.size(), [this, &irModule](std::size_t i) {
+        MipsFuncConverter(irModule.m_funcs[i].get(), m_module.m_funcs[i].get()).convert();
+    });
 }
 
-void MipsContext::optimizeMipsCode(int optLevel) {
-    for (auto& pass : s_mipsPasses) {
-        pass(m_module);
+void MipsContext::optimizeMipsCode(int optLevel, ThreadPool* pool) {
+    parallelFor(pool, m_module.m_funcs.size(), [this](std::size_t i) {
+        auto func = m_module.m_funcs[i].get();
+        SlabArena::Scope arenaScope(func->getArena());
+        for (auto& pass : m_mipsPasses) {
+            pass(func);
+        }
+    });
+}
+
+void MipsFuncConverter::convert() {
+    SlabArena::Scope arenaScope(m_mipsFunc->getArena());
+    mapBasicBlocks();
+    for (auto basicBlock : m_irFunc->m_basicBlocks) {
+        m_basicBlock = basicBlock;
+        m_mipsBasicBlock = m_bbMap.at(m_basicBlock);
+        for (auto inst : m_basicBlock->m_insts) {
+            convertInst(inst);
+        }
+    }
+    for (auto basicBlock : m_irFunc->m_basicBlocks) {
+        m_basicBlock = basicBlock;
+        m_mipsBasicBlock = m_bbMap.at(m_basicBlock);
+        m_lhs.clear();
+        m_mv.clear();
+        for (auto inst : m_basicBlock->m_insts) {
+            // phi insts must appear at the beginning of bb
+            if (auto phiInst = dyn_cast<PhiInst>(inst)) {
+                convertPhiInst(phiInst);
+            } else {
+                break;
+            }
+        }
+        // insert parallel mv at the beginning of current mbb
+        insertParallelMv(m_lhs, m_mipsBasicBlock->getFrontInst());
+        for (auto& pair : m_mv) {
+            auto mbb = m_bbMap[pair.first];
+            insertParallelMv(pair.second, mbb->getControlTransferInst());
+        }
     }
+    m_mipsFunc->setVirtualMax(m_virtualMax);
 }
 
-MipsOperand MipsContext::genNewVirtualReg() {
+MipsOperand MipsFuncConverter::genNewVirtualReg() {
     return MipsOperand::V(m_virtualMax++);
 }
 
-MipsOperand MipsContext::resolveValue(Value* value) {
+MipsOperand MipsFuncConverter::resolveValue(Value* value) {
     auto type = value->getIrType();
     if (type == IRType::Param) {
-        auto param = dynamic_cast<ParamVariable*>(value);
+        auto param = cast<ParamVariable>(value);
         auto paramItem = param->getParamItem();
         auto funcItem = m_irFunc->getFuncItem();
         auto it = m_paramMap.find(param);
@@ -103,7 +111,7 @@ MipsOperand MipsContext::resolveValue(Value* value) {
             return it->second;
         }
     } else if (type == IRType::Global) {
-        auto global = dynamic_cast<GlobalVariable*>(value);
+        auto global = cast<GlobalVariable>(value);
         auto it = m_globMap.find(global);
         if (it == m_globMap.end()) {
             // load global addr in entry bb
@@ -118,7 +126,7 @@ MipsOperand MipsContext::resolveValue(Value* value) {
             return it->second;
         }
     } else if (type == IRType::Const) {
-        auto cons = dynamic_cast<ConstValue*>(value);
+        auto cons = cast<ConstValue>(value);
         return MipsOperand::I(cons->getImm());
     } else {
         auto it = m_valMap.find(value);
@@ -133,8 +141,8 @@ MipsOperand MipsContext::resolveValue(Value* value) {
     }
 }
 
-MipsOperand MipsContext::resolveNoImm(Value* value) {
-    if (auto cons = dynamic_cast<ConstValue*>(value)) {
+MipsOperand MipsFuncConverter::resolveNoImm(Value* value) {
+    if (auto cons = dyn_cast<ConstValue>(value)) {
         auto res = genNewVirtualReg();
         auto moveInst = m_mipsBasicBlock->pushBackInst(new MipsMove(res, MipsOperand::I(cons->getImm())));
         return res;
@@ -143,15 +151,15 @@ MipsOperand MipsContext::resolveNoImm(Value* value) {
     }
 }
 
-void MipsContext::mapBasicBlocks() {
+void MipsFuncConverter::mapBasicBlocks() {
     m_bbMap.clear();
-    for (auto& bb : m_irFunc->m_basicBlocks) {
-        auto mbb = m_mipsFunc->pushBackBasicBlock(new MipsBasicBlock(bb.get()));
-        m_bbMap.insert({bb.get(), mbb});
+    for (auto bb : m_irFunc->m_basicBlocks) {
+        auto mbb = m_mipsFunc->pushBackBasicBlock(new MipsBasicBlock(bb));
+        m_bbMap.insert({bb, mbb});
     }
     // maintain pred and succ
-    for (auto& bb : m_irFunc->m_basicBlocks) {
-        auto mbb = m_bbMap.at(bb.get());
+    for (auto bb : m_irFunc->m_basicBlocks) {
+        auto mbb = m_bbMap.at(bb);
         mbb->getPreds().reserve(bb->getPreds().size());
         // at most two successor
         auto succ = bb->getSuccs();
@@ -168,37 +176,37 @@ void MipsContext::mapBasicBlocks() {
     }
 }
 
-void MipsContext::convertInst(Inst* inst) {
+void MipsFuncConverter::convertInst(Inst* inst) {
     switch (inst->getIrType()) {
     case IRType::Jump:
-        convertJumpInst(dynamic_cast<JumpInst*>(inst));
+        convertJumpInst(cast<JumpInst>(inst));
         break;
     case IRType::Load:
-        convertLoadInst(dynamic_cast<LoadInst*>(inst));
+        convertLoadInst(cast<LoadInst>(inst));
         break;
     case IRType::Store:
-        convertStoreInst(dynamic_cast<StoreInst*>(inst));
+        convertStoreInst(cast<StoreInst>(inst));
         break;
     case IRType::GetElementPtr:
-        convertGetElementPtrInst(dynamic_cast<GetElementPtrInst*>(inst));
+        convertGetElementPtrInst(cast<GetElementPtrInst>(inst));
         break;
     case IRType::Return:
-        convertReturnInst(dynamic_cast<ReturnInst*>(inst));
+        convertReturnInst(cast<ReturnInst>(inst));
         break;
     case IRType::Branch:
-        convertBranchInst(dynamic_cast<BranchInst*>(inst));
+        convertBranchInst(cast<BranchInst>(inst));
         break;
     case IRType::Call:
-        convertCallInst(dynamic_cast<CallInst*>(inst));
+        convertCallInst(cast<CallInst>(inst));
         break;
     case IRType::Alloca:
-        convertAllocaInst(dynamic_cast<AllocaInst*>(inst));
+        convertAllocaInst(cast<AllocaInst>(inst));
         break;
     case IRType::Add... IRType::Or:
-        convertBinaryInst(dynamic_cast<BinaryInst*>(inst));
+        convertBinaryInst(cast<BinaryInst>(inst));
         break;
     case IRType::Print:
-        convertPrintInst(dynamic_cast<PrintInst*>(inst));
+        convertPrintInst(cast<PrintInst>(inst));
         break;
     case IRType::Phi:
         break;
@@ -208,13 +216,13 @@ void MipsContext::convertInst(Inst* inst) {
     }
 }
 
-void MipsContext::convertJumpInst(JumpInst* inst) {
+void MipsFuncConverter::convertJumpInst(JumpInst* inst) {
     auto next = m_bbMap.at(inst->getNextBasicBlock());
     auto jumpinst = m_mipsBasicBlock->pushBackInst(new MipsJump(next));
     m_mipsBasicBlock->setControlTransferInst(jumpinst);
 }
 
-void MipsContext::convertLoadInst(LoadInst* inst) {
+void MipsFuncConverter::convertLoadInst(LoadInst* inst) {
     auto arr = resolveValue(inst->getArrValue());
     auto index = resolveValue(inst->getIndexValue());
     if (index.isImm()) {
@@ -226,7 +234,7 @@ void MipsContext::convertLoadInst(LoadInst* inst) {
     }
 }
 
-void MipsContext::convertStoreInst(StoreInst* inst) {
+void MipsFuncConverter::convertStoreInst(StoreInst* inst) {
     auto arr = resolveValue(inst->getArrValue());
     auto data = resolveNoImm(inst->getDataValue());
     auto index = resolveValue(inst->getIndexValue());
@@ -239,12 +247,12 @@ void MipsContext::convertStoreInst(StoreInst* inst) {
     }
 }
 
-void MipsContext::convertGetElementPtrInst(GetElementPtrInst* inst) {
+void MipsFuncConverter::convertGetElementPtrInst(GetElementPtrInst* inst) {
     // dst = getelementptr arr, index, multiplier
     auto dst = resolveValue(inst);
     auto arr = resolveValue(inst->getArrValue());
     auto mult = inst->getMultiplier() * 4;
-    auto constant = dynamic_cast<ConstValue*>(inst->getIndexValue());
+    auto constant = dyn_cast<ConstValue>(inst->getIndexValue());
 
     if (mult == 0 || (constant && constant->getImm() == 0)) {
         // dst <- arr
@@ -271,7 +279,7 @@ void MipsContext::convertGetElementPtrInst(GetElementPtrInst* inst) {
     }
 }
 
-void MipsContext::convertReturnInst(ReturnInst* inst) {
+void MipsFuncConverter::convertReturnInst(ReturnInst* inst) {
     if (inst->getReturnValue()) {
         auto val = resolveValue(inst->getReturnValue());
         // move val to v0
@@ -284,7 +292,7 @@ void MipsContext::convertReturnInst(ReturnInst* inst) {
     }
 }
 
-void MipsContext::convertBranchInst(BranchInst* inst) {
+void MipsFuncConverter::convertBranchInst(BranchInst* inst) {
     MipsOperand compareRes{};
     auto it = m_condMap.find(inst->getCondValue());
     if (it != m_condMap.end()) {
@@ -306,18 +314,18 @@ void MipsContext::convertBranchInst(BranchInst* inst) {
     m_mipsBasicBlock->setControlTransferInst(branch);
 }
 
-void MipsContext::convertCallInst(CallInst* inst) {
+void MipsFuncConverter::convertCallInst(CallInst* inst) {
     std::vector<MipsOperand> params;
-    auto args = inst->getArgsValue();
+    auto& args = inst->getArgs();
     int n = args.size();
     for (int i = 0; i < n; i++) {
         if (i < 4) {
             // move args to a0-a3
-            auto rhs = resolveValue(args[i]);
+            auto rhs = resolveValue(args[i].value);
             m_mipsBasicBlock->pushBackInst(new MipsMove(MipsOperand::R(MipsReg((int)MipsReg::a0 + i)), rhs));
         } else {
             // store to sp-(n-i)*4
-            auto rhs = resolveNoImm(args[i]);
+            auto rhs = resolveNoImm(args[i].value);
             m_mipsBasicBlock->pushBackInst(new MipsStore(rhs, MipsOperand::R(MipsReg::sp), (-(n - i)) << 2));
         }
     }
@@ -347,7 +355,7 @@ void MipsContext::convertCallInst(CallInst* inst) {
     }
 }
 
-void MipsContext::convertAllocaInst(AllocaInst* inst) {
+void MipsFuncConverter::convertAllocaInst(AllocaInst* inst) {
     size_t size = 1;
     auto sym = inst->getSym();
     auto dims = getArrayItemDimensions(sym);
@@ -362,13 +370,13 @@ void MipsContext::convertAllocaInst(AllocaInst* inst) {
     m_mipsFunc->addStackSize(size);
 }
 
-void MipsContext::convertBinaryInst(BinaryInst* inst) {
+void MipsFuncConverter::convertBinaryInst(BinaryInst* inst) {
     MipsOperand rhs{};
     auto rhsIsConst = inst->getRhsValue()->getIrType() == IRType::Const;
     auto lhs = resolveNoImm(inst->getLhsValue());
     // try to use imm
     if (rhsIsConst) {
-        int imm = dynamic_cast<ConstValue*>(inst->getRhsValue())->getImm();
+        int imm = cast<ConstValue>(inst->getRhsValue())->getImm();
         if (inst->getIrType() == IRType::Div && imm > 0) {
             auto dst = resolveValue(inst);
             int log = __builtin_ctz(imm);
@@ -386,7 +394,7 @@ void MipsContext::convertBinaryInst(BinaryInst* inst) {
         }
     }
     if (inst->rhsCanBeImm() && rhsIsConst) {
-        int imm = dynamic_cast<ConstValue*>(inst->getRhsValue())->getImm();
+        int imm = cast<ConstValue>(inst->getRhsValue())->getImm();
         rhs = MipsOperand::I(imm); // might be imm or register
     } else {
         rhs = resolveNoImm(inst->getRhsValue());
@@ -397,7 +405,7 @@ void MipsContext::convertBinaryInst(BinaryInst* inst) {
         auto uses = inst->getUses();
         auto nextInst = m_basicBlock->nextInst(inst);
         auto cmpInst = m_mipsBasicBlock->pushBackInst(new MipsCompare(cond, compareRes, lhs, rhs));
-        if (!uses.empty() && dynamic_cast<BranchInst*>(uses[0]->user) && nextInst == uses[0]->user) { // 存在使用compareRes 的BranchInst
+        if (!uses.empty() && isa<BranchInst>(uses.front()->user) && nextInst == uses.front()->user) { // 存在使用compareRes 的BranchInst
             m_condMap.insert({inst, {cmpInst, compareRes}});
         }
     } else {
@@ -406,17 +414,17 @@ void MipsContext::convertBinaryInst(BinaryInst* inst) {
     }
 }
 
-void MipsContext::convertPhiInst(PhiInst* inst) {
+void MipsFuncConverter::convertPhiInst(PhiInst* inst) {
     // for each phi:
     // lhs = phi [r1 bb1], [r2 bb2] ...
     // 1. create vreg for each inst
     // 2. add parallel mv (lhs1, ...) = (vreg1, ...)
     // 3. add parallel mv in each bb: (vreg1, ...) = (r1, ...)
-    auto incomingValues = inst->getIncomingValues();
+    auto& incomingValues = inst->getIncomingValues();
     if (!std::any_of(incomingValues.begin(), incomingValues.end(), [](Use& use) { return use.value == nullptr; })) {
         auto vreg = genNewVirtualReg();
         m_lhs.emplace_back(resolveValue(inst), vreg);
-        auto predBBs = inst->getAtBlock()->getPreds();
+        auto& predBBs = inst->getAtBlock()->getPreds();
         for (int i = 0; i < incomingValues.size(); i++) {
             auto predBB = predBBs[i];
             auto currBB = m_mipsBasicBlock;
@@ -428,7 +436,7 @@ void MipsContext::convertPhiInst(PhiInst* inst) {
     }
 }
 
-void MipsContext::convertPrintInst(PrintInst* inst) {
+void MipsFuncConverter::convertPrintInst(PrintInst* inst) {
     int partsNum = inst->m_strParts.size();
     if (partsNum == 0) { // 只有 %d
         for (auto& arg : inst->m_args) {
@@ -17,11 +17,11 @@ void basicBlockOpt(IrFunc* func) {
         changed = false;
         // 这个循环本来只是为了消除if (常数)，没有必要放在do while里的，但是在这里消除if (x) br a else br a也比较方便
         // 后面这种情形会被下面的循环引入，所以这个循环也放在do while里
-        for (auto& bb : func->getBasicBlocks()) {
-            auto& back = bb->getInsts().back();
-            if (auto x = dynamic_cast<BranchInst*>(back.get())) {
+        for (auto bb : func->getBasicBlocks()) {
+            auto back = bb->getInsts().back();
+            if (auto x = dyn_cast<BranchInst>(back)) {
                 BasicBlock* deleted = nullptr;
-                if (auto cond = dynamic_cast<ConstValue*>(x->getCondValue())) {
+                if (auto cond = dyn_cast<ConstValue>(x->getCondValue())) {
                     bb->pushBackInst(new JumpInst(cond->getImm() ? x->getTrueBasicBlock() : x->getFalseBasicBlock()));
                     deleted = cond->getImm() ? x->getFalseBasicBlock() : x->getTrueBasicBlock();
                 } else if (x->getTrueBasicBlock() == x->getFalseBasicBlock()) { // 可能被消除以jump结尾的空基本块引入
@@ -31,10 +31,10 @@ void basicBlockOpt(IrFunc* func) {
                 }
                 if (deleted) {
                     bb->removeInst(x);
-                    int idx = std::find(deleted->getPreds().begin(), deleted->getPreds().end(), bb.get()) - deleted->getPreds().begin();
+                    int idx = std::find(deleted->getPreds().begin(), deleted->getPreds().end(), bb) - deleted->getPreds().begin();
                     deleted->getPreds().erase(deleted->getPreds().begin() + idx);
-                    for (auto& i : deleted->getInsts()) {
-                        if (auto phi = dynamic_cast<PhiInst*>(i.get()))
+                    for (auto i : deleted->getInsts()) {
+                        if (auto phi = dyn_cast<PhiInst>(i))
                             phi->getIncomingValues().erase(phi->getIncomingValues().begin() + idx);
                         else {
                             break;
@@ -50,16 +50,16 @@ void basicBlockOpt(IrFunc* func) {
             auto next = std::next(bb);
             // 要求target != bb，避免去掉空的死循环
             auto& insts = (*bb)->getInsts();
-            auto x = dynamic_cast<JumpInst*>(insts.back().get());
-            if (x && x->getNextBasicBlock() != (*bb).get() && insts.front() == insts.back()) {
+            auto x = dyn_cast<JumpInst>(insts.back());
+            if (x && x->getNextBasicBlock() != *bb && insts.front() == insts.back()) {
                 BasicBlock* target = x->getNextBasicBlock();
                 // 如果存在一个pred，它以BranchInst结尾，且left或right已经为target，且target中存在phi，则不能把另一个也变成bb
                 // 例如 bb1: { b = a + 1; if (x) br bb2 else br bb3 } bb2: { br bb3; } bb3: { c = phi [a, bb1] [b bb2] }
                 // 这时bb2起到了一个区分phi来源的作用
                 bool flag = true;
-                if (dynamic_cast<PhiInst*>(target->getInsts().front().get())) {
+                if (dyn_cast<PhiInst>(target->getInsts().front())) {
                     for (BasicBlock* p : (*bb)->getPreds()) {
-                        if (auto br = dynamic_cast<BranchInst*>(p->getInsts().back().get())) {
+                        if (auto br = dyn_cast<BranchInst>(p->getInsts().back())) {
                             if (br->getTrueBasicBlock() == target || br->getFalseBasicBlock() == target) {
                                 flag = false;
                                 break;
@@ -68,16 +68,16 @@ void basicBlockOpt(IrFunc* func) {
                     }
                 }
                 if (flag) {
-                    int idx = std::find(target->getPreds().begin(), target->getPreds().end(), bb->get()) - target->getPreds().begin();
+                    int idx = std::find(target->getPreds().begin(), target->getPreds().end(), *bb) - target->getPreds().begin();
                     target->getPreds().erase(target->getPreds().begin() + idx);
                     for (BasicBlock* p : (*bb)->getPreds()) {
                         auto succ = p->getSuccsRef();
-                        **std::find_if(succ.begin(), succ.end(), [bb](BasicBlock** y) { return *y == (*bb).get(); }) = target;
+                        **std::find_if(succ.begin(), succ.end(), [bb](BasicBlock** y) { return *y == *bb; }) = target;
                         target->getPreds().push_back(p);
                     }
                     int predSize = (*bb)->getPreds().size();
-                    for (auto& i : target->getInsts()) {
-                        if (auto phi = dynamic_cast<PhiInst*>(i.get())) {
+                    for (auto i : target->getInsts()) {
+                        if (auto phi = dyn_cast<PhiInst>(i)) {
                             Value* v = phi->getIncomingValues()[idx].value;
                             phi->getIncomingValues().erase(phi->getIncomingValues().begin() + idx);
                             for (int j = 0; j < predSize; ++j) {
@@ -87,7 +87,7 @@ void basicBlockOpt(IrFunc* func) {
                             break;
                         }
                     }
-                    func->removeBasicBlock((*bb).get());
+                    func->removeBasicBlock(*bb);
                     changed = true;
                 }
             }
@@ -96,18 +96,18 @@ void basicBlockOpt(IrFunc* func) {
     } while (changed);
 
     func->clearAllVisitFlag();
-    dfs(func->getBasicBlocks().front().get());
+    dfs(func->getBasicBlocks().front());
     auto& basicBlock = func->getBasicBlocks();
     // 不可达的bb仍然可能有指向可达的bb的边，需要删掉目标bb中的pred和phi中的这一项
-    for (auto& bb : basicBlock) {
+    for (auto bb : basicBlock) {
         if (!bb->vis) {
             for (BasicBlock* s : bb->getSuccs()) {
                 if (s && s->vis) {
-                    int idx = std::find(s->getPreds().begin(), s->getPreds().end(), bb.get()) - s->getPreds().begin();
+                    int idx = std::find(s->getPreds().begin(), s->getPreds().end(), bb) - s->getPreds().begin();
                     s->getPreds().erase(s->getPreds().begin() + idx);
                     auto& insts = s->getInsts();
-                    for (auto& i : insts) {
-                        if (auto x = dynamic_cast<PhiInst*>(i.get()))
+                    for (auto i : insts) {
+                        if (auto x = dyn_cast<PhiInst>(i))
                             x->getIncomingValues().erase(x->getIncomingValues().begin() + idx);
                         else {
                             break;
@@ -118,7 +118,7 @@ void basicBlockOpt(IrFunc* func) {
         }
     }
     for (auto it = basicBlock.begin(); it != basicBlock.end();) {
-        auto bb = (*it).get();
+        auto bb = *it;
         auto next = std::next(it);
         if (!bb->vis) {
             func->removeBasicBlock(bb);
@@ -126,13 +126,13 @@ void basicBlockOpt(IrFunc* func) {
         it = next;
     }
 
-    for (auto& bb : basicBlock) {
+    for (auto bb : basicBlock) {
         if (bb->getPreds().size() == 1) {
             auto& insts = bb->getInsts();
             for (auto it = insts.begin(); it != insts.end();) {
                 auto next = std::next(it);
-                auto i = (*it).get();
-                if (auto x = dynamic_cast<PhiInst*>(i)) {
+                auto i = *it;
+                if (auto x = dyn_cast<PhiInst>(i)) {
                     assert(x->getIncomingValues().size() == 1);
                     x->replaceAllUse(x->getIncomingValues()[0].value);
                     bb->removeInst(x);
@@ -9,72 +9,18 @@ void BlockScope::addChildScope(BlockScopeHandle handle) {
     m_childrenHandle.push_back(handle);
 }
 
-SymbolTableItem* BlockScope::findItem(const std::string& name) {
-    // 在当前作用域中寻找
-    auto item = std::find_if(m_symbols.begin(), m_symbols.end(), [&name](const std::unique_ptr<SymbolTableItem>& symbol) {
-        return symbol->getName() == name;
-    });
-    if (item != m_symbols.end()) {
-        return item->get();
-    } else {
-        if (m_type == BlockScopeType::FUNC) {
-            // 如果是函数作用域，在形参中寻找
-            auto paramItem = std::find_if(m_paramItems.begin(), m_paramItems.end(), [&name](SymbolTableItem* param) {
-                return param->getName() == name;
-            });
-            if (paramItem != m_paramItems.end()) {
-                return *paramItem;
-            }
-        }
-        if (m_type != BlockScopeType::GLOBAL) {
-            // 没有找到再去其父作用域中寻找
-            return m_symbolTable.getBlockScope(m_parentHandle).findItem(name);
-        } else {
-            return nullptr;
-        }
-    }
-}
-
-FuncItem* BlockScope::findFunc(const std::string& name) {
-    auto item = std::find_if(m_funcs.begin(), m_funcs.end(), [&name](const std::unique_ptr<FuncItem>& func) {
-        return func->getName() == name;
-    });
-    if (item != m_funcs.end()) {
-        return item->get();
-    } else {
-        return nullptr;
-    }
-}
-
-std::pair<SymbolTableItem*, bool> BlockScope::insertItem(std::unique_ptr<SymbolTableItem>&& item) {
+SymbolTableItem* BlockScope::insertItem(std::unique_ptr<SymbolTableItem>&& item) {
     item->setLevel(m_level);
     item->setScopeHandle(m_symbolTable.getCurrentScopeHandle());
-    // 只在当前scope内插入symbolItem
-    auto findedSym = std::find_if(m_symbols.begin(), m_symbols.end(), [&item](const std::unique_ptr<SymbolTableItem>& symbol) {
-        return item->getName() == symbol->getName();
-    });
-    if (findedSym != m_symbols.end()) {
-        return std::make_pair(findedSym->get(), false);
-    } else {
-        m_symbols.push_back(std::move(item));
-        return std::make_pair(m_symbols.back().get(), true);
-    }
+    m_symbols.push_back(std::move(item));
+    return m_symbols.back().get();
 }
 
-std::pair<FuncItem*, bool> BlockScope::insertFunc(std::unique_ptr<FuncItem>&& func) {
+FuncItem* BlockScope::insertFunc(std::unique_ptr<FuncItem>&& func) {
     func->setLevel(m_level);
     func->setScopeHandle(m_symbolTable.getCurrentScopeHandle());
-    // 只在当前scope内插入symbolItem
-    auto findedFunc = std::find_if(m_funcs.begin(), m_funcs.end(), [&func](const std::unique_ptr<FuncItem>& symbol) {
-        return func->getName() == symbol->getName();
-    });
-
-    if (findedFunc != m_funcs.end()) {
-        return std::make_pair(findedFunc->get(), false);
-    } else {
-        m_funcs.push_back(std::move(func));
-        return std::make_pair(m_funcs.back().get(), true);
-    }
+    m_funcs.push_back(std::move(func));
+    return m_funcs.back().get();
 }
 
 std::vector<SymbolTableItem*>& BlockScope::getParamItems() const {
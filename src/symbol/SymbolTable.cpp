@@ -3,11 +3,34 @@
 SymbolTable::SymbolTable() :
     m_currScopeHandle(BlockScopeHandle(0)) {
     m_blockScopes.emplace_back(*this, BlockScopeType::GLOBAL, 0, BlockScopeHandle());
+    m_scopeMarks.push_back(0);
 }
 
-std::pair<FuncItem*, bool> SymbolTable::insertFunc(const std::string& name, typename FuncItem::Data data) {
+SymbolTable::SymbolTable(SymbolTable* global) :
+    SymbolTable() {
+    m_global = global;
+    m_visibleFuncs = global->m_funcCount;
+}
+
+SymbolTable* SymbolTable::addFuncTable() {
+    m_funcTables.emplace_back(new SymbolTable(this));
+    return m_funcTables.back().get();
+}
+
+std::pair<FuncItem*, bool> SymbolTable::insertFunc(const Token& ident, typename FuncItem::Data data) {
     if (std::is_base_of<SymbolTableItem, FuncItem>::value) {
-        return getGlobalScope().insertFunc(std::unique_ptr<FuncItem>(new FuncItem(name, data)));
+        auto nameId = ident.literalId;
+        if (nameId >= m_funcs.size()) {
+            m_funcs.resize(nameId + 1, nullptr);
+            m_funcOrders.resize(nameId + 1, 0);
+        }
+        if (m_funcs[nameId]) {
+            return std::make_pair(m_funcs[nameId], false);
+        }
+        auto func = getGlobalScope().insertFunc(std::unique_ptr<FuncItem>(new FuncItem(ident.getLiteral(), data)));
+        m_funcs[nameId] = func;
+        m_funcOrders[nameId] = m_funcCount++;
+        return std::make_pair(func, true);
     } else {
         return std::make_pair(nullptr, false);
     }
@@ -16,6 +39,7 @@ std::pair<FuncItem*, bool> SymbolTable::insertFunc(const std::string& name, type
 void SymbolTable::initSymbolTable() {
     m_currScopeHandle = BlockScopeHandle(0);
     m_blockScopes.emplace_back(*this, BlockScopeType::GLOBAL, 0, BlockScopeHandle());
+    resetBindings();
 }
 
 BlockScope& SymbolTable::getBlockScope(BlockScopeHandle handle) {
@@ -46,27 +70,94 @@ void SymbolTable::pushScope(BlockScopeType type) {
     m_currScopeHandle = BlockScopeHandle(m_blockScopes.size());
     currentScope.addChildScope(m_currScopeHandle);
     m_blockScopes.push_back(BlockScope(*this, type, currentScope.getLevel() + 1, parentHandle));
+    m_scopeMarks.push_back(m_bindings.size());
 }
 
 void SymbolTable::popScope() {
     m_currScopeHandle = getCurrentScope().getParentHandle();
     // m_blockScopes.pop_back();
+    if (m_scopeMarks.empty()) {
+        return;
+    }
+    // 作用域中的名字不再可见, 恢复被遮蔽的外层定义
+    std::size_t mark = m_scopeMarks.back();
+    m_scopeMarks.pop_back();
+    while (m_bindings.size() > mark) {
+        auto& binding = m_bindings.back();
+        m_nameHeads[binding.nameId] = binding.shadowed;
+        m_bindings.pop_back();
+    }
 }
 
-SymbolTableItem* SymbolTable::findItem(const std::string& name) {
-    return getCurrentScope().findItem(name);
+SymbolTableItem* SymbolTable::findItem(const Token& ident) {
+    auto binding = findBinding(ident.literalId);
+    if (binding) {
+        return binding->item;
+    }
+    return m_global ? m_global->findGlobalItem(ident.literalId) : nullptr;
+}
+
+FuncItem* SymbolTable::findFunc(const Token& ident) {
+    if (m_global) {
+        return m_global->findGlobalFunc(ident.literalId, m_visibleFuncs);
+    }
+    auto nameId = ident.literalId;
+    return nameId < m_funcs.size() ? m_funcs[nameId] : nullptr;
 }
 
-FuncItem* SymbolTable::findFunc(const std::string& name) {
-    return getGlobalScope().findFunc(name);
+SymbolTableItem* SymbolTable::findGlobalItem(std::uint32_t nameId) const {
+    if (nameId >= m_nameHeads.size() || m_nameHeads[nameId] < 0) {
+        return nullptr;
+    }
+    return m_bindings[m_nameHeads[nameId]].item;
+}
+
+FuncItem* SymbolTable::findGlobalFunc(std::uint32_t nameId, std::size_t visibleFuncs) const {
+    if (nameId >= m_funcs.size() || !m_funcs[nameId]) {
+        return nullptr;
+    }
+    return m_funcOrders[nameId] < visibleFuncs ? m_funcs[nameId] : nullptr;
 }
 
 void SymbolTable::clearSymbolTable() {
     m_blockScopes.clear();
+    m_funcTables.clear();
+    resetBindings();
+}
+
+SymbolTable::Binding* SymbolTable::findBinding(std::uint32_t nameId) {
+    if (nameId >= m_nameHeads.size() || m_nameHeads[nameId] < 0) {
+        return nullptr;
+    }
+    return &m_bindings[m_nameHeads[nameId]];
+}
+
+void SymbolTable::bindItem(std::uint32_t nameId, SymbolTableItem* item) {
+    if (nameId >= m_nameHeads.size()) {
+        m_nameHeads.resize(nameId + 1, -1);
+    }
+    int index = static_cast<int>(m_bindings.size());
+    m_bindings.push_back({item, m_currScopeHandle, nameId, m_nameHeads[nameId]});
+    m_nameHeads[nameId] = index;
+}
+
+void SymbolTable::resetBindings() {
+    m_nameHeads.clear();
+    m_funcs.clear();
+    m_funcOrders.clear();
+    m_funcCount = 0;
+    m_bindings.clear();
+    m_scopeMarks.assign(1, 0);
 }
 
 void SymbolTable::dumpTable(std::ostream& os) {
     for (auto& scope : m_blockScopes) {
         scope.dumpScope(os);
     }
+    // 与逐个函数生成时作用域的创建顺序相同
+    for (auto& table : m_funcTables) {
+        for (std::size_t i = 1; i < table->m_blockScopes.size(); i++) {
+            table->m_blockScopes[i].dumpScope(os);
+        }
+    }
 }
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include <token/StringPool.h>
+#include <cstring>
+
+constexpr std::uint32_t StringPool::NPOS;
+constexpr std::uint32_t StringPool::EMPTY_SLOT;
+
+StringPool::StringPool() :
+    m_slots(256, EMPTY_SLOT) {
+}
+
+std::uint32_t StringPool::hash(const char* str, std::size_t length) {
+    // FNV-1a
+    std::uint32_t h = 2166136261u;
+    for (std::size_t i = 0; i < length; i++) {
+        h ^= static_cast<unsigned char>(str[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+std::uint32_t StringPool::internId(const char* str, std::size_t length) {
+    std::size_t mask = m_slots.size() - 1;
+    std::size_t pos = hash(str, length) & mask;
+    while (m_slots[pos] != EMPTY_SLOT) {
+        auto& slot = m_strings[m_slots[pos]];
+        if (slot.size() == length && std::memcmp(slot.data(), str, length) == 0) {
+            return m_slots[pos];
+        }
+        pos = (pos + 1) & mask;
+    }
+    auto id = static_cast<std::uint32_t>(m_strings.size());
+    m_strings.emplace_back(str, length);
+    m_slots[pos] = id;
+    // 负载超过一半时扩容
+    if (m_strings.size() * 2 > m_slots.size()) {
+        rehash();
+    }
+    return id;
+}
+
+void StringPool::rehash() {
+    std::vector<std::uint32_t> slots(m_slots.size() * 2, EMPTY_SLOT);
+    std::size_t mask = slots.size() - 1;
+    for (std::uint32_t id = 0; id < m_strings.size(); id++) {
+        auto& str = m_strings[id];
+        std::size_t pos = hash(str.data(), str.size()) & mask;
+        while (slots[pos] != EMPTY_SLOT) {
+            pos = (pos + 1) & mask;
+        }
+        slots[pos] = id;
+    }
+    m_slots.swap(slots);
+}
@@ -0,0 +1,52 @@
+#include <token/TokenStream.h>
+#include <algorithm>
+
+TokenStream::TokenStream(Tokenizer& tokenizer) :
+    m_tokenizer(tokenizer), m_ring(16) {
+}
+
+const Token& TokenStream::peek(int offset) {
+    static const Token eof;
+    std::size_t pos = m_pos + offset;
+    if (!fill(pos)) {
+        return eof;
+    }
+    return m_ring[pos & (m_ring.size() - 1)];
+}
+
+void TokenStream::tee(std::streambuf* buf) {
+    m_teeWriter.open(buf);
+}
+
+void TokenStream::drain() {
+    while (fill(m_tail)) {}
+}
+
+bool TokenStream::fill(std::size_t pos) {
+    while (m_tail <= pos && !m_exhausted) {
+        Token token;
+        if (!m_tokenizer.next(token)) {
+            m_exhausted = true;
+            break;
+        }
+        if (m_teeWriter.isOpen()) {
+            m_teeWriter << token;
+        }
+        // 当前token之前的token不会再被访问
+        m_head = std::max(m_head, m_pos);
+        if (m_tail - m_head == m_ring.size()) {
+            grow();
+        }
+        m_ring[m_tail & (m_ring.size() - 1)] = token;
+        m_tail++;
+    }
+    return pos < m_tail;
+}
+
+void TokenStream::grow() {
+    std::vector<Token> ring(m_ring.size() * 2);
+    for (std::size_t i = m_head; i < m_tail; i++) {
+        ring[i & (ring.size() - 1)] = m_ring[i & (m_ring.size() - 1)];
+    }
+    m_ring.swap(ring);
+}
@@ -2,78 +2,78 @@
 #include <Utils.h>
 #include <Log.h>
 
-Tokenizer::Tokenizer(std::filebuf& fileBuf) :
-    m_istream(&fileBuf) {
-}
-
-Tokenizer::TokenIter Tokenizer::makeToken(int lineNum, const SymbolEnum& symbolNum, const std::string& literal, int value) {
-    m_tokenList.emplace_back(lineNum, symbolNum, literal, value);
-    return m_tokenList.end() - 1;
+Tokenizer::Tokenizer(std::filebuf& fileBuf) {
+    // 整个文件一次读入缓冲区, 之后只做指针扫描
+    auto size = fileBuf.pubseekoff(0, std::ios::end, std::ios::in);
+    if (size > 0 && fileBuf.pubseekoff(0, std::ios::beg, std::ios::in) == 0) {
+        m_source.resize(static_cast<std::size_t>(size));
+        m_source.resize(static_cast<std::size_t>(fileBuf.sgetn(&m_source[0], size)));
+    } else {
+        m_source.assign(std::istreambuf_iterator<char>(&fileBuf), std::istreambuf_iterator<char>());
+    }
+    m_curr = m_source.data();
+    m_end = m_source.data() + m_source.size();
 }
 
 bool Tokenizer::skipVacant() {
-    while ((isspace(m_currChar) || isNewline(m_currChar) || isTab(m_currChar)) && !m_istream.eof()) {
+    while (isVacant(m_currChar)) {
         if (isNewline(m_currChar)) {
             m_currLine++;
         }
-        extractChar();
+        if (reachEnd()) return true;
+        m_currChar = *m_curr++;
     }
-    return m_istream.eof();
+    return false;
 }
 
 SymbolEnum Tokenizer::readIdent() {
-    while (isIdentChar(m_currChar)) {
-        m_tokenStr += m_currChar;
-        extractChar();
+    const char* begin = m_curr - 1;
+    while (!reachEnd() && isIdentChar(*m_curr)) {
+        m_curr++;
     }
-    unextractChar();
-    return getReservedWordSymbol(m_tokenStr);
+    m_tokenStr.assign(begin, m_curr);
+    return getReservedWordSymbol(begin, m_curr - begin);
 }
 
 SymbolEnum Tokenizer::readInteger() {
     SymbolEnum ret = SymbolEnum::UNKNOWN;
+    const char* begin = m_curr - 1;
     if (m_currChar != '0') {
-        while (isdigit(m_currChar)) {
-            m_tokenStr += m_currChar;
-            extractChar();
+        while (!reachEnd() && isDigit(*m_curr)) {
+            m_curr++;
         }
-        unextractChar();
+        m_tokenStr.assign(begin, m_curr);
         m_tokenValue = std::stoi(m_tokenStr);
         ret = SymbolEnum::INTCON;
     } else {
         m_tokenStr += m_currChar;
-        extractChar();
-        if (!isdigit(m_currChar)) {
-            unextractChar();
-            m_tokenValue = std::stoi(m_tokenStr);
+        if (reachEnd() || !isDigit(*m_curr)) {
+            m_tokenValue = 0;
             ret = SymbolEnum::INTCON;
         } else {
             // TODO: 前导零错误
+            m_curr++;
             ret = SymbolEnum::UNKNOWN;
         }
     }
     return ret;
 }
 SymbolEnum Tokenizer::skipComment() {
-    if (m_currChar == '/') { // 单行注释
-        while (!isNewline(m_currChar)) {
-            extractChar();
+    if (m_currChar == '/') { // 单行注释, 连同行尾换行一起跳过
+        while (!reachEnd() && !isNewline(*m_curr)) {
+            m_curr++;
         }
+        if (!reachEnd()) m_curr++;
         m_currLine++;
     } else if (m_currChar == '*') { // 多行注释
-        extractChar();
-        while (true) {
-            while (m_currChar != '*') {
-                if (isNewline(m_currChar)) {
-                    m_currLine++;
-                }
-                extractChar();
-            }
-            extractChar();
-            if (m_currChar == '/') {
+        while (!reachEnd()) {
+            char ch = *m_curr++;
+            if (ch == '*' && !reachEnd() && *m_curr == '/') {
+                m_curr++;
                 break;
-            } else {
-                continue;
+            }
+            if (isNewline(ch)) {
+                m_currLine++;
             }
         }
     }
@@ -81,18 +81,14 @@ SymbolEnum Tokenizer::skipComment() {
 }
 
 SymbolEnum Tokenizer::readPunct() {
-    char preChar = m_currChar;
     m_tokenStr += m_currChar;
-    auto symbol = getSymbolEnumByPunct(m_tokenStr);
-    extractChar();
-    m_tokenStr += m_currChar; // 获取第二个
-    auto doubleSym = getSymbolEnumByPunct(m_tokenStr);
-    if (doubleSym != SymbolEnum::UNKNOWN) {
-        symbol = doubleSym;
-    } else {
-        m_tokenStr.clear();
-        m_tokenStr += preChar;
-        unextractChar();
+    auto symbol = getSymbolEnumByPunct(m_currChar);
+    if (!reachEnd()) {
+        auto doubleSym = getSymbolEnumByPunct(m_currChar, *m_curr); // 尝试与第二个字符组合
+        if (doubleSym != SymbolEnum::UNKNOWN) {
+            symbol = doubleSym;
+            m_tokenStr += *m_curr++;
+        }
     }
     return symbol;
 }
@@ -104,7 +100,7 @@ SymbolEnum Tokenizer::readString() {
         m_tokenStr += m_currChar;
         checkFormatChar();
         extractChar();
-        if (m_currChar == '"') break;
+        if (m_currChar == '"' || m_extractFail) break;
     }
     if (m_currChar == '"') {
         m_tokenStr += m_currChar;
@@ -142,28 +138,29 @@ void Tokenizer::checkFormatChar() {
     }
 }
 
-std::vector<Token>& Tokenizer::tokenize() {
-    while (m_istream.get(m_currChar)) {
+// 读取下一个token, 源码读完时返回false
+bool Tokenizer::next(Token& token) {
+    while (!reachEnd()) {
+        m_currChar = *m_curr++;
         m_tokenStr.clear();
         m_symbol = SymbolEnum::UNKNOWN;
         m_tokenValue = 0;
-        if (skipVacant()) break;
+        if (skipVacant()) return false;
         // 处理标识符
-        if (isalpha(m_currChar) || m_currChar == '_') {
+        if (isIdentStart(m_currChar)) {
             m_symbol = readIdent();
         }
         // 处理非零数字
-        else if (isdigit(m_currChar)) {
+        else if (isDigit(m_currChar)) {
             m_symbol = readInteger();
         }
         // 处理注释和除法
         else if (m_currChar == '/') {
             m_tokenStr += m_currChar;
-            extractChar();
-            if (m_currChar == '/' || m_currChar == '*') {
+            if (!reachEnd() && (*m_curr == '/' || *m_curr == '*')) {
+                m_currChar = *m_curr++;
                 m_symbol = skipComment();
             } else {
-                unextractChar();
                 m_symbol = SymbolEnum::DIV;
             }
         }
@@ -182,40 +179,23 @@ std::vector<Token>& Tokenizer::tokenize() {
             extractChar();
         }
         if (m_symbol != SymbolEnum::COMMENT) {
-            m_currToken = makeToken(m_currLine, m_symbol, m_tokenStr, m_tokenValue);
+            token = Token(m_currLine, m_symbol, m_stringPool, m_tokenStr, m_tokenValue);
+            return true;
         }
     }
-
-    return m_tokenList;
-}
-
-SymbolEnum Tokenizer::getReservedWordSymbol(std::string& word) {
-    static const std::set<std::string> reservedWordSet{
-        "const",
-        "main",
-        "int",
-        "char",
-        "void",
-        "return",
-        "if",
-        "else",
-        "break",
-        "continue",
-        "while",
-        "for",
-        "getint",
-        "printf",
-    };
-    std::string copy(word);
-    toUpper(copy);
-    auto m_symbol = getSymbolEnumByText(copy + "TK");
-    return reservedWordSet.count(word) != 0 ? m_symbol : SymbolEnum::IDENFR;
+    return false;
 }
 
 void Tokenizer::extractChar() {
-    m_istream.get(m_currChar);
+    if (reachEnd()) {
+        m_extractFail = true;
+    } else {
+        m_currChar = *m_curr++;
+    }
 }
 
 void Tokenizer::unextractChar() {
-    m_istream.unget();
+    if (!m_extractFail) {
+        m_curr--;
+    }
 }
\ No newline at end of file
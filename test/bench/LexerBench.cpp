@@ -0,0 +1,140 @@
+// 词法分析微基准: 逐个读取token的吞吐量, 以及查表分类与旧的std::set实现的对比
+// 用法: LexerBench [源文件] [重复次数]
+#include <token/Tokenizer.h>
+#include <Utils.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <set>
+
+namespace {
+
+const char* s_snippet =
+    "const int N = 1024, M[3] = {1, 2, 3};\n"
+    "int fib(int n) {\n"
+    "    if (n <= 1) return n; // base\n"
+    "    return fib(n - 1) + fib(n - 2);\n"
+    "}\n"
+    "/* loop */ int sum_%d(int a[], int len) {\n"
+    "    int i = 0, s = 0;\n"
+    "    while (i < len && s != -1 || !s) { s = s + a[i] * 2 % 7; i = i + 1; }\n"
+    "    for (i = 0; i >= 0; i = i - 1) { break; }\n"
+    "    printf(\"%%d\\n\", s);\n"
+    "    return s;\n"
+    "}\n";
+
+std::string makeSource(int repeat) {
+    std::string source;
+    char buf[1024];
+    for (int i = 0; i < repeat; i++) {
+        std::snprintf(buf, sizeof(buf), s_snippet, i);
+        source += buf;
+    }
+    source += "int main() {\n    return 0;\n}\n";
+    return source;
+}
+
+// 旧实现, 作为对照
+bool legacyIsPunct(const char c) {
+    static const std::set<char> punctSet = {';', ',', '(', ')', '[', ']', '{', '}', '+', '-', '*', '/',
+                                            '%', '=', '<', '>', '<', '>', '=', '!', '!', '&', '|'};
+    return punctSet.count(c);
+}
+
+SymbolEnum legacyReservedWordSymbol(const std::string& word) {
+    static const std::set<std::string> reservedWordSet{
+        "const", "main", "int", "char", "void", "return", "if",
+        "else", "break", "continue", "while", "for", "getint", "printf"};
+    std::string copy(word);
+    toUpper(copy);
+    auto symbol = getSymbolEnumByText(copy + "TK");
+    return reservedWordSet.count(word) != 0 ? symbol : SymbolEnum::IDENFR;
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string path = "lexer_bench_input.txt";
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+    if (argc > 1) {
+        path = argv[1];
+    } else {
+        std::ofstream out(path);
+        out << makeSource(20000);
+    }
+
+    std::size_t tokenCount = 0;
+    std::size_t bytes = 0;
+    double best = 1e30;
+    std::vector<std::string> words;
+    std::string source;
+    for (int r = 0; r < rounds; r++) {
+        std::filebuf file;
+        if (!file.open(path, std::ios::in)) {
+            std::fprintf(stderr, "Fail to open %s\n", path.c_str());
+            return 1;
+        }
+        auto start = std::chrono::steady_clock::now();
+        Tokenizer tokenizer(file);
+        Token token;
+        std::size_t count = 0;
+        while (tokenizer.next(token)) {
+            count++;
+        }
+        best = std::min(best, elapsedMs(start));
+        tokenCount = count;
+        if (r == 0) {
+            std::filebuf again;
+            again.open(path, std::ios::in);
+            Tokenizer wordTokenizer(again);
+            while (wordTokenizer.next(token)) {
+                if (token.symbol == SymbolEnum::IDENFR || token.symbol >= SymbolEnum::CONSTTK) {
+                    words.push_back(token.getLiteral());
+                }
+            }
+        }
+    }
+    {
+        std::ifstream in(path);
+        source.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        bytes = source.size();
+    }
+    std::printf("tokenize: %zu bytes, %zu tokens, best %.2f ms (%.1f MB/s)\n",
+                bytes, tokenCount, best, bytes / 1048576.0 / (best / 1000));
+
+    // 字符分类
+    std::size_t legacyHits = 0, tableHits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (char c : source) legacyHits += legacyIsPunct(c);
+    double legacyMs = elapsedMs(start);
+    start = std::chrono::steady_clock::now();
+    for (char c : source) tableHits += isPunct(c);
+    double tableMs = elapsedMs(start);
+    std::printf("isPunct: set %.2f ms, table %.2f ms\n", legacyMs, tableMs);
+
+    // 保留字识别
+    std::size_t mismatch = legacyHits != tableHits;
+    start = std::chrono::steady_clock::now();
+    std::size_t legacyKeywords = 0;
+    for (auto& word : words) legacyKeywords += legacyReservedWordSymbol(word) != SymbolEnum::IDENFR;
+    legacyMs = elapsedMs(start);
+    start = std::chrono::steady_clock::now();
+    std::size_t tableKeywords = 0;
+    for (auto& word : words) tableKeywords += getReservedWordSymbol(word.data(), word.size()) != SymbolEnum::IDENFR;
+    tableMs = elapsedMs(start);
+    std::printf("keyword: %zu words, set %.2f ms, perfect hash %.2f ms\n", words.size(), legacyMs, tableMs);
+
+    for (auto& word : words) {
+        mismatch += legacyReservedWordSymbol(word) != getReservedWordSymbol(word.data(), word.size());
+    }
+    mismatch += legacyKeywords != tableKeywords;
+    if (mismatch) {
+        std::fprintf(stderr, "classification mismatch!\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,98 @@
+// 使用链表微基准: 把一个有大量使用的value整体替换成另一个value, 以及与旧的std::vector<Use*>实现的对比
+// 用法: UseListBench [使用数] [旧实现的使用数]
+#include <ir/IR.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+// 旧实现, 作为对照: removeUse线性查找并从vector中erase
+struct LegacyUse;
+struct LegacyValue {
+    void addUse(LegacyUse* use) { uses.push_back(use); }
+    void removeUse(LegacyUse* use) {
+        auto it = std::find(uses.begin(), uses.end(), use);
+        if (it != uses.end()) uses.erase(it);
+    }
+    void replaceAllUse(LegacyValue* value);
+    std::vector<LegacyUse*> uses;
+};
+
+struct LegacyUse {
+    LegacyValue* value{nullptr};
+    explicit LegacyUse(LegacyValue* v) :
+        value(v) { v->addUse(this); }
+    void set(LegacyValue* v) {
+        value->removeUse(this);
+        value = v;
+        v->addUse(this);
+    }
+};
+
+void LegacyValue::replaceAllUse(LegacyValue* value) {
+    while (!uses.empty()) {
+        uses.front()->set(value);
+    }
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::size_t countUses(Value& value) {
+    std::size_t count = 0;
+    for (auto use : value.getUses()) {
+        count += use != nullptr;
+    }
+    return count;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t useCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    std::size_t legacyCount = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : useCount;
+
+    bool mismatch = false;
+    {
+        Value from(IRType::Add), to(IRType::Add);
+        std::vector<Use> uses;
+        uses.reserve(useCount);
+        for (std::size_t i = 0; i < useCount; i++) {
+            uses.emplace_back(&from, nullptr);
+        }
+        auto start = std::chrono::steady_clock::now();
+        from.replaceAllUse(&to);
+        double ms = elapsedMs(start);
+        std::printf("use list: %zu uses, replaceAllUse %.2f ms\n", useCount, ms);
+        mismatch |= !from.getUses().empty() || countUses(to) != useCount;
+        // 替换后的顺序应与原来一致
+        std::size_t i = 0;
+        for (auto use : to.getUses()) {
+            mismatch |= use != &uses[i++];
+        }
+        start = std::chrono::steady_clock::now();
+        uses.clear();
+        std::printf("use list: destroy %zu uses %.2f ms\n", useCount, elapsedMs(start));
+        mismatch |= !to.getUses().empty();
+    }
+    {
+        LegacyValue from, to;
+        std::vector<LegacyUse> uses;
+        uses.reserve(legacyCount);
+        for (std::size_t i = 0; i < legacyCount; i++) {
+            uses.emplace_back(&from);
+        }
+        auto start = std::chrono::steady_clock::now();
+        from.replaceAllUse(&to);
+        std::printf("vector: %zu uses, replaceAllUse %.2f ms\n", legacyCount, elapsedMs(start));
+        mismatch |= to.uses.size() != legacyCount;
+    }
+    if (mismatch) {
+        std::fprintf(stderr, "use list mismatch!\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,24 @@
+import subprocess
+# CONFIG
+TEST_ID_RANGE = [1,1] #【修改】错误处理测试样例id范围
+TESTCASE_DIR = "./error/"
+COMPILER = "../dist/sysyc"
+
+# 编译testfile并与期望的error.txt逐行比较, 每个错误只能报告一次
+def check(id):
+    testPath = TESTCASE_DIR + "testfile" + str(id) + ".txt"
+    answerPath = TESTCASE_DIR + "error" + str(id) + ".txt"
+    resultPath = TESTCASE_DIR + "result" + str(id) + ".txt"
+    subprocess.run(args=[COMPILER, '--dump-error', resultPath, testPath], stdout=subprocess.PIPE)
+    with open(resultPath, "r") as f:
+        result = [s.split() for s in f.readlines()]
+    with open(answerPath, "r") as f:
+        answer = [s.split() for s in f.readlines()]
+    return result == answer
+
+passed = True
+for id in range(TEST_ID_RANGE[0], TEST_ID_RANGE[1]+1):
+    result = check(id)
+    passed &= result
+    print("errorfile" + str(id) + "   " + ("Accepted" if result else "Wrong Answer"))
+print("error test result: " + ("\033[1;32;40mAccepted\033[0m" if passed else "\033[1;31;40mWrong Answer\033[0m"))